@@ -16,7 +16,12 @@
 
 void init_console(Options options, std::string binary_path) {
     int thread_size = std::max(0, options.n_threads - 1);
+    thread_pool.set_pin_threads(options.pin_threads);
     thread_pool.resize(thread_size);
+    if (options.pin_threads) {
+        affinity_pin_current_thread(0);
+    }
+    numa_memory_policy = options.numa_policy;
     if (options.show_log)
         std::cerr << "thread size = " << thread_size + 1 << std::endl;
     bit_init();
@@ -35,11 +40,19 @@ void init_console(Options options, std::string binary_path) {
     #endif
     stability_init();
     std::string mo_end_file = binary_path + "resources/eval_move_ordering_end.egev"; // filename fixed
+    eval_image_file = options.eval_image_file;
     //std::string mo_mid_file = binary_path + "resources/eval_move_ordering_mid.egev"; // filename fixed
     if (!evaluate_init(options.eval_file, mo_end_file, options.show_log))
         std::exit(0);
     if (!options.nobook)
         book_init(options.book_file, options.show_log);
+    if (options.solved_store_file != "")
+        solved_store.open(options.solved_store_file, options.show_log);
+    time_calibration.set_profile_file(binary_path + TIME_CALIBRATION_PROFILE_FILE);
+    if (!time_calibration.load() && options.show_log)
+        std::cerr << "no time calibration profile, using default (run -timecalibration to make one)" << std::endl;
+    if (options.show_log)
+        time_calibration.print(std::cerr);
     if (options.show_log)
         std::cerr << "initialized" << std::endl;
 }
@@ -58,7 +71,7 @@ int main(int argc, char* argv[]) {
         }
         std::cerr.rdbuf(ofs.rdbuf());
     }
-    print_special_commandline_options(commandline_options);
+    print_special_commandline_options(commandline_options, &options);
     init_console(options, binary_path);
     execute_special_tasks(options);
     execute_special_commandline_tasks(commandline_options, &options, &state);
@@ -0,0 +1,59 @@
+/*
+	Egaroucid Project
+
+	@file Egaroucid_for_Console_dispatch.cpp
+		Launcher of Console application, runs the fastest engine build the CPU supports
+	@date 2021-2025
+	@author Takuto Yamana
+	@license GPL-3.0 license
+*/
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "engine/setting.hpp"
+#include "console/console_common.hpp"
+#include "console/commandline_option_definition.hpp"
+#include "console/cpu_dispatch.hpp"
+
+
+int main(int argc, char* argv[]) {
+    std::string binary_path = get_binary_path();
+    std::vector<std::string> cpu_variant_option_names;
+    for (const Commandline_option_info &info: commandline_option_data) {
+        if (info.id == ID_CPU_VARIANT) {
+            cpu_variant_option_names = info.names;
+        }
+    }
+    // -cpu <variant> is consumed here, other arguments are passed to the engine
+    std::string forced_name = "auto";
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (std::find(cpu_variant_option_names.begin(), cpu_variant_option_names.end(), arg) != cpu_variant_option_names.end()) {
+            if (i + 1 < argc) {
+                forced_name = argv[++i];
+            }
+        } else {
+            args.emplace_back(arg);
+        }
+    }
+    int variant = cpu_variant_find(forced_name);
+    if (variant == CPU_VARIANT_NONE) {
+        std::cerr << "[ERROR] unknown cpu variant " << forced_name << std::endl;
+        return 1;
+    }
+    if (variant == CPU_VARIANT_AUTO) {
+        variant = cpu_variant_best(binary_path);
+        if (variant == CPU_VARIANT_NONE) {
+            std::cerr << "[ERROR] no engine build found in " << binary_path << std::endl;
+            return 1;
+        }
+    } else if (!cpu_variant_supported(variant)) {
+        std::cerr << "[ERROR] this CPU can't run cpu variant " << cpu_variant_names[variant] << std::endl;
+        return 1;
+    }
+    cpu_variant_exec(binary_path, variant, args);
+    return 1;
+}
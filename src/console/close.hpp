@@ -16,6 +16,7 @@
 
 void close(State *state, Options *options) {
     if (state->book_changed)
-        book.save_egbk3(options->book_file, options->book_file + ".bak");
+        book.checkpoint(options->book_file, options->book_file + ".bak");
+    time_calibration.save_if_updated(1);
     std::exit(0);
 }
\ No newline at end of file
@@ -330,15 +330,14 @@ void hint(Board_info *board, Options *options, State *state, std::string arg) {
         for (const Search_result &elem: result)
             legal ^= 1ULL << elem.policy;
         int n_show_ai = n_show - (int)result.size();
-        for (int i = 0; i < n_show_ai; ++i) {
-            Search_result elem = ai_legal(board->board, options->level, true, 0, true, false, legal);
+        bool searching = true;
+        std::vector<Search_result> result_ai = ai_multi_pv(board->board, options->level, n_show_ai, true, false, legal, &searching);
+        for (const Search_result &elem: result_ai)
             result.emplace_back(elem);
-            legal ^= 1ULL << elem.policy;
-        }
     }
     std::sort(result.rbegin(), result.rend());
     print_search_result_head();
-    for (int i = 0; i < n_show; ++i) {
+    for (int i = 0; i < n_show && i < (int)result.size(); ++i) {
         print_search_result_body(result[i], options, state);
     }
 }
@@ -421,6 +420,19 @@ void settime(State *state, Options *options, std::string arg) {
     }
 }
 
+void print_search_statistics() {
+#if USE_SEARCH_STATISTICS
+    search_statistics_print(search_statistics_get_last(), std::cout);
+#else
+    std::cerr << "[ERROR] search statistics not available, build with HAS_SEARCH_STATISTICS" << std::endl;
+#endif
+}
+
+void print_transposition_table_info() {
+    std::cout << "replacement policy " << tt_replacement_policy_names[transposition_table_replacement_policy] << " date " << (int)transposition_table.get_date() << std::endl;
+    transposition_table.get_occupancy().print(std::cout);
+}
+
 void check_command(Board_info *board, State *state, Options *options) {
     uint64_t start_time = tim();
     std::string cmd_line = get_command_line();
@@ -497,6 +509,12 @@ void check_command(Board_info *board, State *state, Options *options) {
         case CMD_ID_SETTIME:
             settime(state, options, arg);
             break;
+        case CMD_ID_SEARCHSTATS:
+            print_search_statistics();
+            break;
+        case CMD_ID_TTINFO:
+            print_transposition_table_info();
+            break;
         default:
             break;
     }
@@ -13,7 +13,7 @@
 #include <vector>
 #include "console_common.hpp"
 
-#define N_COMMANDS 19
+#define N_COMMANDS 21
 
 #define CMD_ID_NONE -1
 #define CMD_ID_HELP 0
@@ -35,6 +35,8 @@
 #define CMD_ID_GENPROBLEM 16
 #define CMD_ID_TRANSCRIPT 17
 #define CMD_ID_SETTIME 18
+#define CMD_ID_SEARCHSTATS 19
+#define CMD_ID_TTINFO 20
 
 #define COMMAND_NOT_FOUND -1
 
@@ -64,5 +66,7 @@ const Command_info command_data[N_COMMANDS] = {
     {CMD_ID_CLEARCACHE, {"clearcache"},                                     "",                         "Clear cache."},
     {CMD_ID_GENPROBLEM, {"genproblem"},                                     "<n_empties> <n_problems>", "Generate <n_problems> problems with <n_empties> empty squares and calculate the score and bestmove with specified level"},
     {CMD_ID_TRANSCRIPT, {"transcript"},                                     "",                         "Show transcript of the game"},
-    {CMD_ID_SETTIME,    {"settime"},                                        "<color> <time>",           "Set <color> (X / B / O / W) player's remaining time to <time> (seconds)"}
+    {CMD_ID_SETTIME,    {"settime"},                                        "<color> <time>",           "Set <color> (X / B / O / W) player's remaining time to <time> (seconds)"},
+    {CMD_ID_SEARCHSTATS, {"searchstats", "stats"},                           "",                         "See statistics (TT, cutoffs, YBWC splits per depth) of the last search (needs HAS_SEARCH_STATISTICS build)"},
+    {CMD_ID_TTINFO,     {"ttinfo", "tt"},                                   "",                         "See transposition table occupancy by age and depth (replacements per depth are in `searchstats`)"}
 };
\ No newline at end of file
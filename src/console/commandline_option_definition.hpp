@@ -12,7 +12,7 @@
 #include <string>
 #include <vector>
 
-#define N_COMMANDLINE_OPTIONS 28
+#define N_COMMANDLINE_OPTIONS 49
 
 #define ID_NONE -1
 #define ID_VERSION 0
@@ -45,6 +45,27 @@
 #define ID_LOSSLESS_LINES 25
 #define ID_MINIMAX 26
 #define ID_SOLVE_PARALLEL_TRANSCRIPT 27
+#define ID_CONVERT_BOOK_MMAP 28
+#define ID_SERVER 29
+#define ID_PIN_THREADS 30
+#define ID_NUMA 31
+#define ID_NUMA_BENCHMARK 32
+#define ID_TIME_CALIBRATION 33
+#define ID_TIME_CALIBRATION_INFO 34
+#define ID_SOLVED_STORE 35
+#define ID_COMPACT_SOLVED_STORE 36
+#define ID_EVAL_LOAD_BENCHMARK 37
+#define ID_EVAL_IMAGE 38
+#define ID_EVAL_KERNEL_BENCHMARK 39
+#define ID_CPU_VARIANT 40
+#define ID_COMPACT_BOOK 41
+#define ID_SOLVE_BULK 42
+#define ID_PERFT_HASH 43
+#define ID_PERFT_BENCHMARK 44
+#define ID_LAZY_SMP 45
+#define ID_TT_POLICY 46
+#define ID_LAZY_SMP_MPC 47
+#define ID_LAZY_SMP_TIME 48
 
 struct Commandline_option_info{
     int id;
@@ -76,7 +97,7 @@ const Commandline_option_info commandline_option_data[N_COMMANDLINE_OPTIONS] = {
     {ID_SELF_PLAY,          {"-sf", "-selfplay"},                               2, "<n> <m>",          "Self play <n> games (play randomly first <m> moves)"},
     {ID_SELF_PLAY_LINE,     {"-sfl", "-selfplayline"},                          1, "<file>",           "Self play with given openings"},
     {ID_SELF_PLAY_BOARD,    {"-sfb", "-selfplayboard"},                         1, "<file>",           "Self play with given opening boards"},
-    {ID_PERFT,              {"-perft"},                                         2, "<depth> <mode>",   "Perft for Othello with <depth> in <mode>, 1: pass is counted as 1 move (normal perft), 2: pass is not counted as a move"},
+    {ID_PERFT,              {"-perft"},                                         2, "<depth> <mode>",   "Perft for Othello with <depth> in <mode> using all threads (-t), 1: pass is counted as 1 move (normal perft), 2: pass is not counted as a move"},
     {ID_TIME_ALLOCATE,      {"-time"},                                          1, "<seconds>",        "Time allocate <seconds> seconds. -level will be ignored"},
     {ID_PONDER,             {"-ponder"},                                        0, "",                  "Enable ponder"},
     {ID_DISABLE_AUTO_CACHE_CLEAR, {"-noautocacheclear"},                        0, "",                  "Disable auto cache clearing"},
@@ -87,4 +108,25 @@ const Commandline_option_info commandline_option_data[N_COMMANDLINE_OPTIONS] = {
     {ID_LOSSLESS_LINES,     {"-lllb", "-losslesslinesboard"},                   2, "<file> <n_discs>",  "enumerate loss-less lines to <n_discs> discs"},
     {ID_MINIMAX,            {"-minimax"},                                       1, "<depth>",           "Minimax search from root node for <depth>"},
     {ID_SOLVE_PARALLEL_TRANSCRIPT, {"-spt", "-solveparalleltranscript"},        1, "<file>",            "Solve problems in transcript file in parallel"},
+    {ID_CONVERT_BOOK_MMAP,  {"-cbm", "-convertbookmmap"},                       2, "<in_book> <out_book>", "Convert <in_book> to memory-mapped book <out_book> (.egbkm)"},
+    {ID_SERVER,             {"-server"},                                        0, "",                  "Batch analysis server: tagged requests from stdin are searched concurrently and answered out of order"},
+    {ID_PIN_THREADS,        {"-pin", "-pinthreads"},                            0, "",                  "Pin search threads to CPUs"},
+    {ID_NUMA,               {"-numa"},                                          1, "<policy>",          "NUMA placement of hash table (default, interleave or partition, needs HAS_NUMA build)"},
+    {ID_NUMA_BENCHMARK,     {"-numabench"},                                     1, "<problem file>",    "Compare NPS on <problem file> without / with thread pinning and NUMA placement"},
+    {ID_TIME_CALIBRATION,   {"-calibrate", "-timecalibration"},                 1, "<seconds>",         "Measure NPS and node growth for time management in <seconds> seconds and save the profile"},
+    {ID_TIME_CALIBRATION_INFO, {"-calibrationinfo", "-timecalibrationinfo"},    0, "",                  "See time management calibration profile"},
+    {ID_SOLVED_STORE,       {"-store", "-solvedstore"},                         1, "<file>",            "Use <file> as persistent store of exactly solved positions (created if not exist)"},
+    {ID_COMPACT_SOLVED_STORE, {"-compactstore", "-compactsolvedstore"},         1, "<file>",            "Compact solved position store <file>"},
+    {ID_EVAL_LOAD_BENCHMARK, {"-evalbench", "-evalloadbenchmark"},              1, "<n>",               "Load evaluation file <n> times and compare vector decode with streaming load"},
+    {ID_EVAL_IMAGE,         {"-evalimage", "-evaluationimage"},                 1, "<file>",            "Share evaluation weights among processes through read-only mapped <file> (baked if not exist or outdated, a file in /dev/shm works as shared memory)"},
+    {ID_EVAL_KERNEL_BENCHMARK, {"-evalkernelbench"},                            1, "<n_games>",         "Compare AVX2 and AVX-512 evaluation kernels on positions of <n_games> random games"},
+    {ID_CPU_VARIANT,        {"-cpu", "-cpuvariant"},                            1, "<variant>",         "Force engine build <variant> (auto, generic, avx2, avx512) when started by the CPU dispatch launcher"},
+    {ID_COMPACT_BOOK,       {"-compactbook"},                                   1, "<file>",            "Merge journal of book <file> into a fresh egbk3 file"},
+    {ID_SOLVE_BULK,         {"-solvebulk"},                                     1, "<problem file>",    "Solve many boards (one per line, - for stdin) for throughput, output <board> <value> <move> (<line> error if invalid) in input order; one table is shared by the batch, so set -hash for it"},
+    {ID_PERFT_HASH,         {"-perfthash"},                                     1, "<hash_level>",      "Use hash of 2^<hash_level> subtree counts (symmetric boards shared) in -perft"},
+    {ID_PERFT_BENCHMARK,    {"-perftbench"},                                    1, "<depth>",           "Perft <depth> with 1 thread and all threads (-t) without hash, compare move generator speed per thread"},
+    {ID_LAZY_SMP,           {"-lazysmp"},                                       2, "<max_depth> <max_offset>", "Lazy SMP helpers search while main iteration depth <= <max_depth> (0: YBWC only), up to <max_offset> deeper than the main search"},
+    {ID_TT_POLICY,          {"-ttpolicy"},                                      1, "<policy>",          "Transposition table replacement policy (depth, always or twotier)"},
+    {ID_LAZY_SMP_MPC,       {"-lazysmpmpc"},                                    1, "<probability>",     "Lazy SMP helpers deeper than the main search start from MPC <probability>% (74, 88, 93, 98, 99 or 100)"},
+    {ID_LAZY_SMP_TIME,      {"-lazysmptime"},                                   0, "",                  "Use Lazy SMP helpers also in time-limited search"},
 };
\ No newline at end of file
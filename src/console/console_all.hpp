@@ -22,4 +22,5 @@
 #include "info.hpp"
 #include "option.hpp"
 #include "print.hpp"
+#include "server.hpp"
 #include "state.hpp"
\ No newline at end of file
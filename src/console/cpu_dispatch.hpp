@@ -0,0 +1,134 @@
+/*
+    Egaroucid Project
+
+    @file cpu_dispatch.hpp
+        Select an engine build that the CPU supports
+    @date 2021-2025
+    @author Takuto Yamana
+    @license GPL-3.0 license
+*/
+
+#pragma once
+#include <iostream>
+#include <string>
+#include <vector>
+#include <filesystem>
+#if _WIN64 || _WIN32
+    #include <process.h>
+#else
+    #include <unistd.h>
+#endif
+
+/*
+    @brief engine builds
+
+    CPU_VARIANT_GENERIC     -DHAS_NO_AVX2, x86-64 baseline
+    CPU_VARIANT_AVX2        SIMD build, x86-64-v3 (AVX2 BMI2 LZCNT)
+    CPU_VARIANT_AVX512      -DHAS_AVX512, x86-64-v4 (AVX-512 F CD BW DQ VL)
+
+    Each build is a separate executable next to the launcher, because the engine
+    selects its kernels and data layouts with preprocessor macros.
+*/
+#define CPU_VARIANT_NONE -2
+#define CPU_VARIANT_AUTO -1
+#define CPU_VARIANT_GENERIC 0
+#define CPU_VARIANT_AVX2 1
+#define CPU_VARIANT_AVX512 2
+#define N_CPU_VARIANTS 3
+
+const std::string cpu_variant_names[N_CPU_VARIANTS] = {"generic", "avx2", "avx512"};
+
+#define CPU_VARIANT_BINARY_PREFIX "Egaroucid_for_Console_"
+#define CPU_VARIANT_BINARY_SUFFIX ".out"
+
+/*
+    @brief get variant id from its name
+
+    @param name                 variant name or "auto"
+    @return variant id, CPU_VARIANT_AUTO or CPU_VARIANT_NONE if not found
+*/
+inline int cpu_variant_find(const std::string &name) {
+    if (name == "auto") {
+        return CPU_VARIANT_AUTO;
+    }
+    for (int i = 0; i < N_CPU_VARIANTS; ++i) {
+        if (cpu_variant_names[i] == name) {
+            return i;
+        }
+    }
+    return CPU_VARIANT_NONE;
+}
+
+/*
+    @brief check if the CPU runs the variant
+
+    @param variant              variant id
+    @return supported?
+*/
+inline bool cpu_variant_supported(int variant) {
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    switch (variant) {
+        case CPU_VARIANT_GENERIC:
+            return true;
+        case CPU_VARIANT_AVX2:
+            return __builtin_cpu_supports("x86-64-v3");
+        case CPU_VARIANT_AVX512:
+            return __builtin_cpu_supports("x86-64-v4");
+        default:
+            return false;
+    }
+#else
+    return variant == CPU_VARIANT_GENERIC;
+#endif
+}
+
+/*
+    @brief path of the executable of the variant
+
+    @param binary_path          directory of the launcher
+    @param variant              variant id
+    @return path
+*/
+inline std::string cpu_variant_binary(const std::string &binary_path, int variant) {
+    return binary_path + CPU_VARIANT_BINARY_PREFIX + cpu_variant_names[variant] + CPU_VARIANT_BINARY_SUFFIX;
+}
+
+/*
+    @brief select the fastest variant that the CPU supports and that is installed
+
+    @param binary_path          directory of the launcher
+    @return variant id, CPU_VARIANT_NONE if nothing found
+*/
+inline int cpu_variant_best(const std::string &binary_path) {
+    for (int variant = N_CPU_VARIANTS - 1; variant >= 0; --variant) {
+        if (cpu_variant_supported(variant) && std::filesystem::exists(cpu_variant_binary(binary_path, variant))) {
+            return variant;
+        }
+    }
+    return CPU_VARIANT_NONE;
+}
+
+/*
+    @brief replace this process by the variant
+
+    @param binary_path          directory of the launcher
+    @param variant              variant id
+    @param args                 arguments (without argv[0])
+    @return only returns on failure
+*/
+inline void cpu_variant_exec(const std::string &binary_path, int variant, const std::vector<std::string> &args) {
+    std::string path = cpu_variant_binary(binary_path, variant);
+    std::vector<char*> argv;
+    argv.emplace_back((char*)path.c_str());
+    for (const std::string &arg: args) {
+        argv.emplace_back((char*)arg.c_str());
+    }
+    argv.emplace_back(nullptr);
+#if _WIN64 || _WIN32
+    _execv(path.c_str(), argv.data());
+#else
+    execv(path.c_str(), argv.data());
+#endif
+    std::cerr << "[ERROR] can't execute " << path << std::endl;
+}
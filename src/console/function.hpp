@@ -13,6 +13,11 @@
 #include <fstream>
 #include <vector>
 #include <string>
+#include <atomic>
+#include <future>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
 #include "./../engine/engine_all.hpp"
 #include "command.hpp"
 
@@ -22,6 +27,16 @@
 
 #define SELF_PLAY_N_TRY 1
 
+/*
+    @brief bulk solver settings
+
+    positions with less empties than BULK_SOLVE_YBWC_MIN_EMPTIES are solved in one thread,
+    others are searched with YBWC and get help from workers that have no position left
+    at most (threads * BULK_SOLVE_WINDOW_PER_THREAD) positions are read ahead of the oldest unanswered one
+*/
+#define BULK_SOLVE_YBWC_MIN_EMPTIES 26
+#define BULK_SOLVE_WINDOW_PER_THREAD 256
+
 void setboard(Board_info *board, Options *options, State *state, std::string board_str);
 Search_result go_noprint(Board_info *board, Options *options, State *state);
 void print_search_result_head();
@@ -147,6 +162,131 @@ void solve_problems_transcript_parallel(std::vector<std::string> arg, Options *o
     std::cerr << "done in " << tim() - strt << " ms" << std::endl;
 }
 
+/*
+    @brief position in the reorder buffer of the bulk solver
+
+    @param board                position to solve
+    @param result               result (valid if done)
+    @param done                 solved?
+    @param error_reply          reply if the input line can't be converted to a board (empty if valid)
+*/
+struct Bulk_solve_slot {
+    Board board;
+    Search_result result;
+    bool done;
+    std::string error_reply;
+};
+
+/*
+    @brief solve many positions for throughput
+
+    Positions are kept in a bounded reorder buffer: a thread that finishes a position takes the next one
+    (reading more input if needed), and solved positions at the head of the buffer are answered at once,
+    so a slow position delays output but not the other threads.
+    The transposition table is shared by all positions and not cleared in the batch,
+    so it is not resized here: set -hash for the whole batch.
+    output: <board> <value> <best move> per line, in input order
+            <line> error for a line that can't be converted to a board
+
+    @param arg                  problem file (one board per line, `-` for stdin)
+    @param options              options
+*/
+void solve_problems_bulk(std::vector<std::string> arg, Options *options) {
+    if (arg.size() < 1) {
+        std::cerr << "[ERROR] [FATAL] please input problem file" << std::endl;
+        return;
+    }
+    std::ifstream ifs;
+    if (arg[0] != "-") {
+        ifs.open(arg[0]);
+        if (ifs.fail()) {
+            std::cerr << "[ERROR] [FATAL] no problem file found" << std::endl;
+            return;
+        }
+    }
+    std::istream &is = arg[0] == "-" ? std::cin : ifs;
+    const bool use_book = !options->nobook;
+    const int window_size = (thread_pool.size() + 1) * BULK_SOLVE_WINDOW_PER_THREAD;
+    std::deque<Bulk_solve_slot> slots; // slots.front() is the oldest unanswered position
+    int n_taken = 0; // slots[0, n_taken) are taken by threads
+    bool eof = false;
+    std::mutex mtx;
+    std::condition_variable cv;
+    uint64_t strt = tim();
+    uint64_t n_solved = 0, n_nodes = 0;
+    auto answer_head = [&]() { // call with mtx locked
+        while (!slots.empty() && slots.front().done) {
+            if (slots.front().error_reply.empty()) {
+                std::cout << slots.front().board.to_str() << " " << slots.front().result.value << " " << idx_to_coord(slots.front().result.policy) << "\n";
+                n_nodes += slots.front().result.nodes;
+                ++n_solved;
+                if (options->show_log && n_solved % window_size == 0) {
+                    std::cerr << n_solved << " positions solved in " << tim() - strt << " ms" << std::endl;
+                }
+            } else {
+                std::cout << slots.front().error_reply << "\n";
+            }
+            slots.pop_front();
+            --n_taken;
+        }
+        std::cout.flush();
+        cv.notify_all();
+    };
+    auto worker = [&]() {
+        std::string line;
+        std::unique_lock<std::mutex> lock(mtx);
+        while (true) {
+            while (n_taken == (int)slots.size() && !eof) {
+                if ((int)slots.size() >= window_size) { // wait for the head to be answered
+                    cv.wait(lock);
+                    continue;
+                }
+                if (!std::getline(is, line)) {
+                    eof = true;
+                    break;
+                }
+                std::pair<Board, int> board_player = convert_board_from_str(line);
+                if (board_player.second != BLACK && board_player.second != WHITE) {
+                    std::cerr << "[ERROR] can't convert board " << line << std::endl;
+                    slots.push_back({Board(), Search_result(), true, line + " error"}); // answered in order, never searched
+                    ++n_taken;
+                    answer_head();
+                    continue;
+                }
+                slots.push_back({board_player.first, Search_result(), false});
+            }
+            if (n_taken == (int)slots.size()) { // no position left, this thread can help YBWC of others
+                break;
+            }
+            Bulk_solve_slot *slot = &slots[n_taken++]; // references to deque elements survive push_back / pop_front of others
+            Board board = slot->board;
+            lock.unlock();
+            Search_result result = ai(board, options->level, use_book, 0, HW2 - board.n_discs() >= BULK_SOLVE_YBWC_MIN_EMPTIES, false);
+            lock.lock();
+            slot->result = result;
+            slot->done = true;
+            if (slots.front().done) {
+                answer_head();
+            }
+        }
+    };
+    std::vector<std::future<void>> tasks;
+    for (int i = 0; i < thread_pool.size(); ++i) {
+        bool pushed;
+        tasks.emplace_back(thread_pool.push(&pushed, worker));
+        if (!pushed) {
+            tasks.pop_back();
+            break;
+        }
+    }
+    worker();
+    for (std::future<void> &task: tasks) {
+        task.get();
+    }
+    uint64_t elapsed = tim() - strt;
+    std::cerr << n_solved << " positions " << n_nodes << " nodes in " << ((double)elapsed / 1000) << "s NPS " << calc_nps(n_nodes, elapsed) << " positions per second " << (double)n_solved * 1000 / std::max<uint64_t>(1, elapsed) << std::endl;
+}
+
 void execute_special_tasks(Options options) {
     // move ordering tuning
     #if TUNE_MOVE_ORDERING
@@ -568,7 +708,7 @@ void self_play_board_lossless_lines(std::vector<std::string> arg, Options *optio
 }
 
 
-void perft_commandline(std::vector<std::string> arg) {
+void perft_commandline(std::vector<std::string> arg, std::vector<std::string> hash_arg) {
     if (arg.size() < 2) {
         std::cerr << "please input <depth> <mode>" << std::endl;
         std::exit(1);
@@ -594,16 +734,71 @@ void perft_commandline(std::vector<std::string> arg) {
         std::cout << "depth must be in [1, 60], got " << depth << std::endl;
         std::exit(1);
     }
+    Perft_hash hash;
+    if (hash_arg.size()) {
+        int hash_level = -1;
+        try {
+            hash_level = std::stoi(hash_arg[0]);
+        } catch (const std::invalid_argument& e) {
+            hash_level = -1;
+        } catch (const std::out_of_range& e) {
+            hash_level = -1;
+        }
+        if (hash_level < PERFT_HASH_MIN_LEVEL || PERFT_HASH_MAX_LEVEL < hash_level) {
+            std::cout << "perft hash level must be in [" << PERFT_HASH_MIN_LEVEL << ", " << PERFT_HASH_MAX_LEVEL << "], got " << hash_arg[0] << std::endl;
+            std::exit(1);
+        }
+        if (!hash.init(hash_level)) {
+            std::cerr << "[ERROR] can't allocate perft hash level " << hash_level << std::endl;
+            std::exit(1);
+        }
+    }
     Board board;
     board.reset();
+    int n_threads = thread_pool.size() + 1;
     uint64_t strt = tim();
-    uint64_t res;
-    if (mode == 1) {
-        res = perft(&board, depth, false);
-    } else{
-        res = perft_no_pass_count(&board, depth, false);
+    uint64_t res = perft_parallel(board, depth, mode == 1, n_threads, hash.enabled() ? &hash : nullptr);
+    uint64_t elapsed = tim() - strt;
+    std::cout << "perft mode " << mode << " depth " << depth << " " << res << " leaves found in " << elapsed << " ms";
+    std::cout << " threads " << n_threads << " NPS " << calc_nps(res, elapsed) << " NPS per thread " << calc_nps(res, elapsed) / n_threads;
+    if (hash.enabled()) {
+        std::cout << " hash hits " << hash.get_n_hits();
+    }
+    std::cout << std::endl;
+}
+
+void perft_benchmark(std::vector<std::string> arg) {
+    int depth = 0;
+    try {
+        depth = std::stoi(arg[0]);
+    } catch (const std::invalid_argument& e) {
+        depth = 0;
+    } catch (const std::out_of_range& e) {
+        depth = 0;
+    }
+    if (depth <= 0 || 60 < depth) {
+        std::cout << "depth must be in [1, 60], got " << arg[0] << std::endl;
+        std::exit(1);
+    }
+    Board board;
+    board.reset();
+    int max_n_threads = thread_pool.size() + 1;
+    std::cout << "perft benchmark " << EGAROUCID_REVISION << " build depth " << depth << " (pass counted, no hash)" << std::endl;
+    uint64_t nps_per_thread_single = 0;
+    for (int n_threads: {1, max_n_threads}) {
+        uint64_t strt = tim();
+        uint64_t res = perft_parallel(board, depth, true, n_threads, nullptr);
+        uint64_t elapsed = tim() - strt;
+        uint64_t nps_per_thread = calc_nps(res, elapsed) / n_threads;
+        if (n_threads == 1) {
+            nps_per_thread_single = nps_per_thread;
+        }
+        std::cout << "threads " << n_threads << " " << res << " leaves in " << elapsed << " ms NPS " << calc_nps(res, elapsed) << " NPS per thread " << nps_per_thread;
+        std::cout << " efficiency " << (double)nps_per_thread / std::max<uint64_t>(1, nps_per_thread_single) << std::endl;
+        if (max_n_threads == 1) {
+            break;
+        }
     }
-    std::cout << "perft mode " << mode << " depth " << depth << " " << res << " leaves found in " << tim() - strt << " ms" << std::endl;
 }
 
 void minimax_commandline(std::vector<std::string> arg) {
@@ -631,4 +826,359 @@ void minimax_commandline(std::vector<std::string> arg) {
     uint64_t strt = tim();
     int res = minimax(&board, depth);
     std::cout << "minimax depth " << depth << " value " << res << " in " << tim() - strt << " ms" << std::endl;
-}
\ No newline at end of file
+}
+
+void convert_book_mmap(std::vector<std::string> arg, Options *options) {
+    if (arg.size() < 2) {
+        std::cerr << "please input <in_book> <out_book>" << std::endl;
+        std::exit(1);
+    }
+    uint64_t strt = tim();
+    if (!book_init(arg[0], options->show_log)) {
+        std::cerr << "[ERROR] can't import book " << arg[0] << std::endl;
+        std::exit(1);
+    }
+    std::cerr << "book imported in " << tim() - strt << " ms" << std::endl;
+    if (!book_save_as_mmap(arg[1])) {
+        std::cerr << "[ERROR] can't save memory-mapped book " << arg[1] << std::endl;
+        std::exit(1);
+    }
+    int64_t n_mismatch = book_check_mmap_parity(arg[1]);
+    if (n_mismatch != 0) {
+        std::cerr << "[ERROR] memory-mapped book mismatch " << n_mismatch << " boards" << std::endl;
+        std::exit(1);
+    }
+    strt = tim();
+    Book_mmap mapped;
+    mapped.open(arg[1], false);
+    std::cout << "converted " << mapped.size() << " boards to " << arg[1] << " (opened in " << tim() - strt << " ms)" << std::endl;
+}
+
+/*
+    @brief number of runs of NUMA benchmark
+
+    runs without / with pinning alternate as ABBA..., so neither comes always first
+*/
+#define NUMA_BENCHMARK_N_RUNS 4
+
+/*
+    @brief search all problems and return total nodes and time
+
+    @param boards               problems
+    @param options              options
+    @return total result
+*/
+Search_result numa_benchmark_run(const std::vector<Board> &boards, Options *options) {
+    Search_result total;
+    total.nodes = 0;
+    total.time = 0;
+    for (const Board &board: boards) {
+        transposition_table.init();
+        Search_result res = ai(board, options->level, false, 0, true, false);
+        total.nodes += res.nodes;
+        total.time += res.time;
+    }
+    total.nps = calc_nps(total.nodes, total.time);
+    return total;
+}
+
+void numa_benchmark(std::vector<std::string> arg, Options *options, State *state) {
+    if (arg.size() < 1) {
+        std::cerr << "[ERROR] [FATAL] please input problem file" << std::endl;
+        return;
+    }
+    std::ifstream ifs(arg[0]);
+    if (ifs.fail()) {
+        std::cerr << "[ERROR] [FATAL] no problem file found" << std::endl;
+        return;
+    }
+    std::vector<Board> boards;
+    std::string line;
+    while (std::getline(ifs, line)) {
+        std::pair<Board, int> board_player = convert_board_from_str(line);
+        if (board_player.second != BLACK && board_player.second != WHITE) {
+            continue;
+        }
+        boards.emplace_back(board_player.first);
+    }
+    int numa_policy = options->numa_policy;
+    if (numa_policy == NUMA_POLICY_DEFAULT) {
+        numa_policy = NUMA_POLICY_INTERLEAVE;
+    }
+    std::cout << boards.size() << " problems level " << options->level << " threads " << options->n_threads << " NUMA nodes " << numa_get_n_nodes() << std::endl;
+    uint64_t nodes[2] = {0, 0};
+    uint64_t times[2] = {0, 0};
+    for (int run = 0; run < NUMA_BENCHMARK_N_RUNS; ++run) {
+        int with_numa = (run + run / 2) % 2; // order: without, with, with, without, ...
+        thread_pool.set_pin_threads(with_numa);
+        thread_pool.resize(std::max(0, options->n_threads - 1));
+        if (with_numa) {
+            affinity_pin_current_thread(0);
+        } else {
+            affinity_unpin_current_thread();
+        }
+        numa_memory_policy = with_numa ? numa_policy : NUMA_POLICY_DEFAULT;
+        #if USE_CHANGEABLE_HASH_LEVEL
+            hash_resize(DEFAULT_HASH_LEVEL, options->hash_level, options->binary_path, false);
+        #else
+            transposition_table.set_size();
+        #endif
+        Search_result total = numa_benchmark_run(boards, options);
+        nodes[with_numa] += total.nodes;
+        times[with_numa] += total.time;
+        std::cout << "run " << run + 1 << " " << (with_numa ? "pinned, " : "not pinned, ") << numa_policy_names[numa_memory_policy] << " hash: ";
+        std::cout << total.nodes << " nodes in " << ((double)total.time / 1000) << "s NPS " << total.nps << std::endl;
+    }
+    uint64_t nps[2];
+    for (int with_numa = 0; with_numa < 2; ++with_numa) {
+        nps[with_numa] = calc_nps(nodes[with_numa], times[with_numa]);
+        std::cout << (with_numa ? "pinned" : "not pinned") << " total NPS " << nps[with_numa] << std::endl;
+    }
+    std::cout << "NPS ratio " << (double)nps[1] / std::max<uint64_t>(1, nps[0]) << std::endl;
+}
+
+void time_calibration_commandline(std::vector<std::string> arg, Options *options) {
+    int seconds = 0;
+    try {
+        seconds = std::stoi(arg[0]);
+    } catch (const std::invalid_argument& e) {
+        seconds = 0;
+    } catch (const std::out_of_range& e) {
+        seconds = 0;
+    }
+    if (seconds <= 0) {
+        std::cerr << "[ERROR] invalid calibration time" << std::endl;
+        std::exit(1);
+    }
+    time_calibration.init();
+    time_calibration_run(seconds * 1000ULL, true, true);
+    time_calibration.print(std::cout);
+    if (time_calibration.save()) {
+        std::cout << "time calibration profile saved" << std::endl;
+    } else {
+        std::cerr << "[ERROR] can't save time calibration profile" << std::endl;
+    }
+}
+
+void compact_solved_store(std::vector<std::string> arg, Options *options) {
+    uint64_t strt = tim();
+    if (!solved_store.open(arg[0], options->show_log)) {
+        std::cerr << "[ERROR] can't open solved position store " << arg[0] << std::endl;
+        std::exit(1);
+    }
+    uint64_t n_before = solved_store.size();
+    if (!solved_store.compact()) {
+        std::cerr << "[ERROR] can't compact solved position store " << arg[0] << std::endl;
+        std::exit(1);
+    }
+    std::cout << "compacted " << arg[0] << " " << n_before << " positions in " << tim() - strt << " ms" << std::endl;
+}
+
+void compact_book(std::vector<std::string> arg, Options *options) {
+    uint64_t strt = tim();
+    if (!book_init(arg[0], options->show_log)) {
+        std::cerr << "[ERROR] can't open book " << arg[0] << std::endl;
+        std::exit(1);
+    }
+    book.save_egbk3(arg[0], arg[0] + ".bak");
+    std::cout << "compacted " << arg[0] << " " << book.size() << " boards in " << tim() - strt << " ms" << std::endl;
+}
+
+void eval_load_benchmark(std::vector<std::string> arg, Options *options) {
+    int n_times = 0;
+    try {
+        n_times = std::stoi(arg[0]);
+    } catch (const std::invalid_argument& e) {
+        n_times = 0;
+    } catch (const std::out_of_range& e) {
+        n_times = 0;
+    }
+    if (n_times <= 0) {
+        std::cerr << "[ERROR] invalid number of times" << std::endl;
+        std::exit(1);
+    }
+    std::cout << "evaluation file " << options->eval_file << " " << n_times << " times" << std::endl;
+    uint64_t strt = tim();
+    uint64_t n_params = 0;
+    for (int i = 0; i < n_times; ++i) {
+        bool failed = false;
+        std::vector<int16_t> unzipped_params = load_unzip_egev2(options->eval_file.c_str(), false, &failed);
+        if (failed) {
+            std::exit(1);
+        }
+        n_params = unzipped_params.size();
+    }
+    uint64_t vector_time = tim() - strt;
+    strt = tim();
+    for (int i = 0; i < n_times; ++i) {
+        if (!load_eval_file(options->eval_file.c_str(), false)) {
+            std::exit(1);
+        }
+    }
+    uint64_t stream_time = tim() - strt;
+    std::cout << n_params << " parameters" << std::endl;
+    std::cout << "vector decode (without copy to parameter arrays): " << (double)vector_time / n_times << " ms" << std::endl;
+    std::cout << "streaming load into parameter arrays: " << (double)stream_time / n_times << " ms" << std::endl;
+}
+
+#if USE_SIMD
+/*
+    @brief record a random game for evaluation kernel benchmark
+
+    @param boards               boards before each move
+    @param flips                moves
+    @param passed               the player passed before the move?
+    @param pass_boards          boards before the pass (only if passed)
+*/
+void eval_kernel_benchmark_random_game(std::vector<Board> &boards, std::vector<Flip> &flips, std::vector<bool> &passed, std::vector<Board> &pass_boards) {
+    Board board;
+    board.reset();
+    Board pass_board;
+    bool pass_flag = false;
+    while (!board.is_end()) {
+        uint64_t legal = board.get_legal();
+        if (legal == 0) {
+            pass_board = board;
+            board.pass();
+            pass_flag = true;
+            continue;
+        }
+        int n_legal = pop_count_ull(legal);
+        int r = myrandrange(0, n_legal);
+        for (int i = 0; i < r; ++i) {
+            legal &= legal - 1;
+        }
+        Flip flip;
+        calc_flip(&flip, &board, ctz(legal));
+        boards.emplace_back(board);
+        flips.emplace_back(flip);
+        passed.emplace_back(pass_flag);
+        pass_boards.emplace_back(pass_board);
+        board.move_board(&flip);
+        pass_flag = false;
+    }
+}
+
+template <typename Func>
+double eval_kernel_benchmark_measure(int n_times, uint64_t n_calls, Func func) {
+    auto strt = std::chrono::steady_clock::now();
+    for (int t = 0; t < n_times; ++t) {
+        func();
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - strt).count();
+    return (double)elapsed / ((double)n_times * n_calls);
+}
+
+void eval_kernel_benchmark(std::vector<std::string> arg) {
+    int n_games = 0;
+    try {
+        n_games = std::stoi(arg[0]);
+    } catch (const std::invalid_argument& e) {
+        n_games = 0;
+    } catch (const std::out_of_range& e) {
+        n_games = 0;
+    }
+    if (n_games <= 0) {
+        std::cerr << "[ERROR] invalid number of games" << std::endl;
+        std::exit(1);
+    }
+    constexpr int N_TIMES = 20;
+    std::vector<Board> boards;
+    std::vector<Flip> flips;
+    std::vector<bool> passed;
+    std::vector<Board> pass_boards;
+    std::vector<int> game_starts;
+    for (int i = 0; i < n_games; ++i) {
+        game_starts.emplace_back(boards.size());
+        eval_kernel_benchmark_random_game(boards, flips, passed, pass_boards);
+    }
+    game_starts.emplace_back(boards.size());
+    std::vector<Eval_features> features(boards.size());
+    std::vector<int> phases(boards.size());
+    for (int i = 0; i < (int)boards.size(); ++i) {
+        Eval_search eval;
+        calc_eval_features(&boards[i], &eval);
+        features[i] = eval.features[0];
+        phases[i] = (pop_count_ull(boards[i].player | boards[i].opponent) - 4) / PHASE_N_DISCS;
+    }
+    std::cout << n_games << " random games " << boards.size() << " positions" << std::endl;
+    volatile int sink = 0;
+    double calc_pattern_avx2_ns = eval_kernel_benchmark_measure(N_TIMES, boards.size(), [&]() {
+        int sum = 0;
+        for (int i = 0; i < (int)boards.size(); ++i) {
+            sum += calc_pattern_avx2(phases[i], &features[i]);
+        }
+        sink = sink + sum;
+    });
+    Eval_search eval;
+    double eval_move_avx2_ns = eval_kernel_benchmark_measure(N_TIMES, boards.size(), [&]() {
+        for (int g = 0; g < n_games; ++g) {
+            eval.features[0] = features[game_starts[g]];
+            eval.feature_idx = 0;
+            for (int i = game_starts[g]; i < game_starts[g + 1]; ++i) {
+                if (passed[i]) {
+                    eval.features[0] = features[i];
+                }
+                eval_move_avx2(&eval, &flips[i], &boards[i]);
+                eval.feature_idx = 0; // keep features of the next position in the same slot
+                eval.features[0] = eval.features[1];
+            }
+        }
+        sink = sink + eval.features[0].f128[0][0];
+    });
+    std::cout << "AVX2    calc_pattern " << calc_pattern_avx2_ns << " ns/call eval_move " << eval_move_avx2_ns << " ns/call" << std::endl;
+#if USE_AVX512_EVAL
+    double calc_pattern_avx512_ns = eval_kernel_benchmark_measure(N_TIMES, boards.size(), [&]() {
+        int sum = 0;
+        for (int i = 0; i < (int)boards.size(); ++i) {
+            sum += calc_pattern_avx512(phases[i], &features[i]);
+        }
+        sink = sink + sum;
+    });
+    double eval_move_avx512_ns = eval_kernel_benchmark_measure(N_TIMES, boards.size(), [&]() {
+        for (int g = 0; g < n_games; ++g) {
+            eval.features[0] = features[game_starts[g]];
+            eval.feature_idx = 0;
+            for (int i = game_starts[g]; i < game_starts[g + 1]; ++i) {
+                if (passed[i]) {
+                    eval.features[0] = features[i];
+                }
+                eval_move_avx512(&eval, &flips[i], &boards[i]);
+                eval.feature_idx = 0;
+                eval.features[0] = eval.features[1];
+            }
+        }
+        sink = sink + eval.features[0].f128[0][0];
+    });
+    std::cout << "AVX-512 calc_pattern " << calc_pattern_avx512_ns << " ns/call eval_move " << eval_move_avx512_ns << " ns/call" << std::endl;
+    std::cout << "speedup calc_pattern " << calc_pattern_avx2_ns / calc_pattern_avx512_ns << " eval_move " << eval_move_avx2_ns / eval_move_avx512_ns << std::endl;
+    // check both kernels give the same result
+    uint64_t n_mismatches = 0;
+    for (int g = 0; g < n_games; ++g) {
+        Eval_search eval2, eval512;
+        eval2.features[0] = eval512.features[0] = features[game_starts[g]];
+        eval2.feature_idx = eval512.feature_idx = 0;
+        for (int i = game_starts[g]; i < game_starts[g + 1]; ++i) {
+            if (passed[i]) {
+                eval_pass_avx2(&eval2, &pass_boards[i]);
+                eval_pass_avx512(&eval512, &pass_boards[i]);
+            }
+            for (int phase_idx = 0; phase_idx < N_PHASES; ++phase_idx) {
+                n_mismatches += calc_pattern_avx2(phase_idx, &eval2.features[eval2.feature_idx]) != calc_pattern_avx512(phase_idx, &eval512.features[eval512.feature_idx]);
+            }
+            n_mismatches += calc_pattern_move_ordering_end_avx2(&eval2.features[eval2.feature_idx]) != calc_pattern_move_ordering_end_avx512(&eval512.features[eval512.feature_idx]);
+            eval_move_avx2(&eval2, &flips[i], &boards[i]);
+            eval_move_avx512(&eval512, &flips[i], &boards[i]);
+            n_mismatches += memcmp(&eval2.features[eval2.feature_idx], &eval512.features[eval512.feature_idx], sizeof(Eval_features)) != 0;
+            eval2.features[0] = eval2.features[eval2.feature_idx]; // a game may have 60 moves, more than Eval_search holds
+            eval2.feature_idx = 0;
+            eval512.features[0] = eval512.features[eval512.feature_idx];
+            eval512.feature_idx = 0;
+        }
+    }
+    std::cout << "mismatches " << n_mismatches << std::endl;
+#else
+    std::cout << "AVX-512 evaluation not built (build with HAS_AVX512)" << std::endl;
+#endif
+}
+#endif
@@ -37,6 +37,10 @@ struct Options {
     std::string log_file;
     bool noautopass;
     bool show_value;
+    bool pin_threads;
+    int numa_policy;
+    std::string solved_store_file;
+    std::string eval_image_file;
 };
 
 Options get_options(std::vector<Commandline_option> commandline_options, std::string binary_path) {
@@ -145,6 +149,19 @@ Options get_options(std::vector<Commandline_option> commandline_options, std::st
     if (find_commandline_option(commandline_options, ID_DISABLE_AUTO_CACHE_CLEAR)) {
         transposition_table_auto_reset_importance = false;
     }
+    if (find_commandline_option(commandline_options, ID_TT_POLICY)) {
+        std::vector<std::string> arg = get_commandline_option_arg(commandline_options, ID_TT_POLICY);
+        bool found = false;
+        for (int policy = 0; policy < N_TT_REPLACEMENT_POLICY; ++policy) {
+            if (arg[0] == tt_replacement_policy_names[policy] || arg[0] == std::to_string(policy)) {
+                transposition_table_replacement_policy = policy;
+                found = true;
+            }
+        }
+        if (!found) {
+            std::cerr << "[ERROR] invalid transposition table replacement policy" << std::endl;
+        }
+    }
     res.noboard = find_commandline_option(commandline_options, ID_NOBOARD);
     res.log_to_file = false;
     if (find_commandline_option(commandline_options, ID_LOG_TO_FILE)) {
@@ -160,5 +177,76 @@ Options get_options(std::vector<Commandline_option> commandline_options, std::st
     }
     res.noautopass = find_commandline_option(commandline_options, ID_NOAUTOPASS);
     res.show_value = find_commandline_option(commandline_options, ID_SHOWVALUE);
+    res.pin_threads = find_commandline_option(commandline_options, ID_PIN_THREADS);
+    res.numa_policy = NUMA_POLICY_DEFAULT;
+    if (find_commandline_option(commandline_options, ID_NUMA)) {
+        std::vector<std::string> arg = get_commandline_option_arg(commandline_options, ID_NUMA);
+        bool found = false;
+        for (int policy = 0; policy < N_NUMA_POLICY; ++policy) {
+            if (arg[0] == numa_policy_names[policy] || arg[0] == std::to_string(policy)) {
+                res.numa_policy = policy;
+                found = true;
+            }
+        }
+        if (!found) {
+            std::cerr << "[ERROR] invalid NUMA policy" << std::endl;
+        }
+        #if !USE_NUMA
+            std::cerr << "[WARNING] built without HAS_NUMA, NUMA policy is ignored" << std::endl;
+        #endif
+    }
+    res.solved_store_file = "";
+    if (find_commandline_option(commandline_options, ID_SOLVED_STORE)) {
+        res.solved_store_file = get_commandline_option_arg(commandline_options, ID_SOLVED_STORE)[0];
+    }
+    if (find_commandline_option(commandline_options, ID_LAZY_SMP)) {
+        #if USE_LAZY_SMP
+            std::vector<std::string> arg = get_commandline_option_arg(commandline_options, ID_LAZY_SMP);
+            try {
+                int max_main_depth = std::stoi(arg[0]);
+                int max_depth_offset = std::stoi(arg[1]);
+                if (max_main_depth < 0 || max_depth_offset < 0) {
+                    std::cerr << "[ERROR] lazy smp argument out of range" << std::endl;
+                } else {
+                    lazy_smp_schedule.max_main_depth = max_main_depth;
+                    lazy_smp_schedule.max_depth_offset = max_depth_offset;
+                }
+            } catch (const std::invalid_argument& e) {
+                std::cerr << "[ERROR] invalid lazy smp argument" << std::endl;
+            } catch (const std::out_of_range& e) {
+                std::cerr << "[ERROR] lazy smp argument out of range" << std::endl;
+            }
+        #else
+            std::cerr << "[WARNING] built without Lazy SMP, -lazysmp is ignored" << std::endl;
+        #endif
+    }
+    if (find_commandline_option(commandline_options, ID_LAZY_SMP_MPC)) {
+        #if USE_LAZY_SMP
+            std::vector<std::string> arg = get_commandline_option_arg(commandline_options, ID_LAZY_SMP_MPC);
+            bool found = false;
+            for (int mpc_level = 0; mpc_level <= MPC_100_LEVEL; ++mpc_level) {
+                if (arg[0] == std::to_string(SELECTIVITY_PERCENTAGE[mpc_level])) {
+                    lazy_smp_schedule.deeper_mpc_level = mpc_level;
+                    found = true;
+                }
+            }
+            if (!found) {
+                std::cerr << "[ERROR] invalid lazy smp MPC probability" << std::endl;
+            }
+        #else
+            std::cerr << "[WARNING] built without Lazy SMP, -lazysmpmpc is ignored" << std::endl;
+        #endif
+    }
+    if (find_commandline_option(commandline_options, ID_LAZY_SMP_TIME)) {
+        #if USE_LAZY_SMP
+            lazy_smp_schedule.use_time_limit = true;
+        #else
+            std::cerr << "[WARNING] built without Lazy SMP, -lazysmptime is ignored" << std::endl;
+        #endif
+    }
+    res.eval_image_file = "";
+    if (find_commandline_option(commandline_options, ID_EVAL_IMAGE)) {
+        res.eval_image_file = get_commandline_option_arg(commandline_options, ID_EVAL_IMAGE)[0];
+    }
     return res;
 }
\ No newline at end of file
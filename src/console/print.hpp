@@ -18,6 +18,7 @@
 #include "command_definition.hpp"
 #include "commandline_option_definition.hpp"
 #include "function.hpp"
+#include "server.hpp"
 
 #define COUT_TAB "  "
 #define VERSION_TAB_SIZE 10
@@ -471,7 +472,7 @@ void print_transcript(std::vector<Board> boards) {
     std::cout << std::endl;
 }
 
-void print_special_commandline_options(std::vector<Commandline_option> commandline_options) {
+void print_special_commandline_options(std::vector<Commandline_option> commandline_options, Options *options) {
     if (find_commandline_option(commandline_options, ID_VERSION)) {
         print_version();
         std::exit(0);
@@ -485,7 +486,19 @@ void print_special_commandline_options(std::vector<Commandline_option> commandli
         bit_init();
         mobility_init();
         flip_init();
-        perft_commandline(get_commandline_option_arg(commandline_options, ID_PERFT));
+        thread_pool.resize(std::max(0, options->n_threads - 1));
+        std::vector<std::string> hash_arg;
+        if (find_commandline_option(commandline_options, ID_PERFT_HASH)) {
+            hash_arg = get_commandline_option_arg(commandline_options, ID_PERFT_HASH);
+        }
+        perft_commandline(get_commandline_option_arg(commandline_options, ID_PERFT), hash_arg);
+        std::exit(0);
+    } else if (find_commandline_option(commandline_options, ID_PERFT_BENCHMARK)) {
+        bit_init();
+        mobility_init();
+        flip_init();
+        thread_pool.resize(std::max(0, options->n_threads - 1));
+        perft_benchmark(get_commandline_option_arg(commandline_options, ID_PERFT_BENCHMARK));
         std::exit(0);
     }
 }
@@ -512,5 +525,39 @@ void execute_special_commandline_tasks(std::vector<Commandline_option> commandli
     } else if (find_commandline_option(commandline_options, ID_SOLVE_PARALLEL_TRANSCRIPT)) {
         solve_problems_transcript_parallel(get_commandline_option_arg(commandline_options, ID_SOLVE_PARALLEL_TRANSCRIPT), options, state);
         std::exit(0);
+    } else if (find_commandline_option(commandline_options, ID_SOLVE_BULK)) {
+        solve_problems_bulk(get_commandline_option_arg(commandline_options, ID_SOLVE_BULK), options);
+        std::exit(0);
+    } else if (find_commandline_option(commandline_options, ID_CONVERT_BOOK_MMAP)) {
+        convert_book_mmap(get_commandline_option_arg(commandline_options, ID_CONVERT_BOOK_MMAP), options);
+        std::exit(0);
+    } else if (find_commandline_option(commandline_options, ID_SERVER)) {
+        server_mode(options);
+        std::exit(0);
+    } else if (find_commandline_option(commandline_options, ID_NUMA_BENCHMARK)) {
+        numa_benchmark(get_commandline_option_arg(commandline_options, ID_NUMA_BENCHMARK), options, state);
+        std::exit(0);
+    } else if (find_commandline_option(commandline_options, ID_TIME_CALIBRATION)) {
+        time_calibration_commandline(get_commandline_option_arg(commandline_options, ID_TIME_CALIBRATION), options);
+        std::exit(0);
+    } else if (find_commandline_option(commandline_options, ID_TIME_CALIBRATION_INFO)) {
+        time_calibration.print(std::cout);
+        std::exit(0);
+    } else if (find_commandline_option(commandline_options, ID_COMPACT_SOLVED_STORE)) {
+        compact_solved_store(get_commandline_option_arg(commandline_options, ID_COMPACT_SOLVED_STORE), options);
+        std::exit(0);
+    } else if (find_commandline_option(commandline_options, ID_COMPACT_BOOK)) {
+        compact_book(get_commandline_option_arg(commandline_options, ID_COMPACT_BOOK), options);
+        std::exit(0);
+    } else if (find_commandline_option(commandline_options, ID_EVAL_LOAD_BENCHMARK)) {
+        eval_load_benchmark(get_commandline_option_arg(commandline_options, ID_EVAL_LOAD_BENCHMARK), options);
+        std::exit(0);
+    } else if (find_commandline_option(commandline_options, ID_EVAL_KERNEL_BENCHMARK)) {
+        #if USE_SIMD
+            eval_kernel_benchmark(get_commandline_option_arg(commandline_options, ID_EVAL_KERNEL_BENCHMARK));
+        #else
+            std::cerr << "[ERROR] evaluation kernel benchmark needs SIMD build" << std::endl;
+        #endif
+        std::exit(0);
     }
 }
\ No newline at end of file
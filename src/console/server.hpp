@@ -0,0 +1,340 @@
+/*
+    Egaroucid Project
+
+    @file server.hpp
+        Batch analysis server over stdin / stdout
+    @date 2021-2025
+    @author Takuto Yamana
+    @license GPL-3.0 license
+*/
+
+#pragma once
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <deque>
+#include <vector>
+#include <future>
+#include <algorithm>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include "./../engine/engine_all.hpp"
+#include "option.hpp"
+
+/*
+    Protocol (one request / reply per line)
+
+    request:
+        id=<tag> board=<board> [level=<level>] [time=<msec>] [alpha=<alpha>] [beta=<beta>] [multipv=<n>] [book=<0|1>]
+        <board> is 64 cells (`B` / `W` / `-`) followed by the player to move, without spaces
+        `quit` or EOF finishes the server after all requests are answered
+    reply (out of order, tagged by id):
+        id=<tag> move=<coord> value=<value> depth=<depth> probability=<probability> nodes=<nodes> time=<msec> [pass=1] [pv=<coord>:<value>,...]
+        id=<tag> error=<message>
+
+    Requests are searched concurrently on the thread pool with the shared transposition table.
+    Idle workers help running searches through YBWC splits.
+*/
+
+/*
+    @brief analysis request
+
+    @param id                   tag of the request
+    @param board                board to analyze (player to move is board.player)
+    @param level                level (ignored if time_limit is given)
+    @param time_limit           time limit in msec (TIME_LIMIT_INF for level search)
+    @param alpha                search window (alpha)
+    @param beta                 search window (beta)
+    @param n_pv                 number of best moves to report
+    @param use_book             use book?
+*/
+struct Server_request {
+    std::string id;
+    Board board;
+    int level;
+    uint64_t time_limit;
+    int alpha;
+    int beta;
+    int n_pv;
+    bool use_book;
+};
+
+std::mutex server_output_mtx;
+
+void server_reply(const std::string &line) {
+    std::lock_guard<std::mutex> lock(server_output_mtx);
+    std::cout << line << std::endl;
+}
+
+bool server_parse_int(const std::string &str, int *res) {
+    try {
+        *res = std::stoi(str);
+    } catch (const std::invalid_argument& e) {
+        return false;
+    } catch (const std::out_of_range& e) {
+        return false;
+    }
+    return true;
+}
+
+/*
+    @brief parse a request line
+
+    @param line                 request line
+    @param options              options (default level)
+    @param req                  parsed request
+    @param error                error message (if returns false)
+    @return parsed?
+*/
+bool server_parse_request(std::string line, const Options *options, Server_request *req, std::string *error) {
+    req->id = "";
+    req->level = options->level;
+    req->time_limit = TIME_LIMIT_INF;
+    req->alpha = -SCORE_MAX;
+    req->beta = SCORE_MAX;
+    req->n_pv = 1;
+    req->use_book = !options->nobook;
+    bool board_found = false;
+    std::istringstream iss(line);
+    std::string token;
+    while (iss >> token) {
+        size_t pos = token.find('=');
+        if (pos == std::string::npos) {
+            *error = "invalid_token_" + token;
+            return false;
+        }
+        std::string key = token.substr(0, pos);
+        std::string value = token.substr(pos + 1);
+        int int_value;
+        if (key == "id") {
+            req->id = value;
+        } else if (key == "board") {
+            std::pair<Board, int> board_player = convert_board_from_str(value);
+            if (board_player.second != BLACK && board_player.second != WHITE) {
+                *error = "invalid_board";
+                return false;
+            }
+            req->board = board_player.first;
+            board_found = true;
+        } else if (key == "level") {
+            if (!server_parse_int(value, &int_value) || int_value < 1 || N_LEVEL <= int_value) {
+                *error = "invalid_level";
+                return false;
+            }
+            req->level = int_value;
+        } else if (key == "time") {
+            if (!server_parse_int(value, &int_value) || int_value <= 0) {
+                *error = "invalid_time";
+                return false;
+            }
+            req->time_limit = int_value;
+        } else if (key == "alpha") {
+            if (!server_parse_int(value, &int_value) || int_value < -SCORE_MAX || SCORE_MAX < int_value) {
+                *error = "invalid_alpha";
+                return false;
+            }
+            req->alpha = int_value;
+        } else if (key == "beta") {
+            if (!server_parse_int(value, &int_value) || int_value < -SCORE_MAX || SCORE_MAX < int_value) {
+                *error = "invalid_beta";
+                return false;
+            }
+            req->beta = int_value;
+        } else if (key == "multipv") {
+            if (!server_parse_int(value, &int_value) || int_value < 1 || HW2 < int_value) {
+                *error = "invalid_multipv";
+                return false;
+            }
+            req->n_pv = int_value;
+        } else if (key == "book") {
+            req->use_book = (value != "0");
+        } else {
+            *error = "unknown_key_" + key;
+            return false;
+        }
+    }
+    if (req->id.empty()) {
+        *error = "no_id";
+        return false;
+    }
+    if (!board_found) {
+        *error = "no_board";
+        return false;
+    }
+    if (req->alpha >= req->beta) {
+        *error = "invalid_window";
+        return false;
+    }
+    return true;
+}
+
+/*
+    @brief search a request and reply
+
+    @param req                  request
+*/
+void server_execute_request(Server_request req) {
+    std::stringstream ss;
+    ss << "id=" << req.id;
+    Board board = req.board;
+    if (board.is_end()) {
+        ss << " move=none value=" << board.score_player() << " depth=0 probability=100 nodes=0 time=0";
+        server_reply(ss.str());
+        return;
+    }
+    int value_sign = 1;
+    if (board.get_legal() == 0) {
+        board.pass();
+        value_sign = -1;
+    }
+    uint64_t strt = tim();
+    uint64_t legal = board.get_legal();
+    std::vector<Search_result> results;
+    uint64_t n_nodes = 0;
+    bool searching = true;
+    if (req.n_pv == 1) {
+        Search_result result = ai_common(board, req.alpha, req.beta, req.level, req.use_book, 0, true, false, legal, false, req.time_limit, &searching);
+        n_nodes += result.nodes;
+        if (is_valid_policy(result.policy) && (legal & (1ULL << result.policy))) {
+            results.emplace_back(result);
+        }
+    } else {
+        int n_pv = std::min(req.n_pv, pop_count_ull(legal));
+        if (req.use_book) { // book moves first, as ai_common would choose them
+            std::vector<Book_value> book_moves = book.get_all_moves_with_value(&board);
+            std::stable_sort(book_moves.begin(), book_moves.end(), [](const Book_value &a, const Book_value &b) { return a.value > b.value; });
+            for (Book_value &move: book_moves) {
+                if ((int)results.size() < n_pv && (legal & (1ULL << move.policy))) {
+                    results.emplace_back(move.to_search_result());
+                    legal ^= 1ULL << move.policy;
+                }
+            }
+        }
+        if ((int)results.size() < n_pv && legal) {
+            std::vector<Search_result> searched = ai_multi_pv(board, req.level, req.alpha, req.beta, n_pv - (int)results.size(), true, false, legal, req.time_limit, &searching);
+            for (const Search_result &result: searched) {
+                results.emplace_back(result);
+            }
+            if (!searched.empty()) {
+                n_nodes = searched[0].nodes; // all results have nodes of the whole multi-PV search
+            }
+        }
+    }
+    uint64_t elapsed = tim() - strt;
+    if (results.empty()) {
+        ss << " error=search_failed";
+        server_reply(ss.str());
+        return;
+    }
+    const Search_result &best = results[0];
+    ss << " move=" << idx_to_coord(best.policy);
+    ss << " value=" << value_sign * best.value;
+    ss << " depth=" << best.depth;
+    ss << " probability=" << best.probability;
+    ss << " nodes=" << n_nodes;
+    ss << " time=" << elapsed;
+    if (value_sign == -1) {
+        ss << " pass=1";
+    }
+    if (req.n_pv > 1) {
+        ss << " pv=";
+        for (int i = 0; i < (int)results.size(); ++i) {
+            if (i) {
+                ss << ",";
+            }
+            ss << idx_to_coord(results[i].policy) << ":" << value_sign * results[i].value;
+        }
+    }
+    server_reply(ss.str());
+}
+
+/*
+    @brief batch analysis server
+
+    reads requests from stdin in another thread and dispatches them to the thread pool.
+    At most one request per worker runs at once, the dispatcher waits on a condition variable
+    for a new request or a finished one. If no worker can be reserved, the dispatcher searches the request by itself.
+
+    @param options              options
+*/
+void server_mode(Options *options) {
+    std::deque<Server_request> queue;
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool input_done = false;
+    int n_running = 0;
+    const int max_running = std::max(1, thread_pool.size());
+    std::thread reader([&]() {
+        std::string line;
+        while (std::getline(std::cin, line)) {
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+            if (line == "quit" || line == "exit") {
+                break;
+            }
+            Server_request req;
+            std::string error;
+            if (!server_parse_request(line, options, &req, &error)) {
+                std::string id = req.id.empty() ? "none" : req.id;
+                server_reply("id=" + id + " error=" + error);
+                continue;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                queue.emplace_back(req);
+            }
+            cv.notify_all();
+        }
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            input_done = true;
+        }
+        cv.notify_all();
+    });
+    std::vector<std::future<void>> futures;
+    while (true) {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait(lock, [&]() { return (!queue.empty() && n_running < max_running) || (queue.empty() && input_done); });
+        if (queue.empty()) { // input done
+            break;
+        }
+        Server_request req = queue.front();
+        queue.pop_front();
+        ++n_running;
+        lock.unlock();
+        for (auto itr = futures.begin(); itr != futures.end();) { // collect finished requests
+            if (itr->wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+                itr->get();
+                itr = futures.erase(itr);
+            } else {
+                ++itr;
+            }
+        }
+        bool pushed = false;
+        if (thread_pool.size()) {
+            std::future<void> f = thread_pool.push(&pushed, [req, &mtx, &cv, &n_running]() {
+                server_execute_request(req);
+                {
+                    std::lock_guard<std::mutex> lock(mtx);
+                    --n_running;
+                }
+                cv.notify_all();
+            });
+            if (pushed) {
+                futures.emplace_back(std::move(f));
+            }
+        }
+        if (!pushed) {
+            server_execute_request(req);
+            lock.lock();
+            --n_running;
+        }
+    }
+    reader.join();
+    for (std::future<void> &f: futures) {
+        f.get();
+    }
+}
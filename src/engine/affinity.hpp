@@ -0,0 +1,221 @@
+/*
+    Egaroucid Project
+
+    @file affinity.hpp
+        Thread pinning and NUMA memory placement
+    @date 2021-2025
+    @author Takuto Yamana
+    @license GPL-3.0 license
+*/
+
+#pragma once
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <cstdint>
+#include <cstddef>
+#include "setting.hpp"
+#if _WIN64 || _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#elif defined(__linux__)
+    #include <sched.h>
+    #include <pthread.h>
+    #include <unistd.h>
+#endif
+#if USE_NUMA
+    #include <numa.h>
+    #include <numaif.h>
+#endif
+
+/*
+    @brief NUMA placement of the transposition table
+
+    NUMA_POLICY_DEFAULT         OS default (first touch by the thread that clears the page)
+    NUMA_POLICY_INTERLEAVE      pages are interleaved among all nodes
+    NUMA_POLICY_PARTITION       table is split into contiguous slices, one slice per node
+*/
+#define NUMA_POLICY_DEFAULT 0
+#define NUMA_POLICY_INTERLEAVE 1
+#define NUMA_POLICY_PARTITION 2
+#define N_NUMA_POLICY 3
+
+const std::string numa_policy_names[N_NUMA_POLICY] = {"default", "interleave", "partition"};
+
+int numa_memory_policy = NUMA_POLICY_DEFAULT;
+
+/*
+    @brief number of NUMA nodes
+
+    @return number of nodes (1 if NUMA is not available)
+*/
+inline int numa_get_n_nodes() {
+#if USE_NUMA
+    if (numa_available() != -1) {
+        return numa_max_node() + 1;
+    }
+#endif
+    return 1;
+}
+
+/*
+    @brief CPUs to pin threads on
+
+    CPUs of different NUMA nodes come in turn, so a few threads are spread over all nodes.
+
+    @return CPU ids in the order of use
+*/
+std::vector<int> affinity_get_cpu_order() {
+    std::vector<int> res;
+#if _WIN64 || _WIN32
+    DWORD_PTR process_mask, system_mask;
+    if (GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask)) {
+        for (int cpu = 0; cpu < (int)(sizeof(DWORD_PTR) * 8); ++cpu) {
+            if (process_mask & ((DWORD_PTR)1 << cpu)) {
+                res.emplace_back(cpu);
+            }
+        }
+    }
+#elif defined(__linux__)
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(cpu_set_t), &allowed) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &allowed)) {
+                res.emplace_back(cpu);
+            }
+        }
+    }
+    #if USE_NUMA
+        int n_nodes = numa_get_n_nodes();
+        if (n_nodes > 1) {
+            std::vector<std::vector<int>> node_cpus(n_nodes);
+            for (int cpu: res) {
+                int node = numa_node_of_cpu(cpu);
+                if (node < 0 || n_nodes <= node) {
+                    node = 0;
+                }
+                node_cpus[node].emplace_back(cpu);
+            }
+            res.clear();
+            for (int i = 0; ; ++i) {
+                bool found = false;
+                for (int node = 0; node < n_nodes; ++node) {
+                    if (i < (int)node_cpus[node].size()) {
+                        res.emplace_back(node_cpus[node][i]);
+                        found = true;
+                    }
+                }
+                if (!found) {
+                    break;
+                }
+            }
+        }
+    #endif
+#endif
+    return res;
+}
+
+/*
+    @brief affinity_get_cpu_order() computed at the first use (before any thread is pinned)
+*/
+const std::vector<int>& affinity_get_cpu_order_cached() {
+    static const std::vector<int> cpu_order = affinity_get_cpu_order();
+    return cpu_order;
+}
+
+/*
+    @brief pin this thread to a CPU
+
+    @param slot                 slot in affinity_get_cpu_order() (0 for the main thread, worker_idx + 1 for workers)
+    @return pinned?
+*/
+bool affinity_pin_current_thread(int slot) {
+    const std::vector<int> &cpu_order = affinity_get_cpu_order_cached();
+    if (cpu_order.empty()) {
+        return false;
+    }
+    int cpu = cpu_order[slot % (int)cpu_order.size()];
+#if _WIN64 || _WIN32
+    return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu) != 0;
+#elif defined(__linux__)
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(cpu, &cpuset);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset) == 0;
+#else
+    return false;
+#endif
+}
+
+/*
+    @brief allow this thread to run on all CPUs again
+
+    @return unpinned?
+*/
+bool affinity_unpin_current_thread() {
+    const std::vector<int> &cpu_order = affinity_get_cpu_order_cached();
+    if (cpu_order.empty()) {
+        return false;
+    }
+#if _WIN64 || _WIN32
+    DWORD_PTR mask = 0;
+    for (const int cpu: cpu_order) {
+        mask |= (DWORD_PTR)1 << cpu;
+    }
+    return SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#elif defined(__linux__)
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    for (const int cpu: cpu_order) {
+        CPU_SET(cpu, &cpuset);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset) == 0;
+#else
+    return false;
+#endif
+}
+
+/*
+    @brief place memory on NUMA nodes
+
+    Called before the memory is cleared. Pages already touched are moved.
+    No effect without libnuma (HAS_NUMA).
+
+    @param ptr                  start of memory
+    @param size                 size in bytes
+    @param policy               NUMA_POLICY_*
+*/
+void numa_place_memory([[maybe_unused]] void *ptr, [[maybe_unused]] size_t size, [[maybe_unused]] int policy) {
+#if USE_NUMA
+    if (policy == NUMA_POLICY_DEFAULT || numa_available() == -1 || size == 0) {
+        return;
+    }
+    const uintptr_t page_size = sysconf(_SC_PAGESIZE);
+    uintptr_t s = ((uintptr_t)ptr + page_size - 1) / page_size * page_size; // mbind needs page-aligned range
+    uintptr_t e = ((uintptr_t)ptr + size) / page_size * page_size;
+    if (s >= e) {
+        return;
+    }
+    if (policy == NUMA_POLICY_INTERLEAVE) {
+        mbind((void*)s, e - s, MPOL_INTERLEAVE, numa_all_nodes_ptr->maskp, numa_all_nodes_ptr->size + 1, MPOL_MF_MOVE);
+    } else if (policy == NUMA_POLICY_PARTITION) {
+        int n_nodes = numa_get_n_nodes();
+        uintptr_t n_pages = (e - s) / page_size;
+        uintptr_t slice_s = s;
+        struct bitmask *mask = numa_allocate_nodemask();
+        for (int node = 0; node < n_nodes; ++node) {
+            uintptr_t slice_e = s + n_pages * (node + 1) / n_nodes * page_size;
+            if (slice_s < slice_e) {
+                numa_bitmask_clearall(mask);
+                numa_bitmask_setbit(mask, node);
+                mbind((void*)slice_s, slice_e - slice_s, MPOL_BIND, mask->maskp, mask->size + 1, MPOL_MF_MOVE);
+            }
+            slice_s = slice_e;
+        }
+        numa_free_nodemask(mask);
+    }
+#endif
+}
@@ -20,6 +20,7 @@
 #include "util.hpp"
 #include "clogsearch.hpp"
 #include "time_management.hpp"
+#include "lazy_smp.hpp"
 
 constexpr int AI_TYPE_BOOK = 1000;
 
@@ -29,13 +30,9 @@ constexpr int PONDER_ENDSEARCH_PRESEARCH_OFFSET_TIMELIMIT = 2;
 
 constexpr int NOBOOK_SEARCH_LEVEL = 10;
 
-constexpr int  PONDER_START_SELFPLAY_DEPTH = 21;
+constexpr uint64_t MULTI_PV_ITERATION_TIME_GROWTH = 4; // next iteration of multi-PV search is estimated to take this times the last one
 
-struct Lazy_SMP_task {
-    uint_fast8_t mpc_level;
-    int depth;
-    bool is_end_search;
-};
+constexpr int  PONDER_START_SELFPLAY_DEPTH = 21;
 
 struct Ponder_elem {
     Flip flip;
@@ -59,6 +56,51 @@ inline uint64_t get_this_search_time_limit(uint64_t time_limit, uint64_t elapsed
     return time_limit - elapsed;
 }
 
+/*
+    @brief Go to next iteration of iterative deepening (fixed depth)
+
+    @param is_end_search        final search is endgame search?
+    @param depth                final depth
+    @param mpc_level            final MPC level
+    @param main_depth           depth of this iteration (updated)
+    @param main_mpc_level       MPC level of this iteration (updated)
+    @return false if all iterations are done
+*/
+inline bool iterative_deepening_next(bool is_end_search, int depth, uint_fast8_t mpc_level, int *main_depth, int *main_mpc_level) {
+    if (is_end_search && *main_depth >= depth - IDSEARCH_ENDSEARCH_PRESEARCH_OFFSET) {
+        if (*main_depth < depth) {
+            *main_depth = depth;
+            if (depth <= 27 && mpc_level >= MPC_88_LEVEL) {
+                *main_mpc_level = MPC_88_LEVEL;
+            } else {
+                *main_mpc_level = MPC_74_LEVEL;
+            }
+        } else{
+            if (*main_mpc_level < mpc_level) {
+                if (
+                    (*main_mpc_level >= MPC_74_LEVEL && mpc_level > MPC_74_LEVEL && depth <= 22) || 
+                    (*main_mpc_level >= MPC_88_LEVEL && mpc_level > MPC_88_LEVEL && depth <= 25) || 
+                    (*main_mpc_level >= MPC_93_LEVEL && mpc_level > MPC_93_LEVEL && depth <= 29) || 
+                    (*main_mpc_level >= MPC_98_LEVEL && mpc_level > MPC_98_LEVEL)
+                ) {
+                    *main_mpc_level = mpc_level;
+                } else{
+                    ++(*main_mpc_level);
+                }
+            } else{
+                return false;
+            }
+        }
+    } else {
+        if (*main_depth <= 15 && *main_depth < depth - 3) {
+            *main_depth += 3;
+        } else{
+            ++(*main_depth);
+        }
+    }
+    return true;
+}
+
 void iterative_deepening_search(Board board, int alpha, int beta, int depth, uint_fast8_t mpc_level, bool show_log, std::vector<Clog_result> clogs, uint64_t use_legal, bool use_multi_thread, Search_result *result, bool *searching) {
     uint64_t strt = tim();
     result->value = SCORE_UNDEFINED;
@@ -73,15 +115,11 @@ void iterative_deepening_search(Board board, int alpha, int beta, int depth, uin
     if (show_log) {
         std::cerr << "thread pool size " << thread_pool.size() << " n_idle " << thread_pool.get_n_idle() << std::endl;
     }
+    uint64_t n_main_nodes = 0;
 #if USE_LAZY_SMP
-    std::vector<Search> searches(thread_pool.size() + 1);
+    Lazy_SMP lazy_smp(&board, alpha, beta, use_legal);
 #endif
     while (main_depth <= depth && main_mpc_level <= mpc_level && global_searching && *searching) {
-#if USE_LAZY_SMP
-        for (Search &search: searches) {
-            search.n_nodes = 0;
-        }
-#endif
         bool main_is_end_search = false;
         if (main_depth >= max_depth) {
             main_is_end_search = true;
@@ -89,67 +127,20 @@ void iterative_deepening_search(Board board, int alpha, int beta, int depth, uin
         }
         bool is_last_search = (main_depth == depth) && (main_mpc_level == mpc_level);
 #if USE_LAZY_SMP
-        std::vector<std::future<int>> parallel_tasks;
-        std::vector<int> sub_depth_arr;
-        int sub_max_mpc_level[61];
-        bool sub_searching = true;
-        int sub_depth = main_depth;
-        if (use_multi_thread && !(is_end_search && main_depth == depth) && main_depth <= 10) {
-            int max_thread_size = thread_pool.size();
-            for (int i = 0; i < main_depth - 14; ++i) {
-                max_thread_size *= 0.9;
-            }
-            sub_max_mpc_level[main_depth] = main_mpc_level + 1;
-            for (int i = main_depth + 1; i < 61; ++i) {
-                sub_max_mpc_level[i] = MPC_74_LEVEL;
-            }
-            for (int sub_thread_idx = 0; sub_thread_idx < max_thread_size && sub_thread_idx < searches.size() && global_searching && *searching; ++sub_thread_idx) {
-                int ntz = ctz_uint32(sub_thread_idx + 1);
-                int sub_depth = std::min(max_depth, main_depth + ntz);
-                uint_fast8_t sub_mpc_level = sub_max_mpc_level[sub_depth];
-                bool sub_is_end_search = (sub_depth == max_depth);
-                if (sub_mpc_level <= MPC_100_LEVEL) {
-                    //std::cerr << sub_thread_idx << " " << sub_depth << " " << SELECTIVITY_PERCENTAGE[sub_mpc_level] << std::endl;
-                    searches[sub_thread_idx] = Search{&board, sub_mpc_level, false, true};
-                    bool pushed = false;
-                    parallel_tasks.emplace_back(thread_pool.push(&pushed, std::bind(&nega_scout, &searches[sub_thread_idx], alpha, beta, sub_depth, false, use_legal, sub_is_end_search, &sub_searching)));
-                    sub_depth_arr.emplace_back(sub_depth);
-                    ++sub_max_mpc_level[sub_depth];
-                    if (!pushed) {
-                        parallel_tasks.pop_back();
-                        sub_depth_arr.pop_back();
-                    }
-                }
-            }
-            int max_sub_search_depth = -1;
-            int max_sub_main_mpc_level = 0;
-            bool max_is_only_one = false;
-            for (int i = 0; i < (int)parallel_tasks.size(); ++i) {
-                if (sub_depth_arr[i] > max_sub_search_depth) {
-                    max_sub_search_depth = sub_depth_arr[i];
-                    max_sub_main_mpc_level = searches[i].mpc_level;
-                    max_is_only_one = true;
-                } else if (sub_depth_arr[i] == max_sub_search_depth && max_sub_main_mpc_level < searches[i].mpc_level) {
-                    max_sub_main_mpc_level = searches[i].mpc_level;
-                    max_is_only_one = true;
-                } else if (sub_depth_arr[i] == max_sub_search_depth && searches[i].mpc_level == max_sub_main_mpc_level) {
-                    max_is_only_one = false;
-                }
-            }
+        if (use_multi_thread && !(is_end_search && main_depth == depth)) {
+            lazy_smp.set_tasks(lazy_smp_get_tasks(main_depth, main_mpc_level, max_depth, thread_pool.size()));
+        } else {
+            lazy_smp.set_tasks(std::vector<Lazy_SMP_task>());
         }
+        lazy_smp.check_tt(main_depth, main_mpc_level);
 #endif
         Search main_search(&board, main_mpc_level, use_multi_thread, !is_last_search);        
         std::pair<int, int> id_result = first_nega_scout_legal(&main_search, alpha, beta, main_depth, main_is_end_search, clogs, use_legal, strt, searching);
+        n_main_nodes += main_search.n_nodes;
+        result->nodes = n_main_nodes;
 #if USE_LAZY_SMP
-        sub_searching = false;
-        for (std::future<int> &task: parallel_tasks) {
-            task.get();
-        }
-        for (Search &search: searches) {
-            result->nodes += search.n_nodes;
-        }
+        result->nodes += lazy_smp.get_statistics().n_nodes;
 #endif
-        result->nodes += main_search.n_nodes;
         if (*searching) {
             if (result->value != SCORE_UNDEFINED && !main_is_end_search) {
                 double n_value = (0.9 * result->value + 1.1 * id_result.first) / 2.0;
@@ -176,43 +167,103 @@ void iterative_deepening_search(Board board, int alpha, int beta, int depth, uin
                 std::cerr << "mid ";
             }
 #if USE_LAZY_SMP
-            std::cerr << "depth " << result->depth << "@" << SELECTIVITY_PERCENTAGE[main_mpc_level] << "%" << " value " << result->value << " (raw " << id_result.first << ") policy " << idx_to_coord(id_result.second) << " n_worker " << parallel_tasks.size() << " n_nodes " << result->nodes << " time " << result->time << " NPS " << result->nps << std::endl;
+            std::cerr << "depth " << result->depth << "@" << SELECTIVITY_PERCENTAGE[main_mpc_level] << "%" << " value " << result->value << " (raw " << id_result.first << ") policy " << idx_to_coord(id_result.second) << " n_helper " << lazy_smp.get_n_running() << " n_nodes " << result->nodes << " time " << result->time << " NPS " << result->nps << std::endl;
 #else
             std::cerr << "depth " << result->depth << "@" << SELECTIVITY_PERCENTAGE[main_mpc_level] << "%" << " value " << result->value << " (raw " << id_result.first << ") policy " << idx_to_coord(id_result.second) << " n_nodes " << result->nodes << " time " << result->time << " NPS " << result->nps << std::endl;
 #endif
         }
-        if (is_end_search && main_depth >= depth - IDSEARCH_ENDSEARCH_PRESEARCH_OFFSET) {
-            if (main_depth < depth) {
-                main_depth = depth;
-                if (depth <= 27 && mpc_level >= MPC_88_LEVEL) {
-                    main_mpc_level = MPC_88_LEVEL;
-                } else {
-                    main_mpc_level = MPC_74_LEVEL;
-                }
-            } else{
-                if (main_mpc_level < mpc_level) {
-                    if (
-                        (main_mpc_level >= MPC_74_LEVEL && mpc_level > MPC_74_LEVEL && depth <= 22) || 
-                        (main_mpc_level >= MPC_88_LEVEL && mpc_level > MPC_88_LEVEL && depth <= 25) || 
-                        (main_mpc_level >= MPC_93_LEVEL && mpc_level > MPC_93_LEVEL && depth <= 29) || 
-                        (main_mpc_level >= MPC_98_LEVEL && mpc_level > MPC_98_LEVEL)
-                    ) {
-                        main_mpc_level = mpc_level;
-                    } else{
-                        ++main_mpc_level;
-                    }
+        if (!iterative_deepening_next(is_end_search, depth, mpc_level, &main_depth, &main_mpc_level)) {
+            break;
+        }
+    }
+#if USE_LAZY_SMP
+    lazy_smp.finish();
+    Lazy_SMP_statistics lazy_smp_statistics = lazy_smp.get_statistics();
+    result->nodes = n_main_nodes + lazy_smp_statistics.n_nodes;
+    result->nps = calc_nps(result->nodes, result->time);
+    if (show_log && lazy_smp_statistics.n_tasks) {
+        lazy_smp_statistics.print(n_main_nodes, std::cerr);
+    }
+#endif
+}
+
+/*
+    @brief Multi-PV iterative deepening (fixed depth)
+
+    Each iteration searches all moves once with first_nega_scout_multi_pv,
+    so the n_pv best moves share the alpha bound instead of being searched one by one.
+    With a time limit, depth 1 is always searched and no iteration is started after the time is up
+    or when it is not expected to finish in time.
+
+    @param results              n_pv best moves sorted by value (descending), of the last completed iteration
+    @param time_limit           time limit in msec (TIME_LIMIT_INF: no limit)
+*/
+void iterative_deepening_search_multi_pv(Board board, int alpha, int beta, int depth, uint_fast8_t mpc_level, bool show_log, std::vector<Clog_result> clogs, uint64_t use_legal, bool use_multi_thread, int n_pv, std::vector<Search_result> *results, uint64_t time_limit, bool *searching) {
+    uint64_t strt = tim();
+    results->clear();
+    int main_depth = 1;
+    int main_mpc_level = mpc_level;
+    const int max_depth = HW2 - board.n_discs();
+    depth = std::min(depth, max_depth);
+    bool is_end_search = (depth == max_depth);
+    if (is_end_search) {
+        main_mpc_level = MPC_74_LEVEL;
+    }
+    uint64_t n_nodes = 0;
+    int before_values[HW2];
+    for (int cell = 0; cell < HW2; ++cell) {
+        before_values[cell] = SCORE_UNDEFINED;
+    }
+    while (main_depth <= depth && main_mpc_level <= mpc_level && global_searching && *searching && (time_limit == TIME_LIMIT_INF || tim() - strt < time_limit || main_depth <= 1)) {
+        bool main_is_end_search = false;
+        if (main_depth >= max_depth) {
+            main_is_end_search = true;
+            main_depth = max_depth;
+        }
+        bool is_last_search = (main_depth == depth) && (main_mpc_level == mpc_level);
+        uint64_t iteration_strt = tim();
+        Search main_search(&board, main_mpc_level, use_multi_thread, !is_last_search);
+        std::vector<std::pair<int, int>> pvs = first_nega_scout_multi_pv(&main_search, alpha, beta, main_depth, main_is_end_search, clogs, use_legal, n_pv, strt, searching);
+        n_nodes += main_search.n_nodes;
+        if (*searching) {
+            results->clear();
+            for (const std::pair<int, int> &pv: pvs) {
+                Search_result elem;
+                elem.policy = pv.second;
+                if (before_values[pv.second] != SCORE_UNDEFINED && !main_is_end_search) {
+                    double n_value = (0.9 * before_values[pv.second] + 1.1 * pv.first) / 2.0;
+                    elem.value = round(n_value);
                 } else{
-                    break;
+                    elem.value = pv.first;
                 }
+                before_values[pv.second] = elem.value;
+                elem.depth = main_depth;
+                elem.is_end_search = main_is_end_search;
+                elem.probability = SELECTIVITY_PERCENTAGE[main_mpc_level];
+                results->emplace_back(elem);
             }
-        } else {
-            if (main_depth <= 15 && main_depth < depth - 3) {
-                main_depth += 3;
-            } else{
-                ++main_depth;
+        }
+        if (show_log) {
+            std::cerr << (is_last_search ? "main " : "pre ") << (main_is_end_search ? "end " : "mid ");
+            std::cerr << "depth " << main_depth << "@" << SELECTIVITY_PERCENTAGE[main_mpc_level] << "%";
+            for (const std::pair<int, int> &pv: pvs) {
+                std::cerr << " " << idx_to_coord(pv.second) << ":" << pv.first;
             }
+            std::cerr << " n_nodes " << n_nodes << " time " << tim() - strt << std::endl;
+        }
+        if (time_limit != TIME_LIMIT_INF && tim() - strt + (tim() - iteration_strt) * MULTI_PV_ITERATION_TIME_GROWTH >= time_limit) {
+            break;
+        }
+        if (!iterative_deepening_next(is_end_search, depth, mpc_level, &main_depth, &main_mpc_level)) {
+            break;
         }
     }
+    uint64_t elapsed = tim() - strt;
+    for (Search_result &elem: *results) {
+        elem.nodes = n_nodes;
+        elem.time = elapsed;
+        elem.nps = calc_nps(n_nodes, elapsed);
+    }
 }
 
 void iterative_deepening_search_time_limit(Board board, int alpha, int beta, bool show_log, std::vector<Clog_result> clogs, uint64_t use_legal, bool use_multi_thread, Search_result *result, uint64_t time_limit, bool *searching) {
@@ -226,6 +277,9 @@ void iterative_deepening_search_time_limit(Board board, int alpha, int beta, boo
     }
     int before_raw_value = -100;
     bool policy_changed_before = true;
+#if USE_LAZY_SMP
+    Lazy_SMP lazy_smp(&board, alpha, beta, use_legal);
+#endif
     while (global_searching && (*searching) && ((tim() - strt < time_limit) || main_depth <= 1)) {
         bool main_is_end_search = false;
         if (main_depth >= max_depth) {
@@ -233,6 +287,14 @@ void iterative_deepening_search_time_limit(Board board, int alpha, int beta, boo
             main_depth = max_depth;
         }
         bool main_is_complete_search = main_is_end_search && main_mpc_level == MPC_100_LEVEL;
+#if USE_LAZY_SMP
+        if (use_multi_thread && lazy_smp_schedule.use_time_limit && !main_is_complete_search) {
+            lazy_smp.set_tasks(lazy_smp_get_tasks(main_depth, main_mpc_level, max_depth, thread_pool.size()));
+        } else {
+            lazy_smp.set_tasks(std::vector<Lazy_SMP_task>());
+        }
+        lazy_smp.check_tt(main_depth, main_mpc_level);
+#endif
         if (show_log) {
             if (main_is_end_search) {
                 std::cerr << "end ";
@@ -396,6 +458,15 @@ void iterative_deepening_search_time_limit(Board board, int alpha, int beta, boo
             }
         }
     }
+#if USE_LAZY_SMP
+    lazy_smp.finish();
+    Lazy_SMP_statistics lazy_smp_statistics = lazy_smp.get_statistics();
+    result->nodes += lazy_smp_statistics.n_nodes;
+    result->nps = calc_nps(result->nodes, result->time);
+    if (show_log && lazy_smp_statistics.n_tasks) {
+        lazy_smp_statistics.print(result->nodes - lazy_smp_statistics.n_nodes, std::cerr);
+    }
+#endif
 }
 
 
@@ -418,6 +489,25 @@ inline Search_result tree_search_legal(Board board, int alpha, int beta, int dep
     depth = std::min(HW2 - board.n_discs(), depth);
     bool is_end_search = (HW2 - board.n_discs() == depth);
     bool use_time_limit = (time_limit != TIME_LIMIT_INF);
+#if USE_SOLVED_STORE
+    if ((is_end_search || use_time_limit) && use_legal == board.get_legal() && solved_store.is_open()) {
+        int stored_value, stored_move;
+        if (solved_store.get(&board, &stored_value, &stored_move) && is_valid_policy(stored_move) && (use_legal & (1ULL << stored_move))) {
+            if (show_log) {
+                std::cerr << "solved position store " << idx_to_coord(stored_move) << " value " << stored_value << std::endl;
+            }
+            res.value = stored_value;
+            res.policy = stored_move;
+            res.depth = HW2 - board.n_discs();
+            res.is_end_search = true;
+            res.probability = SELECTIVITY_PERCENTAGE[MPC_100_LEVEL];
+            res.nodes = 0;
+            res.time = 0;
+            res.nps = 0;
+            return res;
+        }
+    }
+#endif
     std::vector<Clog_result> clogs;
     uint64_t clog_nodes = 0;
     uint64_t clog_time = 0;
@@ -438,6 +528,10 @@ inline Search_result tree_search_legal(Board board, int alpha, int beta, int dep
         res.clog_nodes = clog_nodes;
         res.clog_time = clog_time;
     }
+#if USE_YBWC_SPLIT_STATISTICS
+    ybwc_split_statistics_init();
+    uint64_t split_statistics_strt = tim();
+#endif
     if (use_legal) {
         uint64_t time_limit_proc = TIME_LIMIT_INF;
         if (use_time_limit) {
@@ -461,6 +555,17 @@ inline Search_result tree_search_legal(Board board, int alpha, int beta, int dep
             iterative_deepening_search(board, alpha, beta, depth, mpc_level, show_log, clogs, use_legal, use_multi_thread, &res, searching);
         }
     }
+#if USE_YBWC_SPLIT_STATISTICS
+    if (show_log) {
+        ybwc_split_statistics_print(tim() - split_statistics_strt);
+    }
+#endif
+#if USE_SOLVED_STORE
+    if (*searching && global_searching && res.is_end_search && res.probability == SELECTIVITY_PERCENTAGE[MPC_100_LEVEL] && alpha < res.value && res.value < beta && use_legal == board.get_legal() && HW2 - board.n_discs() >= SOLVED_STORE_MIN_DEPTH && solved_store.is_open()) {
+        solved_store.add(&board, res.value, res.policy);
+    }
+    solved_store.flush();
+#endif
     //thread_pool.tell_finish_using();
     //thread_pool.reset_unavailable();
     //delete_tt(&board, 6);
@@ -558,9 +663,15 @@ Search_result ai_common(Board board, int alpha, int beta, int level, bool use_bo
         if (show_log && time_limit == TIME_LIMIT_INF) {
             std::cerr << "level status " << level << " " << board.n_discs() - 4 << " discs depth " << depth << "@" << SELECTIVITY_PERCENTAGE[mpc_level] << "%" << std::endl;
         }
+#if USE_SEARCH_STATISTICS
+        Search_statistics statistics_strt = search_statistics_collect();
+#endif
         //thread_pool.tell_start_using();
         res = tree_search_legal(board, alpha, beta, depth, mpc_level, show_log, use_legal, use_multi_thread, time_limit, searching);
         //thread_pool.tell_finish_using();
+#if USE_SEARCH_STATISTICS
+        search_statistics_finish(statistics_strt, show_log);
+#endif
         res.level = level;
         res.value *= value_sign;
         if (is_valid_policy(book_result.policy) && use_book) { // check book
@@ -770,7 +881,11 @@ Search_result ai_time_limit(Board board, bool use_book, int book_acc_level, bool
         }
     }
     bool searching = true;
-    return ai_common(board, -SCORE_MAX, SCORE_MAX, MAX_LEVEL, use_book, book_acc_level, use_multi_thread, show_log, board.get_legal(), false, time_limit, &searching);
+    Search_result res = ai_common(board, -SCORE_MAX, SCORE_MAX, MAX_LEVEL, use_book, book_acc_level, use_multi_thread, show_log, board.get_legal(), false, time_limit, &searching);
+    if (time_calibration.update(n_empties, res)) {
+        time_calibration.save_if_updated(TIME_CALIBRATION_SAVE_INTERVAL);
+    }
+    return res;
 }
 
 /*
@@ -845,6 +960,64 @@ Search_result ai_accept_loss(Board board, int level, int acceptable_loss) {
     return res;
 }
 
+/*
+    @brief Get n_pv best moves by a multi-PV search
+
+    Book is not used. Values are exact within the window of each move.
+
+    @param board                board to solve
+    @param level                level of AI (ignored if time_limit is given)
+    @param alpha                alpha value
+    @param beta                 beta value
+    @param n_pv                 number of best moves
+    @param use_multi_thread     search in multi thread?
+    @param show_log             show log?
+    @param use_legal            moves to search
+    @param time_limit           time limit in msec (TIME_LIMIT_INF: search till the level)
+                                no iteration is started after the time is up, the last completed one is returned
+    @return n_pv best moves sorted by value (descending)
+*/
+std::vector<Search_result> ai_multi_pv(Board board, int level, int alpha, int beta, int n_pv, bool use_multi_thread, bool show_log, uint64_t use_legal, uint64_t time_limit, bool *searching) {
+    std::vector<Search_result> res;
+    use_legal &= board.get_legal();
+    n_pv = std::min(n_pv, pop_count_ull(use_legal));
+    if (n_pv <= 0) {
+        return res;
+    }
+    uint64_t strt = tim();
+    if (time_limit != TIME_LIMIT_INF) {
+        level = MAX_LEVEL;
+    }
+    int depth;
+    bool is_mid_search;
+    uint_fast8_t mpc_level;
+    get_level(level, board.n_discs() - 4, &is_mid_search, &depth, &mpc_level);
+    depth = std::min(HW2 - board.n_discs(), depth);
+    std::vector<Clog_result> clogs;
+    uint64_t clog_nodes = 0;
+    uint64_t clog_time = 0;
+    if (mpc_level != MPC_100_LEVEL) {
+        clogs = first_clog_search(board, &clog_nodes, std::min(depth, CLOG_SEARCH_MAX_DEPTH), use_legal, searching);
+        clog_time = tim() - strt;
+    }
+    uint64_t time_limit_proc = time_limit;
+    if (time_limit != TIME_LIMIT_INF) {
+        uint64_t elapsed = tim() - strt;
+        time_limit_proc = time_limit > elapsed ? time_limit - elapsed : 1;
+    }
+    iterative_deepening_search_multi_pv(board, alpha, beta, depth, mpc_level, show_log, clogs, use_legal, use_multi_thread, n_pv, &res, time_limit_proc, searching);
+    for (Search_result &elem: res) {
+        elem.level = level;
+        elem.clog_nodes = clog_nodes;
+        elem.clog_time = clog_time;
+    }
+    return res;
+}
+
+std::vector<Search_result> ai_multi_pv(Board board, int level, int n_pv, bool use_multi_thread, bool show_log, uint64_t use_legal, bool *searching) {
+    return ai_multi_pv(board, level, -SCORE_MAX, SCORE_MAX, n_pv, use_multi_thread, show_log, use_legal, TIME_LIMIT_INF, searching);
+}
+
 void ai_hint(Board board, int level, bool use_book, int book_acc_level, bool use_multi_thread, bool show_log, int n_display, double values[], int hint_types[]) {
     uint64_t legal = board.get_legal();
     if (use_book) {
@@ -861,17 +1034,17 @@ void ai_hint(Board board, int level, bool use_book, int book_acc_level, bool use
         //if (show_log) {
         //    std::cerr << "hint level " << search_level << " calculating" << std::endl;
         //}
-        uint64_t search_legal = legal;
-        for (int i = 0; i < n_display && search_legal && global_searching; ++i) {
-            Search_result elem = ai_legal(board, search_level, use_book, book_acc_level, use_multi_thread, false, search_legal);
-            if (global_searching && (search_legal & (1ULL << elem.policy))) {
-                search_legal ^= 1ULL << elem.policy;
-                values[elem.policy] = elem.value;
-                if (elem.is_end_search) {
-                    hint_types[elem.policy] = elem.probability;
-                } else{
-                    hint_types[elem.policy] = search_level;
-                }
+        bool searching = true;
+        std::vector<Search_result> elems = ai_multi_pv(board, search_level, n_display, use_multi_thread, false, legal, &searching);
+        for (const Search_result &elem: elems) {
+            if (!global_searching) {
+                break;
+            }
+            values[elem.policy] = elem.value;
+            if (elem.is_end_search) {
+                hint_types[elem.policy] = elem.probability;
+            } else{
+                hint_types[elem.policy] = search_level;
             }
         }
     }
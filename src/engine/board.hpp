@@ -16,9 +16,7 @@
 #include "last_flip.hpp"
 #include "hash.hpp"
 
-#if USE_SIMD
 uint32_t global_hash_bit_mask = (1U << DEFAULT_HASH_LEVEL) - 1;
-#endif
 
 /*
     @brief Board class
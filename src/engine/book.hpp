@@ -13,10 +13,14 @@
 #include <fstream>
 #include <unordered_map>
 #include <unordered_set>
+#include <atomic>
+#include <mutex>
+#include <filesystem>
 #include "evaluate.hpp"
 #include "board.hpp"
 #include "search.hpp"
 #include "ai.hpp"
+#include "book_mmap.hpp"
 
 inline Search_result tree_search(Board board, int depth, uint_fast8_t mpc_level, bool show_log, bool use_multi_thread);
 Search_result ai(Board board, int level, bool use_book, int book_acc_level, bool use_multi_thread, bool show_log);
@@ -24,6 +28,7 @@ Search_result ai_legal(Board board, int level, bool use_book, int book_acc_level
 void search_new_leaf(Board board, int level, int book_elem_value, bool use_multi_thread);
 
 #define FORCE_BOOK_DEPTH false
+#define USE_PARALLEL_BOOK_NEGAMAX true
 
 constexpr int BOOK_N_ACCEPT_LEVEL = 11;
 constexpr int BOOK_ACCURACY_LEVEL_INF = 10;
@@ -41,6 +46,22 @@ constexpr int ADD_LEAF_SPECIAL_LEVEL = -1;
 
 constexpr uint64_t MAX_N_LINES = 4000000000; // < 2^32
 
+constexpr int BOOK_NEGAMAX_N_CHUNKS_PER_THREAD = 8;
+
+/*
+    @brief journal of a book file
+
+    <book file>.journal holds boards changed after <book file> was saved.
+    header: "EGBKJRNL", version (1 byte), size (8 bytes) and write time (8 bytes) of the book file
+    record: operation (1 byte) and the same 25 bytes as a board in egbk3
+*/
+#define BOOK_JOURNAL_EXTENSION ".journal"
+constexpr int BOOK_JOURNAL_VERSION = 1;
+constexpr int BOOK_JOURNAL_RECORD_SIZE = 26;
+constexpr double BOOK_JOURNAL_MAX_RATIO = 0.25; // save whole book if the journal becomes larger than this ratio of the book file
+#define BOOK_JOURNAL_OP_SET 0
+#define BOOK_JOURNAL_OP_DELETE 1
+
 /*
     @brief book result structure
 
@@ -191,6 +212,243 @@ struct Book_hash {
     }
 };
 
+constexpr uint64_t BOOK_TABLE_EMPTY = 0xFFFFFFFFFFFFFFFFULL; // player & opponent != 0 never appears in book
+constexpr size_t BOOK_TABLE_MIN_CAPACITY = 16;
+
+/*
+    @brief element of book table
+
+    @param first                board (key)
+    @param second               book element
+*/
+struct Book_table_entry {
+    Board first;
+    Book_elem second;
+};
+
+/*
+    @brief open-addressing hash table for book
+
+    linear probing with backward-shift deletion (no tombstones)
+    capacity is not restricted to powers of 2 so that reserve() can fit the book size
+    keeps the subset of std::unordered_map API used by Book
+    inserting may move elements, so do not keep references across insertions
+*/
+class Book_table {
+    private:
+        Book_table_entry *table;
+        size_t capacity;
+        size_t n_elems;
+
+    public:
+        class iterator {
+            private:
+                Book_table_entry *ptr;
+                Book_table_entry *last;
+
+                inline void skip_empty() {
+                    while (ptr != last && is_empty(ptr)) {
+                        ++ptr;
+                    }
+                }
+
+            public:
+                iterator(Book_table_entry *p, Book_table_entry *l)
+                    : ptr(p), last(l) {
+                    skip_empty();
+                }
+
+                inline Book_table_entry& operator*() const {
+                    return *ptr;
+                }
+
+                inline Book_table_entry* operator->() const {
+                    return ptr;
+                }
+
+                inline iterator& operator++() {
+                    ++ptr;
+                    skip_empty();
+                    return *this;
+                }
+
+                inline bool operator==(const iterator &other) const {
+                    return ptr == other.ptr;
+                }
+
+                inline bool operator!=(const iterator &other) const {
+                    return ptr != other.ptr;
+                }
+        };
+
+        Book_table()
+            : table(nullptr), capacity(0), n_elems(0) {}
+
+        ~Book_table() {
+            free(table);
+        }
+
+        Book_table(const Book_table&) = delete;
+        Book_table& operator=(const Book_table&) = delete;
+
+        inline iterator begin() {
+            return iterator(table, table + capacity);
+        }
+
+        inline iterator end() {
+            return iterator(table + capacity, table + capacity);
+        }
+
+        inline size_t size() const {
+            return n_elems;
+        }
+
+        /*
+            @brief memory used by this table
+
+            @return bytes
+        */
+        inline size_t memory_usage() const {
+            return capacity * sizeof(Book_table_entry);
+        }
+
+        inline void clear() {
+            free(table);
+            table = nullptr;
+            capacity = 0;
+            n_elems = 0;
+        }
+
+        /*
+            @brief reserve space for n elements
+        */
+        inline void reserve(size_t n) {
+            size_t new_capacity = std::max(BOOK_TABLE_MIN_CAPACITY, n + n / 4); // load factor 0.8
+            if (new_capacity > capacity) {
+                rehash(new_capacity);
+            }
+        }
+
+        inline iterator find(const Board &b) {
+            size_t idx = find_idx(b);
+            if (idx == capacity) {
+                return end();
+            }
+            return iterator(table + idx, table + capacity);
+        }
+
+        /*
+            @brief get element (insert default element if not found)
+        */
+        inline Book_elem& operator[](const Board &b) {
+            size_t idx = find_idx(b);
+            if (idx != capacity) {
+                return table[idx].second;
+            }
+            if ((n_elems + 1) * 8 > capacity * 7) { // load factor 0.875
+                rehash(std::max(BOOK_TABLE_MIN_CAPACITY, capacity * 2));
+            }
+            idx = home_idx(b);
+            while (!is_empty(table + idx)) {
+                idx = next_idx(idx);
+            }
+            table[idx].first = b;
+            table[idx].second = Book_elem();
+            ++n_elems;
+            return table[idx].second;
+        }
+
+        /*
+            @brief erase element
+
+            @return number of erased elements
+        */
+        inline size_t erase(const Board &b) {
+            size_t idx = find_idx(b);
+            if (idx == capacity) {
+                return 0;
+            }
+            size_t hole = idx;
+            size_t j = idx;
+            while (true) {
+                j = next_idx(j);
+                if (is_empty(table + j)) {
+                    break;
+                }
+                // move j to hole if its home is not in (hole, j]
+                if (distance(home_idx(table[j].first), j) >= distance(hole, j)) {
+                    table[hole] = table[j];
+                    hole = j;
+                }
+            }
+            set_empty(table + hole);
+            --n_elems;
+            return 1;
+        }
+
+    private:
+        static inline bool is_empty(const Book_table_entry *entry) {
+            return entry->first.player == BOOK_TABLE_EMPTY && entry->first.opponent == BOOK_TABLE_EMPTY;
+        }
+
+        static inline void set_empty(Book_table_entry *entry) {
+            entry->first.player = BOOK_TABLE_EMPTY;
+            entry->first.opponent = BOOK_TABLE_EMPTY;
+        }
+
+        inline size_t home_idx(const Board &b) const {
+            return Book_hash()(b) % capacity;
+        }
+
+        inline size_t next_idx(size_t idx) const {
+            ++idx;
+            return idx == capacity ? 0 : idx;
+        }
+
+        inline size_t distance(size_t from, size_t to) const {
+            return to >= from ? to - from : to + capacity - from;
+        }
+
+        inline size_t find_idx(const Board &b) const {
+            if (n_elems == 0) {
+                return capacity;
+            }
+            size_t idx = home_idx(b);
+            while (!is_empty(table + idx)) {
+                if (table[idx].first.player == b.player && table[idx].first.opponent == b.opponent) {
+                    return idx;
+                }
+                idx = next_idx(idx);
+            }
+            return capacity;
+        }
+
+        void rehash(size_t new_capacity) {
+            Book_table_entry *new_table = (Book_table_entry*)malloc(sizeof(Book_table_entry) * new_capacity);
+            if (new_table == nullptr) {
+                std::cerr << "[ERROR] book table allocation failed" << std::endl;
+                std::exit(1);
+            }
+            for (size_t i = 0; i < new_capacity; ++i) {
+                set_empty(new_table + i);
+            }
+            Book_table_entry *old_table = table;
+            size_t old_capacity = capacity;
+            table = new_table;
+            capacity = new_capacity;
+            for (size_t i = 0; i < old_capacity; ++i) {
+                if (!is_empty(old_table + i)) {
+                    size_t idx = home_idx(old_table[i].first);
+                    while (!is_empty(table + idx)) {
+                        idx = next_idx(idx);
+                    }
+                    table[idx] = old_table[i];
+                }
+            }
+            free(old_table);
+        }
+};
+
 
 
 
@@ -204,7 +462,13 @@ struct Book_hash {
 class Book {
     private:
         std::mutex mtx;
-        std::unordered_map<Board, Book_elem, Book_hash> book;
+        Book_table book_table; // in-memory book, accessed through table()
+        Book_mmap mapped_book; // read-only, used while the book is not modified
+        std::atomic<bool> use_mapped{false}; // mapped_book is the content of this book
+        std::mutex mapped_mtx; // for copying mapped_book into book_table
+        std::unordered_set<Board, Book_hash> journal_changed; // representative boards changed after the last save
+        bool journal_full = true; // changes are not tracked per board, next checkpoint saves whole book
+        std::string journal_base_file; // book file that the journal continues
 
     public:
         /*
@@ -215,13 +479,17 @@ class Book {
         */
         bool init(std::string file, bool show_log, bool *stop_loading) {
             delete_all();
-            if (!import_file_egbk3(file, show_log, stop_loading)) { // try egbk3 format
+            if (!open_mapped(file, show_log) && !import_file_egbk3(file, show_log, stop_loading)) { // try memory-mapped format, then egbk3 format
                 std::cerr << "failed egbk3 formatted book. trying egbk2 format." << std::endl;
                 if (!import_file_egbk2(file, show_log, stop_loading)) { // try egbk2 format
                     std::cerr << "failed egbk2 formatted book. trying egbk format." << std::endl;
                     return import_file_egbk(file, 1, show_log, stop_loading); // try egbk format
                 }
+                return true;
             }
+            journal_changed.clear();
+            journal_full = !replay_journal(file, show_log); // on a memory-mapped book, the journal is replayed into its in-memory copy
+            journal_base_file = file;
             return true;
         }
 
@@ -245,6 +513,9 @@ class Book {
             if (lst[lst.size() - 1] == "egbk2") {
                 std::cerr << "importing Egaroucid legacy book (.egbk2)" << std::endl;
                 result = import_file_egbk2(file, true, stop);
+            } else if (lst[lst.size() - 1] == BOOK_MMAP_EXTENSION_NODOT) {
+                std::cerr << "importing Egaroucid memory-mapped book (" << BOOK_MMAP_EXTENSION << ")" << std::endl;
+                result = import_file_egbkm(file, true, stop);
             } else if (lst[lst.size() - 1] == "egbk") {
                 std::cerr << "importing Egaroucid legacy book (.egbk)" << std::endl;
                 result = import_file_egbk(file, level, true, stop);
@@ -323,6 +594,7 @@ class Book {
             if (show_log) {
                 std::cerr << n_boards << " boards to read" << std::endl;
             }
+            table().reserve(table().size() + n_boards);
             // for each board
             int percent = -1;
             char datum[25];
@@ -337,7 +609,7 @@ class Book {
                 }
                 // read board, player
                 if (fread(datum, 1, 25, fp) < 25) {
-                    std::cerr << "[ERROR] book NOT FULLY imported " << book.size() << " boards" << std::endl;
+                    std::cerr << "[ERROR] book NOT FULLY imported " << table().size() << " boards" << std::endl;
                     fclose(fp);
                     return false;
                 }
@@ -351,56 +623,56 @@ class Book {
                 leaf_level = datum[24];
                 /*
                 if (fread(&p, 8, 1, fp) < 1) {
-                    std::cerr << "[ERROR] book NOT FULLY imported 0 " << book.size() << " boards" << std::endl;
+                    std::cerr << "[ERROR] book NOT FULLY imported 0 " << table().size() << " boards" << std::endl;
                     fclose(fp);
                     return false;
                 }
                 // read board, opponent
                 if (fread(&o, 8, 1, fp) < 1) {
-                    std::cerr << "[ERROR] book NOT FULLY imported 1 " << book.size() << " boards" << std::endl;
+                    std::cerr << "[ERROR] book NOT FULLY imported 1 " << table().size() << " boards" << std::endl;
                     fclose(fp);
                     return false;
                 }
                 // read value
                 if (fread(&value, 1, 1, fp) < 1) {
-                    std::cerr << "[ERROR] book NOT FULLY imported 3 " << book.size() << " boards" << std::endl;
+                    std::cerr << "[ERROR] book NOT FULLY imported 3 " << table().size() << " boards" << std::endl;
                     fclose(fp);
                     return false;
                 }
                 // read level
                 if (fread(&level, 1, 1, fp) < 1) {
-                    std::cerr << "[ERROR] book NOT FULLY imported 3 " << book.size() << " boards" << std::endl;
+                    std::cerr << "[ERROR] book NOT FULLY imported 3 " << table().size() << " boards" << std::endl;
                     fclose(fp);
                     return false;
                 }
                 //if (value < -HW2 || HW2 < value) {
-                //    std::cerr << "[ERROR] book NOT FULLY imported 4 got value " << (int)value << " " << book.size() << " boards" << std::endl;
+                //    std::cerr << "[ERROR] book NOT FULLY imported 4 got value " << (int)value << " " << table().size() << " boards" << std::endl;
                 //    fclose(fp);
                 //    return false;
-                //    //std::cerr << "[WARNING] value error found " << (int)value << " " << book.size() << " boards" << std::endl;
+                //    //std::cerr << "[WARNING] value error found " << (int)value << " " << table().size() << " boards" << std::endl;
                 //    //value = SCORE_UNDEFINED;
                 //}
                 // read n_lines
                 if (fread(&n_lines, 4, 1, fp) < 1) {
-                    std::cerr << "[ERROR] book NOT FULLY imported 5 " << book.size() << " boards" << std::endl;
+                    std::cerr << "[ERROR] book NOT FULLY imported 5 " << table().size() << " boards" << std::endl;
                     fclose(fp);
                     return false;
                 }
                 // read leaf value
                 if (fread(&leaf_value, 1, 1, fp) < 1) {
-                    std::cerr << "[ERROR] book NOT FULLY imported 6 " << book.size() << " boards" << std::endl;
+                    std::cerr << "[ERROR] book NOT FULLY imported 6 " << table().size() << " boards" << std::endl;
                     fclose(fp);
                     return false;
                 }
                 // read leaf move
                 if (fread(&leaf_move, 1, 1, fp) < 1) {
-                    std::cerr << "[ERROR] book NOT FULLY imported 7 " << book.size() << " boards" << std::endl;
+                    std::cerr << "[ERROR] book NOT FULLY imported 7 " << table().size() << " boards" << std::endl;
                     fclose(fp);
                     return false;
                 }
                 // read leaf level
                 if (fread(&leaf_level, 1, 1, fp) < 1) {
-                    std::cerr << "[ERROR] book NOT FULLY imported 3 " << book.size() << " boards" << std::endl;
+                    std::cerr << "[ERROR] book NOT FULLY imported 3 " << table().size() << " boards" << std::endl;
                     fclose(fp);
                     return false;
                 }
@@ -434,7 +706,8 @@ class Book {
                 return false;
             }
             if (show_log) {
-                std::cerr << "imported " << book.size() << " boards to book" << std::endl;
+                std::cerr << "imported " << table().size() << " boards to book" << std::endl;
+                std::cerr << "book table " << table().memory_usage() << " bytes (" << (double)table().memory_usage() / table().size() << " bytes per board)" << std::endl;
             }
             fclose(fp);
             return true;
@@ -445,6 +718,53 @@ class Book {
             return import_file_egbk3(file, show_log, &stop_loading);
         }
 
+        /*
+            @brief use memory-mapped book as this book without parsing
+
+            @param file                 book file (.egbkm file)
+            @return book opened?
+        */
+        inline bool open_mapped(std::string file, bool show_log) {
+            use_mapped.store(false);
+            if (!mapped_book.open(file, show_log)) {
+                return false;
+            }
+            table().clear();
+            use_mapped.store(true, std::memory_order_release);
+            if (show_log) {
+                std::cerr << "using memory-mapped book " << mapped_book.size() << " boards" << std::endl;
+            }
+            return true;
+        }
+
+        /*
+            @brief import memory-mapped book into this book
+
+            @param file                 book file (.egbkm file)
+            @return book completely imported?
+        */
+        inline bool import_file_egbkm(std::string file, bool show_log, bool *stop_loading) {
+            Book_mmap src;
+            if (!src.open(file, show_log)) {
+                std::cerr << "[ERROR] can't open Egaroucid memory-mapped book " << file << std::endl;
+                return false;
+            }
+            Board board;
+            for (const Book_mmap_record *itr = src.begin(); itr != src.end(); ++itr) {
+                if (*stop_loading) {
+                    std::cerr << "stop loading book" << std::endl;
+                    return false;
+                }
+                board.player = itr->player;
+                board.opponent = itr->opponent;
+                merge(board, record_to_book_elem(itr));
+            }
+            if (show_log) {
+                std::cerr << "imported " << table().size() << " boards to book" << std::endl;
+            }
+            return true;
+        }
+
         /*
             @brief import Egaroucid-formatted book (old)
 
@@ -494,7 +814,7 @@ class Book {
             }
             // Book Information
             if (fread(&n_boards, 4, 1, fp) < 1) {
-                std::cerr << "[ERROR] book NOT FULLY imported " << book.size() << " boards" << std::endl;
+                std::cerr << "[ERROR] book NOT FULLY imported " << table().size() << " boards" << std::endl;
                 fclose(fp);
                 return false;
             }
@@ -514,36 +834,36 @@ class Book {
                 }
                 // read board player
                 if (fread(&p, 8, 1, fp) < 1) {
-                    std::cerr << "[ERROR] book NOT FULLY imported " << book.size() << " boards" << std::endl;
+                    std::cerr << "[ERROR] book NOT FULLY imported " << table().size() << " boards" << std::endl;
                     fclose(fp);
                     return false;
                 }
                 // read board opponent
                 if (fread(&o, 8, 1, fp) < 1) {
-                    std::cerr << "[ERROR] book NOT FULLY imported " << book.size() << " boards" << std::endl;
+                    std::cerr << "[ERROR] book NOT FULLY imported " << table().size() << " boards" << std::endl;
                     fclose(fp);
                     return false;
                 }
                 // read value
                 if (fread(&value, 1, 1, fp) < 1) {
-                    std::cerr << "[ERROR] book NOT FULLY imported " << book.size() << " boards" << std::endl;
+                    std::cerr << "[ERROR] book NOT FULLY imported " << table().size() << " boards" << std::endl;
                     fclose(fp);
                     return false;
                 }
                 if (value < -HW2 || HW2 < value) {
-                    std::cerr << "[ERROR] book NOT FULLY imported got value " << (int)value << " " << book.size() << " boards" << std::endl;
+                    std::cerr << "[ERROR] book NOT FULLY imported got value " << (int)value << " " << table().size() << " boards" << std::endl;
                     fclose(fp);
                     return false;
                 }
                 // read level
                 if (fread(&level, 1, 1, fp) < 1) {
-                    std::cerr << "[ERROR] book NOT FULLY imported " << book.size() << " boards" << std::endl;
+                    std::cerr << "[ERROR] book NOT FULLY imported " << table().size() << " boards" << std::endl;
                     fclose(fp);
                     return false;
                 }
                 // read n_links
                 if (fread(&n_moves, 1, 1, fp) < 1) {
-                    std::cerr << "[ERROR] book NOT FULLY imported " << book.size() << " boards" << std::endl;
+                    std::cerr << "[ERROR] book NOT FULLY imported " << table().size() << " boards" << std::endl;
                     fclose(fp);
                     return false;
                 }
@@ -551,13 +871,13 @@ class Book {
                 for (uint8_t i = 0; i < n_moves; ++i) {
                     // read value
                     if (fread(&val, 1, 1, fp) < 1) {
-                        std::cerr << "[ERROR] book NOT FULLY imported " << book.size() << " boards" << std::endl;
+                        std::cerr << "[ERROR] book NOT FULLY imported " << table().size() << " boards" << std::endl;
                         fclose(fp);
                         return false;
                     }
                     // read move
                     if (fread(&mov, 1, 1, fp) < 1) {
-                        std::cerr << "[ERROR] book NOT FULLY imported " << book.size() << " boards" << std::endl;
+                        std::cerr << "[ERROR] book NOT FULLY imported " << table().size() << " boards" << std::endl;
                         fclose(fp);
                         return false;
                     }
@@ -586,7 +906,7 @@ class Book {
             //     return false;
             // }
             if (show_log)
-                std::cerr << "imported " << book.size() << " boards to book" << std::endl;
+                std::cerr << "imported " << table().size() << " boards to book" << std::endl;
             fclose(fp);
             return true;
         }
@@ -620,7 +940,7 @@ class Book {
             uint8_t value_raw;
             // Book Information
             if (fread(&n_boards, 4, 1, fp) < 1) {
-                std::cerr << "[ERROR] book NOT FULLY imported " << book.size() << " boards" << std::endl;
+                std::cerr << "[ERROR] book NOT FULLY imported " << table().size() << " boards" << std::endl;
                 fclose(fp);
                 return false;
             }
@@ -640,25 +960,25 @@ class Book {
                 }
                 // read board player
                 if (fread(&p, 8, 1, fp) < 1) {
-                    std::cerr << "[ERROR] book NOT FULLY imported " << book.size() << " boards" << std::endl;
+                    std::cerr << "[ERROR] book NOT FULLY imported " << table().size() << " boards" << std::endl;
                     fclose(fp);
                     return false;
                 }
                 // read board opponent
                 if (fread(&o, 8, 1, fp) < 1) {
-                    std::cerr << "[ERROR] book NOT FULLY imported " << book.size() << " boards" << std::endl;
+                    std::cerr << "[ERROR] book NOT FULLY imported " << table().size() << " boards" << std::endl;
                     fclose(fp);
                     return false;
                 }
                 // read value
                 if (fread(&value_raw, 1, 1, fp) < 1) {
-                    std::cerr << "[ERROR] book NOT FULLY imported " << book.size() << " boards" << std::endl;
+                    std::cerr << "[ERROR] book NOT FULLY imported " << table().size() << " boards" << std::endl;
                     fclose(fp);
                     return false;
                 }
                 value = -((int8_t)value_raw - HW2);
                 if (value < -HW2 || HW2 < value) {
-                    std::cerr << "[ERROR] book NOT FULLY imported got value " << (int)value << " " << book.size() << " boards" << std::endl;
+                    std::cerr << "[ERROR] book NOT FULLY imported got value " << (int)value << " " << table().size() << " boards" << std::endl;
                     fclose(fp);
                     return false;
                 }
@@ -689,7 +1009,7 @@ class Book {
             //     return false;
             // }
             if (show_log) {
-                std::cerr << "imported " << book.size() << " boards to book" << std::endl;
+                std::cerr << "imported " << table().size() << " boards to book" << std::endl;
             }
             fclose(fp);
             return true;
@@ -784,10 +1104,10 @@ class Book {
                     return false;
                 }
                 if (value < -HW2 || HW2 < value) {
-                    //std::cerr << "[ERROR] book NOT FULLY imported got value " << (int)value << " " << book.size() << " boards" << std::endl;
+                    //std::cerr << "[ERROR] book NOT FULLY imported got value " << (int)value << " " << table().size() << " boards" << std::endl;
                     //fclose(fp);
                     //return false;
-                    //std::cerr << "[WARNING] value error found " << (int)value << " " << book.size() << " boards" << std::endl;
+                    //std::cerr << "[WARNING] value error found " << (int)value << " " << table().size() << " boards" << std::endl;
                     value = SCORE_UNDEFINED;
                 }
                 // read additional data
@@ -852,7 +1172,7 @@ class Book {
                 }
             }
             if (show_log) {
-                std::cerr << "imported " << book.size() << " boards to book" << std::endl;
+                std::cerr << "imported " << table().size() << " boards to book" << std::endl;
             }
             return true;
         }
@@ -882,10 +1202,10 @@ class Book {
             fout.write((char*)&egaroucid_str, 9);
             char book_version = 3;
             fout.write((char*)&book_version, 1);
-            int n_book = (int)book.size();
+            int n_book = (int)table().size();
             fout.write((char*)&n_book, 4);
-            int t = 0, percent = -1, n_boards = (int)book.size();
-            for (auto itr = book.begin(); itr != book.end(); ++itr) {
+            int t = 0, percent = -1, n_boards = (int)table().size();
+            for (auto itr = table().begin(); itr != table().end(); ++itr) {
                 ++t;
                 int n_percent = (double)t / n_boards * 100;
                 if (n_percent > percent) {
@@ -907,8 +1227,190 @@ class Book {
                 fout.write((char*)&char_leaf_level, 1);
             }
             fout.close();
-            int book_size = (int)book.size();
+            int book_size = (int)table().size();
             std::cerr << "saved " << t << " boards , book_size " << book_size << std::endl;
+            // the journal continues the old file
+            std::error_code ec;
+            if (use_backup) {
+                std::filesystem::remove(journal_file(bak_file), ec);
+                std::filesystem::rename(journal_file(file), journal_file(bak_file), ec);
+            } else {
+                std::filesystem::remove(journal_file(file), ec);
+            }
+            journal_changed.clear();
+            journal_full = level != LEVEL_UNDEFINED; // levels overwritten, not the same as this book
+            journal_base_file = file;
+        }
+
+        /*
+            @brief save changes after the last save
+
+            Changed boards are appended to the journal of the book file, so the cost is proportional to the changes.
+            Whole book is saved instead (it also compacts the journal) if
+                changes are not tracked per board (after negamax etc.),
+                the book was loaded from or saved to another file,
+                or the journal becomes larger than BOOK_JOURNAL_MAX_RATIO of the book file.
+
+            @param file                 book file (.egbk3)
+            @param bak_file             backup file name used if whole book is saved
+        */
+        inline void checkpoint(std::string file, std::string bak_file) {
+            bool save_all = journal_full || journal_base_file != file;
+            if (!save_all) {
+                std::error_code ec;
+                uint64_t book_file_size = std::filesystem::file_size(file, ec);
+                uint64_t journal_size = std::filesystem::file_size(journal_file(file), ec);
+                if (ec) {
+                    journal_size = 0;
+                }
+                journal_size += (uint64_t)journal_changed.size() * BOOK_JOURNAL_RECORD_SIZE;
+                save_all = journal_size > book_file_size * BOOK_JOURNAL_MAX_RATIO;
+            }
+            if (save_all || !append_journal(file)) {
+                save_egbk3(file, bak_file);
+            }
+        }
+
+        /*
+            @brief journal file name of a book file
+        */
+        inline std::string journal_file(std::string file) {
+            return file + BOOK_JOURNAL_EXTENSION;
+        }
+
+        /*
+            @brief size and write time of the book file that the journal continues
+
+            @param file                 book file
+            @param size                 file size
+            @param time                 last write time
+            @return file found?
+        */
+        inline bool journal_base_info(std::string file, uint64_t *size, int64_t *time) {
+            std::error_code ec;
+            *size = std::filesystem::file_size(file, ec);
+            if (ec) {
+                return false;
+            }
+            *time = (int64_t)std::filesystem::last_write_time(file, ec).time_since_epoch().count();
+            return !ec;
+        }
+
+        /*
+            @brief append changed boards to the journal
+
+            @param file                 book file
+            @return appended?
+        */
+        inline bool append_journal(std::string file) {
+            std::string jfile = journal_file(file);
+            bool exists = std::filesystem::exists(jfile);
+            uint64_t base_size;
+            int64_t base_time;
+            if (!exists && !journal_base_info(file, &base_size, &base_time)) {
+                return false;
+            }
+            std::ofstream fout;
+            fout.open(jfile.c_str(), std::ios::out|std::ios::binary|std::ios::app);
+            if (!fout) {
+                std::cerr << "can't open " << jfile << std::endl;
+                return false;
+            }
+            if (!exists) {
+                char journal_str[] = "EGBKJRNL";
+                fout.write(journal_str, 8);
+                char journal_version = BOOK_JOURNAL_VERSION;
+                fout.write(&journal_version, 1);
+                fout.write((char*)&base_size, 8);
+                fout.write((char*)&base_time, 8);
+            }
+            char datum[BOOK_JOURNAL_RECORD_SIZE];
+            for (const Board &board: journal_changed) {
+                auto itr = table().find(board);
+                Book_elem elem;
+                datum[0] = BOOK_JOURNAL_OP_DELETE;
+                if (itr != table().end()) {
+                    elem = itr->second;
+                    datum[0] = BOOK_JOURNAL_OP_SET;
+                }
+                memcpy(datum + 1, &board.player, 8);
+                memcpy(datum + 9, &board.opponent, 8);
+                datum[17] = elem.value;
+                datum[18] = elem.level;
+                memcpy(datum + 19, &elem.n_lines, 4);
+                datum[23] = elem.leaf.value;
+                datum[24] = elem.leaf.move;
+                datum[25] = elem.leaf.level;
+                fout.write(datum, BOOK_JOURNAL_RECORD_SIZE);
+            }
+            fout.close();
+            if (!fout) {
+                std::cerr << "can't write " << jfile << std::endl;
+                return false;
+            }
+            std::cerr << "saved " << journal_changed.size() << " changed boards to " << jfile << std::endl;
+            journal_changed.clear();
+            return true;
+        }
+
+        /*
+            @brief apply the journal of a book file to this book
+
+            A broken record at the end (interrupted append) is ignored.
+
+            @param file                 book file
+            @param show_log             show log?
+            @return journal can be continued? (false if it was made for another book file)
+        */
+        inline bool replay_journal(std::string file, bool show_log) {
+            std::string jfile = journal_file(file);
+            FILE* fp;
+            if (!std::filesystem::exists(jfile) || !file_open(&fp, jfile.c_str(), "rb")) {
+                return true;
+            }
+            char journal_str[8];
+            char journal_version;
+            uint64_t journal_base_size, base_size;
+            int64_t journal_base_time, base_time;
+            if (
+                fread(journal_str, 1, 8, fp) < 8 || memcmp(journal_str, "EGBKJRNL", 8) != 0 || 
+                fread(&journal_version, 1, 1, fp) < 1 || journal_version != BOOK_JOURNAL_VERSION || 
+                fread(&journal_base_size, 8, 1, fp) < 1 || fread(&journal_base_time, 8, 1, fp) < 1
+            ) {
+                std::cerr << "[ERROR] book journal " << jfile << " broken, ignored" << std::endl;
+                fclose(fp);
+                return false;
+            }
+            if (!journal_base_info(file, &base_size, &base_time) || base_size != journal_base_size || base_time != journal_base_time) {
+                std::cerr << "[ERROR] book journal " << jfile << " is not for " << file << ", ignored" << std::endl;
+                fclose(fp);
+                return false;
+            }
+            char datum[BOOK_JOURNAL_RECORD_SIZE];
+            uint64_t n_records = 0;
+            Board board;
+            Book_elem elem;
+            while (fread(datum, 1, BOOK_JOURNAL_RECORD_SIZE, fp) == BOOK_JOURNAL_RECORD_SIZE) {
+                memcpy(&board.player, datum + 1, 8);
+                memcpy(&board.opponent, datum + 9, 8);
+                if (datum[0] == BOOK_JOURNAL_OP_DELETE) {
+                    table().erase(board);
+                } else {
+                    elem.value = datum[17];
+                    elem.level = datum[18];
+                    memcpy(&elem.n_lines, datum + 19, 4);
+                    elem.leaf.value = datum[23];
+                    elem.leaf.move = datum[24];
+                    elem.leaf.level = datum[25];
+                    table()[board] = elem;
+                }
+                ++n_records;
+            }
+            fclose(fp);
+            if (show_log) {
+                std::cerr << "replayed " << n_records << " boards from " << jfile << " book size " << table().size() << std::endl;
+            }
+            return true;
         }
 
         inline void save_egbk3(std::string file, std::string bak_file) {
@@ -919,13 +1421,77 @@ class Book {
             save_egbk3(file, "", false, level);
         }
 
+        /*
+            @brief save as memory-mapped book (.egbkm)
+
+            @param file                 file name to save
+            @return saved?
+        */
+        inline bool save_egbkm(std::string file) {
+            std::vector<Book_mmap_record> records;
+            if (use_mapped.load(std::memory_order_acquire)) {
+                records.assign(mapped_book.begin(), mapped_book.end());
+            } else {
+                records.reserve(table().size());
+                for (auto itr = table().begin(); itr != table().end(); ++itr) {
+                    Book_mmap_record record = {};
+                    record.player = itr->first.player;
+                    record.opponent = itr->first.opponent;
+                    record.n_lines = itr->second.n_lines;
+                    record.value = itr->second.value;
+                    record.level = itr->second.level;
+                    record.leaf_value = itr->second.leaf.value;
+                    record.leaf_move = itr->second.leaf.move;
+                    record.leaf_level = itr->second.leaf.level;
+                    records.emplace_back(record);
+                }
+            }
+            std::cerr << "saving memory-mapped book..." << std::endl;
+            if (!book_mmap_write(file, records)) {
+                return false;
+            }
+            std::cerr << "saved " << records.size() << " boards as a memory-mapped book" << std::endl;
+            return true;
+        }
+
+        /*
+            @brief check that a memory-mapped book answers the same as this book
+
+            @param file                 memory-mapped book file
+            @return number of mismatched boards (-1 if the file can't be opened)
+        */
+        inline int64_t check_mapped_parity(std::string file) {
+            Book_mmap mapped;
+            if (!mapped.open(file, false)) {
+                std::cerr << "[ERROR] can't open memory-mapped book " << file << std::endl;
+                return -1;
+            }
+            int64_t n_mismatch = 0;
+            if (mapped.size() != table().size()) {
+                std::cerr << "[ERROR] size mismatch book " << table().size() << " mapped " << mapped.size() << std::endl;
+                ++n_mismatch;
+            }
+            for (auto itr = table().begin(); itr != table().end(); ++itr) {
+                const Book_mmap_record *record = mapped.find(itr->first);
+                if (record == nullptr) {
+                    ++n_mismatch;
+                    continue;
+                }
+                Book_elem elem = record_to_book_elem(record);
+                if (elem.value != itr->second.value || elem.level != itr->second.level || elem.n_lines != itr->second.n_lines || elem.leaf.value != itr->second.leaf.value || elem.leaf.move != itr->second.leaf.move || elem.leaf.level != itr->second.leaf.level) {
+                    ++n_mismatch;
+                }
+            }
+            return n_mismatch;
+        }
+
         void get_pass_boards(Board board, std::unordered_set<Board, Book_hash> &pass_boards) {
             board = representative_board(board);
             if (contain_representative(board)) {
-                if (book[board].seen) {
+                if (table()[board].seen) {
                     return;
                 }
-                book[board].seen = true;
+                table()[board].seen = true;
             }
             uint64_t legal = board.get_legal();
             if (legal == 0ULL) {
@@ -994,7 +1560,7 @@ class Book {
             fout.write((char*)&dummy, 1);
             fout.write((char*)&level, 4);
             int n_empties = HW2;
-            for (auto itr = book.begin(); itr != book.end(); ++itr) {
+            for (auto itr = table().begin(); itr != table().end(); ++itr) {
                 n_empties = std::min(n_empties, HW2 + 1 - itr->first.n_discs());
             }
             fout.write((char*)&n_empties, 4);
@@ -1004,7 +1570,7 @@ class Book {
             fout.write((char*)&err_end, 4);
             int verb = 0;
             fout.write((char*)&verb, 4);
-            int n_position = book.size() + pass_boards.size();
+            int n_position = table().size() + pass_boards.size();
             fout.write((char*)&n_position, 4);
             int n_win = 0, n_draw = 0, n_lose = 0;
             uint32_t n_lines;
@@ -1019,7 +1585,7 @@ class Book {
             Board b;
             bool searching = true;
             int percent = -1;
-            int n_boards = (int)book.size();
+            int n_boards = (int)table().size();
             int t = 0;
             for (Board pass_board: pass_boards) {
                 Board passed_board = pass_board.copy();
@@ -1060,7 +1626,7 @@ class Book {
                 fout.write((char*)&leaf_val, 1);
                 fout.write((char*)&leaf_move, 1);
             }
-            for (auto itr = book.begin(); itr != book.end(); ++itr) {
+            for (auto itr = table().begin(); itr != table().end(); ++itr) {
                 book_elem = itr->second;
                 int n_percent = (double)t / n_boards * 100;
                 if (n_percent > percent) {
@@ -1108,7 +1674,7 @@ class Book {
                 fout.write((char*)&leaf_move, 1);
             }
             fout.close();
-            std::cerr << "saved " << t << " boards as a edax-formatted book " << n_position << " " << book.size() << std::endl;
+            std::cerr << "saved " << t << " boards as a edax-formatted book " << n_position << " " << table().size() << std::endl;
         }
 
         /*
@@ -1138,7 +1704,10 @@ class Book {
             @return if contains, true, else false
         */
         inline bool contain_representative(Board b) {
-            return book.find(b) != book.end();
+            if (use_mapped.load(std::memory_order_acquire)) {
+                return mapped_book.find(b) != nullptr;
+            }
+            return table().find(b) != table().end();
         }
 
         /*
@@ -1159,6 +1728,19 @@ class Book {
             return contain_representative(representative_board(b));
         }
 
+        /*
+            @brief check if book has a board with lock
+
+            use while another thread modifies this book
+
+            @param b                    a board to find
+            @return if contains, true, else false
+        */
+        inline bool contain_lock(Board b) {
+            std::lock_guard<std::mutex> lock(mtx);
+            return contain(b);
+        }
+
         /*
             @brief get registered score
 
@@ -1167,10 +1749,18 @@ class Book {
         */
         inline Book_elem get_representative(Board b, int idx) {
             Book_elem res;
-            if (!contain_representative(b)) {
-                return res;
+            if (use_mapped.load(std::memory_order_acquire)) {
+                const Book_mmap_record *record = mapped_book.find(b);
+                if (record == nullptr) {
+                    return res;
+                }
+                res = record_to_book_elem(record);
+            } else {
+                if (!contain_representative(b)) {
+                    return res;
+                }
+                res = table()[b];
             }
-            res = book[b];
             if (is_valid_policy(res.leaf.move)) {
                 res.leaf.move = convert_coord_from_representative_board(res.leaf.move, idx);
             }
@@ -1201,6 +1791,19 @@ class Book {
             return get_representative(representive_board, rotate_idx);
         }
 
+        /*
+            @brief get registered score with all rotation with lock
+
+            use while another thread modifies this book
+
+            @param b                    a board to find
+            @return registered value (if not registered, returns -INF)
+        */
+        inline Book_elem get_lock(Board b) {
+            std::lock_guard<std::mutex> lock(mtx);
+            return get(b);
+        }
+
         /*
             @brief get all best moves
 
@@ -1246,6 +1849,18 @@ class Book {
         */
         inline std::vector<Book_value> get_all_moves_with_value(Board *b) {
             std::lock_guard<std::mutex> lock(mtx);
+            return get_all_moves_with_value_nolock(b);
+        }
+
+        /*
+            @brief get all registered moves with value without lock
+
+            use only while no other thread modifies this book
+
+            @param b                    a board pointer to find
+            @return vector of moves
+        */
+        inline std::vector<Book_value> get_all_moves_with_value_nolock(Board *b) {
             std::vector<Book_value> policies;
             uint64_t legal = b->get_legal();
             Flip flip;
@@ -1414,7 +2029,10 @@ class Book {
             @return number of registered boards
         */
         inline int get_n_book() {
-            return (int)book.size();
+            if (use_mapped.load(std::memory_order_acquire)) {
+                return (int)mapped_book.size();
+            }
+            return (int)table().size();
         }
 
         /*
@@ -1429,14 +2047,16 @@ class Book {
                 if (b.is_end()) { // game over
                     if (contain(b)) {
                         Board bb = representative_board(b);
-                        book[bb].value = value;
-                        book[bb].level = level;
+                        table()[bb].value = value;
+                        table()[bb].level = level;
+                        journal_mark(bb);
                     } else {
                         b.pass();
                         if (contain(b)) {
                             Board bb = representative_board(b);
-                            book[bb].value = -value;
-                            book[bb].level = level;
+                            table()[bb].value = -value;
+                            table()[bb].level = level;
+                            journal_mark(bb);
                         } else {
                             b.pass();
                             Book_elem elem;
@@ -1455,8 +2075,9 @@ class Book {
                     }
                     if (contain(b)) {
                         Board bb = representative_board(b);
-                        book[bb].value = value;
-                        book[bb].level = level;
+                        table()[bb].value = value;
+                        table()[bb].level = level;
+                        journal_mark(bb);
                     } else {
                         Book_elem elem;
                         elem.value = value;
@@ -1489,9 +2110,9 @@ class Book {
         inline void delete_elem(Board b) {
             delete_symmetric_book(b);
             //if (delete_symmetric_book(b)) {
-            //    std::cerr << "deleted book elem " << book.size() << std::endl;
+            //    std::cerr << "deleted book elem " << table().size() << std::endl;
             //} else
-            //    std::cerr << "book elem NOT deleted " << book.size() << std::endl;
+            //    std::cerr << "book elem NOT deleted " << table().size() << std::endl;
         }
 
         /*
@@ -1499,8 +2120,11 @@ class Book {
         */
         inline void delete_all() {
             //std::cerr << "delete book" << std::endl;
-            book.clear();
+            use_mapped.store(false);
+            mapped_book.close();
+            table().clear();
             reg_first_board();
+            journal_mark_all();
         }
 
         /*
@@ -1551,12 +2175,12 @@ class Book {
                 }
             }
             board = representative_board(&board);
-            Book_elem res = book[board];
+            Book_elem res = table()[board];
             if (res.seen) {
                 return res;
             }
             res.seen = true;
-            book[board].seen = true;
+            table()[board].seen = true;
             if (res.value < -HW2 || HW2 < res.value) {
                 //std::cerr << "value error found " << (int)res.value << std::endl;
                 //board.print();
@@ -1566,7 +2190,7 @@ class Book {
                 return stop_res;
             }
             ++(*n_seen);
-            int n_percent = (double)(*n_seen) / book.size() * 100;
+            int n_percent = (double)(*n_seen) / table().size() * 100;
             if (n_percent > (*percent)) {
                 *percent = n_percent;
                 std::cerr << "negamaxing book... " << (*percent) << "%" << " fixed " << (*n_fix) << std::endl;
@@ -1605,11 +2229,22 @@ class Book {
                 }
             }
             res.n_lines = (uint32_t)std::min((uint64_t)MAX_N_LINES, n_lines);
-            book[board] = res;
+            table()[board] = res;
             return res;
         }
 
         void negamax_book(bool edax_compliant, bool *stop) {
+            journal_mark_all(); // values are changed in place
+#if USE_PARALLEL_BOOK_NEGAMAX
+            if (thread_pool.size() > 0) { // layered version lists links twice, so slower on a single thread
+                negamax_book_parallel(edax_compliant, stop);
+                return;
+            }
+#endif
+            negamax_book_serial(edax_compliant, stop);
+        }
+
+        void negamax_book_serial(bool edax_compliant, bool *stop) {
             Board root_board;
             root_board.reset();
             int64_t n_seen = 0, n_fix = 0;
@@ -1617,7 +2252,227 @@ class Book {
             reset_seen();
             negamax_book_p(root_board, &n_seen, &n_fix, &percent, edax_compliant, stop);
             reset_seen();
-            std::cerr << "negamaxed book fixed " << n_fix << " boards seen " << n_seen << " boards size " << book.size() << std::endl;
+            std::cerr << "negamaxed book fixed " << n_fix << " boards seen " << n_seen << " boards size " << table().size() << std::endl;
+        }
+
+        /*
+            @brief negamax book layer by layer in parallel
+
+            Every child has one more disc than its parent, so boards reachable from the root are
+            collected by BFS into layers of the same number of discs, then each layer is negamaxed
+            from the last one to the root. Boards in a layer only read the finished next layer,
+            so they are processed in parallel. Gives the same value and n_lines as negamax_book_p.
+        */
+        void negamax_book_parallel(bool edax_compliant, bool *stop) {
+            Board root_board;
+            root_board.reset();
+            std::vector<std::vector<Board>> layers(HW2 + 1);
+            reset_seen();
+            Board root_node;
+            int root_sign;
+            Book_elem root_terminal;
+            if (negamax_book_resolve(root_board, &root_node, &root_sign, &root_terminal) && contain_representative(root_node)) {
+                table().find(root_node)->second.seen = true;
+                layers[root_node.n_discs()].emplace_back(root_node);
+            }
+            // collect boards
+            int n_chunks = (thread_pool.size() + 1) * BOOK_NEGAMAX_N_CHUNKS_PER_THREAD;
+            uint64_t n_boards = 0;
+            for (int n_discs = 4; n_discs <= HW2 && !(*stop); ++n_discs) {
+                n_boards += layers[n_discs].size();
+                if (layers[n_discs].empty() || n_discs == HW2) {
+                    continue;
+                }
+                std::cerr << "negamaxing book collecting " << n_discs << " discs " << layers[n_discs].size() << " boards" << std::endl;
+                std::vector<std::vector<Board>> children(n_chunks);
+                negamax_book_run_chunks(layers[n_discs].size(), n_chunks, [&](int chunk_idx, size_t s, size_t e) {
+                    negamax_book_collect_children(layers[n_discs], s, e, children[chunk_idx], stop);
+                });
+                for (std::vector<Board> &chunk_children: children) {
+                    for (Board &child: chunk_children) {
+                        Book_elem &elem = table().find(child)->second;
+                        if (!elem.seen) {
+                            elem.seen = true;
+                            layers[n_discs + 1].emplace_back(child);
+                        }
+                    }
+                }
+            }
+            // negamax from the last layer
+            int64_t n_seen = 0, n_fix = 0;
+            uint64_t n_done = 0;
+            int percent = -1;
+            for (int n_discs = HW2; n_discs >= 4 && !(*stop); --n_discs) {
+                if (layers[n_discs].empty()) {
+                    continue;
+                }
+                std::vector<int64_t> chunk_n_seen(n_chunks, 0), chunk_n_fix(n_chunks, 0);
+                negamax_book_run_chunks(layers[n_discs].size(), n_chunks, [&](int chunk_idx, size_t s, size_t e) {
+                    negamax_book_layer(layers[n_discs], s, e, edax_compliant, &chunk_n_seen[chunk_idx], &chunk_n_fix[chunk_idx], stop);
+                });
+                for (int i = 0; i < n_chunks; ++i) {
+                    n_seen += chunk_n_seen[i];
+                    n_fix += chunk_n_fix[i];
+                }
+                n_done += layers[n_discs].size();
+                int n_percent = (double)n_done / n_boards * 100;
+                if (n_percent > percent) {
+                    percent = n_percent;
+                    std::cerr << "negamaxing book... " << percent << "%" << " " << n_discs << " discs fixed " << n_fix << std::endl;
+                }
+            }
+            reset_seen();
+            std::cerr << "negamaxed book fixed " << n_fix << " boards seen " << n_seen << " boards size " << table().size() << std::endl;
+        }
+
+        /*
+            @brief resolve a board as negamax_book_p does before looking up the book
+
+            @param board                board
+            @param node                 representative board to look up (if returns true)
+            @param sign                 -1 if passed else 1 (if returns true)
+            @param terminal_res         result of game over board (if returns false)
+            @return board is not game over?
+        */
+        inline bool negamax_book_resolve(Board board, Board *node, int *sign, Book_elem *terminal_res) {
+            *sign = 1;
+            if (board.get_legal() == 0) {
+                board.pass();
+                if (board.get_legal() == 0) { // game over
+                    if (contain(&board)) {
+                        *terminal_res = get(board);
+                    } else {
+                        board.pass();
+                        if (contain(&board)) {
+                            *terminal_res = get(board);
+                        } else {
+                            terminal_res->value = SCORE_UNDEFINED;
+                            terminal_res->n_lines = 0;
+                        }
+                    }
+                    return false;
+                }
+                *sign = -1;
+            }
+            *node = representative_board(&board);
+            return true;
+        }
+
+        /*
+            @brief split [0, n) into chunks and run them with thread pool
+
+            @param n                    number of elements
+            @param n_chunks             number of chunks
+            @param func                 function(chunk_idx, start, end)
+        */
+        template <typename F>
+        void negamax_book_run_chunks(size_t n, int n_chunks, F func) {
+            std::vector<std::future<void>> tasks;
+            size_t delta = (n + n_chunks - 1) / n_chunks;
+            size_t s = 0;
+            for (int i = 0; i < n_chunks && s < n; ++i) {
+                size_t e = std::min(n, s + delta);
+                bool pushed;
+                tasks.emplace_back(thread_pool.push(&pushed, [&func, i, s, e]() {
+                    func(i, s, e);
+                }));
+                if (!pushed) {
+                    tasks.pop_back();
+                    func(i, s, e);
+                }
+                s = e;
+            }
+            for (std::future<void> &task: tasks) {
+                task.get();
+            }
+        }
+
+        /*
+            @brief list children of boards in a layer (may contain duplicates)
+        */
+        void negamax_book_collect_children(const std::vector<Board> &layer, size_t s, size_t e, std::vector<Board> &children, bool *stop) {
+            Flip flip;
+            Board node;
+            int sign;
+            Book_elem terminal_res;
+            for (size_t i = s; i < e && !(*stop); ++i) {
+                Board board = layer[i];
+                Book_elem elem = table().find(board)->second;
+                if (elem.value < -HW2 || HW2 < elem.value) {
+                    continue;
+                }
+                std::vector<Book_value> links = get_all_moves_with_value_nolock(&board);
+                for (Book_value &link: links) {
+                    calc_flip(&flip, &board, link.policy);
+                    board.move_board(&flip);
+                        if (negamax_book_resolve(board, &node, &sign, &terminal_res) && contain_representative(node)) {
+                            children.emplace_back(node);
+                        }
+                    board.undo_board(&flip);
+                }
+            }
+        }
+
+        /*
+            @brief negamax boards in a layer whose children are already negamaxed
+        */
+        void negamax_book_layer(const std::vector<Board> &layer, size_t s, size_t e, bool edax_compliant, int64_t *n_seen, int64_t *n_fix, bool *stop) {
+            Flip flip;
+            Board node;
+            int sign;
+            Book_elem child_res;
+            for (size_t i = s; i < e && !(*stop); ++i) {
+                Board board = layer[i];
+                Book_elem &res = table().find(board)->second;
+                if (res.value < -HW2 || HW2 < res.value) {
+                    continue;
+                }
+                ++(*n_seen);
+                std::vector<Book_value> links = get_all_moves_with_value_nolock(&board);
+                uint64_t n_lines = 1;
+                int v = -INF;
+                if (edax_compliant) {
+                    v = res.leaf.value;
+                }
+                for (Book_value &link: links) {
+                    calc_flip(&flip, &board, link.policy);
+                    board.move_board(&flip);
+                        if (negamax_book_resolve(board, &node, &sign, &child_res)) {
+                            child_res = negamax_book_layer_result(node);
+                            if (sign == -1 && child_res.value != SCORE_UNDEFINED) {
+                                child_res.value *= -1;
+                            }
+                        }
+                        if (child_res.value != SCORE_UNDEFINED) {
+                            if (v < -child_res.value) { // update parent value
+                                v = -child_res.value;
+                            }
+                            n_lines += child_res.n_lines;
+                        }
+                    board.undo_board(&flip);
+                }
+                if (v != -INF) {
+                    if (v != res.value) {
+                        res.value = v;
+                        ++(*n_fix);
+                    }
+                }
+                res.n_lines = (uint32_t)std::min((uint64_t)MAX_N_LINES, n_lines);
+            }
+        }
+
+        /*
+            @brief negamaxed result of a representative board in the next layer
+        */
+        inline Book_elem negamax_book_layer_result(Board node) {
+            Book_elem res;
+            auto itr = table().find(node);
+            if (itr == table().end() || itr->second.value < -HW2 || HW2 < itr->second.value) {
+                res.value = SCORE_UNDEFINED;
+                res.n_lines = 0;
+                return res;
+            }
+            return itr->second;
         }
 
         void reduce_book_flag_moves(Board board, int max_depth, int max_error_per_move, int remaining_error, uint64_t *n_flags, std::unordered_set<Board, Book_hash> &keep_list, bool *doing) {
@@ -1673,7 +2528,7 @@ class Book {
             keep_list.emplace(unique_board);
             ++(*n_flags);
             if ((*n_flags) % 100 == 0) {
-                std::cerr << "keep " << (*n_flags) << " boards of " << book.size() << std::endl;
+                std::cerr << "keep " << (*n_flags) << " boards of " << table().size() << std::endl;
             }
             std::vector<Book_value> links = get_all_moves_with_value(&board);
             Flip flip;
@@ -1803,7 +2658,7 @@ class Book {
                 return;
             }
             uint64_t n_flags = 0, n_delete = 0;
-            uint64_t book_size = book.size();
+            uint64_t book_size = table().size();
             std::unordered_set<Board, Book_hash> keep_list;
             reset_seen();
             reduce_book_flag_moves(root_board, max_depth, max_error_per_move, max_line_error, &n_flags, keep_list, doing);
@@ -1886,7 +2741,7 @@ class Book {
                 board.undo_board(&flip);
             }
             n_lines = (uint32_t)std::min((uint64_t)MAX_N_LINES, n_lines);
-            book[board].n_lines = (uint32_t)n_lines;
+            table()[board].n_lines = (uint32_t)n_lines;
             return (uint32_t)n_lines;
         }
 
@@ -1940,6 +2795,7 @@ class Book {
         }
 
         void recalculate_n_lines(Board root_board, bool *stop) {
+            journal_mark_all(); // n_lines are changed in place
             std::cerr << "recalculating n_lines..." << std::endl;
             reset_seen();
             recalculate_n_lines_rec(root_board, stop);
@@ -1956,22 +2812,25 @@ class Book {
         }
 
         uint64_t size() {
-            return book.size();
+            if (use_mapped.load(std::memory_order_acquire)) {
+                return mapped_book.size();
+            }
+            return table().size();
         }
 
         void reset_seen() {
             std::vector<Board> boards;
-            for (auto itr = book.begin(); itr != book.end(); ++itr) {
+            for (auto itr = table().begin(); itr != table().end(); ++itr) {
                 boards.emplace_back(itr->first);
             }
             Flip flip;
             for (Board &board: boards) {
-                book[board].seen = false;
+                table()[board].seen = false;
             }
         }
 
         void flag_book_elem(Board board) {
-            book[representative_board(board)].seen = true;
+            table()[representative_board(board)].seen = true;
         }
 
         void add_leaf(Board *board, int8_t value, int8_t policy, int8_t level) {
@@ -1986,12 +2845,22 @@ class Book {
             leaf.value = value;
             leaf.move = rotated_policy;
             leaf.level = level;
-            book[representive_board].leaf = leaf;
+            table()[representive_board].leaf = leaf;
+            journal_mark(representive_board);
         }
 
-        void search_leaf(Board board, int level, bool use_multi_thread) {
+        /*
+            @brief search a new leaf without registering it
+
+            @param board                board to search
+            @param level                search level
+            @param use_multi_thread     use thread pool in search?
+            @param leaf_value           value of the new leaf
+            @param leaf_move            move of the new leaf
+        */
+        void calc_leaf(Board board, int level, bool use_multi_thread, int8_t *leaf_value, int8_t *leaf_move) {
             mtx.lock();
-                Book_elem book_elem = book[board];
+                Book_elem book_elem = table()[board];
             mtx.unlock();
             int8_t new_leaf_value = SCORE_UNDEFINED, new_leaf_move = MOVE_UNDEFINED;
             std::vector<Book_value> links = get_all_moves_with_value(&board);
@@ -2010,6 +2879,13 @@ class Book {
                 new_leaf_move = MOVE_NOMOVE;
             }
             //std::cerr << (int)new_leaf_value << " " << idx_to_coord(new_leaf_move) << std::endl;
+            *leaf_value = new_leaf_value;
+            *leaf_move = new_leaf_move;
+        }
+
+        void search_leaf(Board board, int level, bool use_multi_thread) {
+            int8_t new_leaf_value, new_leaf_move;
+            calc_leaf(board, level, use_multi_thread, &new_leaf_value, &new_leaf_move);
             add_leaf(&board, new_leaf_value, new_leaf_move, level);
         }
 
@@ -2019,12 +2895,12 @@ class Book {
 
         void check_add_leaf_all_undefined() {
             std::vector<Board> boards;
-            for (auto itr = book.begin(); itr != book.end(); ++itr) {
+            for (auto itr = table().begin(); itr != table().end(); ++itr) {
                 boards.emplace_back(itr->first);
             }
             Flip flip;
             for (Board &board: boards) {
-                int leaf_move = book[board].leaf.move;
+                int leaf_move = table()[board].leaf.move;
                 bool need_to_rewrite_leaf = leaf_move < 0 || MOVE_UNDEFINED <= leaf_move;
                 if (!need_to_rewrite_leaf) {
                     calc_flip(&flip, &board, leaf_move);
@@ -2041,7 +2917,7 @@ class Book {
 
         void check_add_leaf_all_search(int level, bool *stop) {
             std::vector<Board> boards;
-            for (auto itr = book.begin(); itr != book.end(); ++itr) {
+            for (auto itr = table().begin(); itr != table().end(); ++itr) {
                 boards.emplace_back(itr->first);
             }
             Flip flip;
@@ -2116,7 +2992,7 @@ class Book {
 
         void recalculate_leaf_all(int level, bool *stop) {
             std::vector<Board> boards;
-            for (auto itr = book.begin(); itr != book.end(); ++itr) {
+            for (auto itr = table().begin(); itr != table().end(); ++itr) {
                 boards.emplace_back(itr->first);
             }
             Flip flip;
@@ -2138,7 +3014,7 @@ class Book {
 
         Book_info calculate_book_info(bool *calculating) {
             Book_info res;
-            for (auto itr = book.begin(); itr != book.end() && *calculating; ++itr) {
+            for (auto itr = table().begin(); itr != table().end() && *calculating; ++itr) {
                 int level = itr->second.level;
                 int ply = itr->first.n_discs() - 4;
                 int leaf_level = itr->second.leaf.level;
@@ -2157,6 +3033,70 @@ class Book {
         }
 
     private:
+        inline Book_elem record_to_book_elem(const Book_mmap_record *record) {
+            Book_elem elem;
+            elem.value = record->value;
+            elem.level = record->level;
+            elem.n_lines = record->n_lines;
+            elem.leaf.value = record->leaf_value;
+            elem.leaf.move = record->leaf_move;
+            elem.leaf.level = record->leaf_level;
+            return elem;
+        }
+
+        /*
+            @brief in-memory table of this book
+
+            The memory-mapped book is read-only. It is copied into the table at the first access,
+            so every method using the table sees the content of this book.
+            Lookups (contain / get / size) use the mapped book directly while it is the content.
+        */
+        inline Book_table& table() {
+            if (use_mapped.load(std::memory_order_acquire)) {
+                copy_mapped_to_table();
+            }
+            return book_table;
+        }
+
+        /*
+            @brief copy memory-mapped book into the in-memory table
+
+            mapped_book is not unmapped here because readers may still use it without lock,
+            it is closed when the book is replaced (delete_all / open_mapped).
+        */
+        void copy_mapped_to_table() {
+            std::lock_guard<std::mutex> lock(mapped_mtx);
+            if (!use_mapped.load(std::memory_order_relaxed)) {
+                return;
+            }
+            book_table.clear();
+            book_table.reserve(mapped_book.size());
+            Board board;
+            for (const Book_mmap_record *itr = mapped_book.begin(); itr != mapped_book.end(); ++itr) {
+                board.player = itr->player;
+                board.opponent = itr->opponent;
+                book_table[board] = record_to_book_elem(itr);
+            }
+            use_mapped.store(false, std::memory_order_release);
+        }
+
+        /*
+            @brief record a changed representative board for the next checkpoint
+        */
+        inline void journal_mark(Board b) {
+            if (!journal_full) {
+                journal_changed.emplace(b);
+            }
+        }
+
+        /*
+            @brief changes are not tracked, next checkpoint saves whole book
+        */
+        inline void journal_mark_all() {
+            journal_full = true;
+            journal_changed.clear();
+        }
+
         void reg_first_board() {
             Board board;
             board.reset();
@@ -2164,7 +3104,7 @@ class Book {
             elem.value = 0;
             elem.leaf.value = 0;
             elem.leaf.move = 19;
-            book[board] = elem;
+            table()[board] = elem;
         }
 
         /*
@@ -2185,9 +3125,10 @@ class Book {
             }
             elem.moves = moves;
             */
-            int f_size = book.size();
-            book[b] = elem;
-            return book.size() - f_size > 0;
+            int f_size = table().size();
+            table()[b] = elem;
+            journal_mark(b);
+            return table().size() - f_size > 0;
         }
 
         /*
@@ -2197,8 +3138,9 @@ class Book {
             @return board deleted?
         */
         inline bool delete_representative_board(Board b) {
-            if (book.find(b) != book.end()) {
-                book.erase(b);
+            if (table().find(b) != table().end()) {
+                table().erase(b);
+                journal_mark(b);
                 return true;
             }
             return false;
@@ -2275,6 +3217,14 @@ void book_save_as_egaroucid(std::string file, int level) {
     book.save_egbk3(file, level);
 }
 
+bool book_save_as_mmap(std::string file) {
+    return book.save_egbkm(file);
+}
+
+int64_t book_check_mmap_parity(std::string file) {
+    return book.check_mapped_parity(file);
+}
+
 void book_save_as_edax(std::string file, int level) {
     book.save_bin_edax(file, level);
 }
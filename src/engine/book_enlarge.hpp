@@ -11,6 +11,11 @@
 #pragma once
 #include <iostream>
 #include <unordered_set>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
 #include "evaluate.hpp"
 #include "board.hpp"
 #include "ai.hpp"
@@ -71,6 +76,148 @@ struct Book_deviate_hash {
 
 
 
+/*
+    @brief a registration found by a book learning worker
+
+    BOOK_LEARN_UPDATE_CHANGE    book.change(board, value, level)
+    BOOK_LEARN_UPDATE_LEAF      book.add_leaf(&board, value, policy, level)
+*/
+#define BOOK_LEARN_UPDATE_CHANGE 0
+#define BOOK_LEARN_UPDATE_LEAF 1
+
+struct Book_learn_update {
+    int type;
+    Board board;
+    int value;
+    int policy;
+    int level;
+};
+
+struct Book_learn_result {
+    Book_deviate_todo_elem elem;
+    std::vector<Book_learn_update> updates;
+};
+
+inline void book_learn_apply(const std::vector<Book_learn_update> &updates) {
+    for (const Book_learn_update &update: updates) {
+        if (update.type == BOOK_LEARN_UPDATE_CHANGE) {
+            book.change(update.board, update.value, update.level);
+        } else {
+            Board board = update.board;
+            book.add_leaf(&board, update.value, update.policy, update.level);
+        }
+    }
+}
+
+/*
+    @brief producer / consumer pipeline for book learning
+
+    Thread pool workers and the calling thread take elems from the todo list and search them.
+    They only read the book. One writer thread applies their results to the book in batches,
+    reports progress and saves the book every AUTO_BOOK_SAVE_TIME while the workers keep searching.
+    The last elems are left to the calling thread, its searches use thread pool workers that finished
+    and start after all results before are applied.
+
+    @param todo                 elems to search
+    @param search               function(elem, use_multi_thread, updates)
+    @param report               function(result, n_done) called by the writer after applying a result
+    @param file                 book file for checkpoints ("" for no checkpoint)
+    @param bak_file             book backup file
+    @param book_learning        a flag to stop
+    @return number of elems done
+*/
+template <typename S, typename R>
+int book_learn_pipeline(const std::vector<Book_deviate_todo_elem> &todo, S search, R report, std::string file, std::string bak_file, bool *book_learning) {
+    const int n_all = todo.size();
+    int next_idx = 0;
+    bool workers_done = false;
+    std::vector<Book_learn_result> results;
+    std::mutex mtx;
+    std::condition_variable cv, cv_applied;
+    int n_done = 0, n_pushed = 0, n_applied = 0;
+    std::thread writer([&]() {
+        uint64_t s = tim();
+        std::vector<Book_learn_result> batch;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                cv.wait(lock, [&]() { return !results.empty() || workers_done; });
+                if (results.empty()) { // workers done
+                    break;
+                }
+                batch.swap(results);
+            }
+            for (const Book_learn_result &result: batch) {
+                book_learn_apply(result.updates);
+                ++n_done;
+                report(result, n_done);
+            }
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                n_applied += batch.size();
+            }
+            cv_applied.notify_all();
+            batch.clear();
+            if (file != "" && tim() - s >= AUTO_BOOK_SAVE_TIME) {
+                book.checkpoint(file, bak_file);
+                s = tim();
+            }
+        }
+    });
+    auto worker = [&](bool is_pool_worker) {
+        while (global_searching && (*book_learning)) {
+            int idx;
+            bool use_multi_thread;
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                if (next_idx >= n_all) {
+                    break;
+                }
+                use_multi_thread = n_all - next_idx <= thread_pool.size();
+                if (use_multi_thread && is_pool_worker) { // leave the rest to the calling thread
+                    break;
+                }
+                idx = next_idx++;
+            }
+            if (use_multi_thread) { // searched one by one, so see all results before as the book does without pipeline
+                std::unique_lock<std::mutex> lock(mtx);
+                cv_applied.wait(lock, [&]() { return n_applied == n_pushed; });
+            }
+            Book_learn_result result;
+            result.elem = todo[idx];
+            search(result.elem, use_multi_thread, result.updates);
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                results.emplace_back(std::move(result));
+                ++n_pushed;
+            }
+            cv.notify_one();
+        }
+    };
+    std::vector<std::future<void>> tasks;
+    for (int i = 0; i < thread_pool.size(); ++i) {
+        bool pushed;
+        tasks.emplace_back(thread_pool.push(&pushed, [&worker]() { worker(true); }));
+        if (!pushed) {
+            tasks.pop_back();
+            break;
+        }
+    }
+    worker(false);
+    for (std::future<void> &task: tasks) {
+        task.get();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        workers_done = true;
+    }
+    cv.notify_one();
+    writer.join();
+    return n_done;
+}
+
+
+
 void get_book_recalculate_leaf_todo(Book_deviate_todo_elem todo_elem, int book_depth, int level, std::unordered_set<Book_deviate_todo_elem, Book_deviate_hash> &todo_list, uint64_t all_strt, bool *book_learning, Board *board_copy, int *player, bool only_illegal) {
     if (!global_searching || !(*book_learning)) {
         return;
@@ -148,85 +295,37 @@ void get_book_recalculate_leaf_todo(Book_deviate_todo_elem todo_elem, int book_d
     }
 }
 
-void book_search_leaf(Board board, int level, bool use_multi_thread) {
-    book.search_leaf(board, level, use_multi_thread);
-}
-
 void book_recalculate_leaves(int level, std::unordered_set<Book_deviate_todo_elem, Book_deviate_hash> &todo_list, uint64_t all_strt, uint64_t strt, bool *book_learning, Board *board_copy, int *player) {
     int n_all = todo_list.size();
     if (n_all == 0) {
         return;
     }
-    int n_done = 0, n_doing = 0;
-    std::vector<std::future<void>> tasks;
-    for (Book_deviate_todo_elem elem: todo_list) {
-        if (!global_searching || !(*book_learning)) {
-            break;
-        }
-        *board_copy = elem.board;
-        *player = elem.player;
-        bool use_multi_thread = (n_all - n_doing) < thread_pool.size() * 2;
-        bool pushed;
-        ++n_doing;
-        if (use_multi_thread) {
-            book_search_leaf(elem.board, level, true);
-            ++n_done;
+    std::vector<Book_deviate_todo_elem> todo(todo_list.begin(), todo_list.end());
+    int n_done = book_learn_pipeline(todo, 
+        [level](const Book_deviate_todo_elem &elem, bool use_multi_thread, std::vector<Book_learn_update> &updates) {
+            Book_learn_update update;
+            update.type = BOOK_LEARN_UPDATE_LEAF;
+            update.board = elem.board;
+            update.level = level;
+            int8_t leaf_value, leaf_move;
+            book.calc_leaf(elem.board, level, use_multi_thread, &leaf_value, &leaf_move);
+            update.value = leaf_value;
+            update.policy = leaf_move;
+            updates.emplace_back(update);
+        }, 
+        [&](const Book_learn_result &result, int n_done) {
+            *board_copy = result.elem.board;
+            *player = result.elem.player;
             if (n_done % 10 == 0) {
                 int percent = 100ULL * n_done / n_all;
                 uint64_t eta = (tim() - strt) * ((double)n_all / n_done - 1.0);
                 std::cerr << "book recalculating leaves " << percent << "% " <<  n_done << "/" << n_all << " time " << ms_to_time_short(tim() - all_strt) << " ETA " << ms_to_time_short(eta) << std::endl;
             }
-        } else{
-            tasks.emplace_back(thread_pool.push(&pushed, std::bind(&book_search_leaf, elem.board, level, use_multi_thread)));
-            if (!pushed) {
-                tasks.pop_back();
-                book_search_leaf(elem.board, level, true);
-                ++n_done;
-                if (n_done % 10 == 0) {
-                    int percent = 100ULL * n_done / n_all;
-                    uint64_t eta = (tim() - strt) * ((double)n_all / n_done - 1.0);
-                    std::cerr << "book recalculating leaves " << percent << "% " <<  n_done << "/" << n_all << " time " << ms_to_time_short(tim() - all_strt) << " ETA " << ms_to_time_short(eta) << std::endl;
-                }
-            }
-        }
-        int tasks_size = tasks.size();
-        for (int i = 0; i < tasks_size; ++i) {
-            if (tasks[i].valid()) {
-                if (tasks[i].wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
-                    tasks[i].get();
-                    ++n_done;
-                    if (n_done % 10 == 0) {
-                        int percent = 100ULL * n_done / n_all;
-                        uint64_t eta = (tim() - strt) * ((double)n_all / n_done - 1.0);
-                        std::cerr << "book recalculating leaves " << percent << "% " <<  n_done << "/" << n_all << " time " << ms_to_time_short(tim() - all_strt) << " ETA " << ms_to_time_short(eta) << std::endl;
-                    }
-                }
-            }
-        }
-        for (int i = 0; i < tasks_size; ++i) {
-            if (i >= tasks.size()) {
-                break;
-            }
-            if (!tasks[i].valid()) {
-                tasks.erase(tasks.begin() + i);
-                --i;
-            }
-        }
-    }
-    int tasks_size = tasks.size();
-    for (int i = 0; i < tasks_size; ++i) {
-        if (tasks[i].valid()) {
-            tasks[i].get();
-            ++n_done;
-            if (n_done % 10 == 0) {
-                int percent = 100ULL * n_done / n_all;
-                uint64_t eta = (tim() - strt) * ((double)n_all / n_done - 1.0);
-                std::cerr << "book recalculating leaves " << percent << "% " <<  n_done << "/" << n_all << " time " << ms_to_time_short(tim() - all_strt) << " ETA " << ms_to_time_short(eta) << std::endl;
-            }
-        }
-    }
+        }, 
+        "", "", book_learning
+    );
     int percent = 100ULL * n_done / n_all;
-    uint64_t eta = (tim() - strt) * ((double)n_all / n_done - 1.0);
+    uint64_t eta = n_done ? (tim() - strt) * ((double)n_all / n_done - 1.0) : 0;
     std::cerr << "book recalculating leaves finished " << percent << "% " <<  n_done << "/" << n_all << " time " << ms_to_time_short(tim() - all_strt) << " ETA " << ms_to_time_short(eta) << std::endl;
 }
 
@@ -372,8 +471,21 @@ void get_book_deviate_todo(Book_deviate_todo_elem todo_elem, int best_move_only_
     }
 }
 
-uint64_t expand_leaf(Book_deviate_todo_elem todo_elem, int book_depth, int level, bool use_multi_thread, bool *book_learning) {
-    Book_elem book_elem = book.get(todo_elem.board);
+/*
+    @brief expand a leaf of the book
+
+    the book is only read here, registrations are stored in updates
+
+    @param todo_elem            leaf to expand
+    @param book_depth           depth of the book
+    @param level                search level
+    @param use_multi_thread     use thread pool in search?
+    @param book_learning        a flag to stop
+    @param updates              registrations found
+    @return number of boards to register
+*/
+uint64_t expand_leaf(Book_deviate_todo_elem todo_elem, int book_depth, int level, bool use_multi_thread, bool *book_learning, std::vector<Book_learn_update> &updates) {
+    Book_elem book_elem = book.get_lock(todo_elem.board);
     Flip flip;
     calc_flip(&flip, &todo_elem.board, book_elem.leaf.move);
     todo_elem.move(&flip, 0);
@@ -381,16 +493,16 @@ uint64_t expand_leaf(Book_deviate_todo_elem todo_elem, int book_depth, int level
         todo_elem.board.pass();
         if (todo_elem.board.get_legal() == 0) {
             todo_elem.board.pass();
-            book.change(todo_elem.board, todo_elem.board.score_player(), 60);
+            updates.emplace_back(Book_learn_update{BOOK_LEARN_UPDATE_CHANGE, todo_elem.board, todo_elem.board.score_player(), MOVE_UNDEFINED, 60});
             return 1;
         }
     }
     uint64_t n_add = 0;
     int prev_value = book_elem.value;
-    while (todo_elem.board.n_discs() <= book_depth + 4 && !book.contain(&todo_elem.board) && (*book_learning) && todo_elem.remaining_error >= 0) {
+    while (todo_elem.board.n_discs() <= book_depth + 4 && !book.contain_lock(todo_elem.board) && (*book_learning) && todo_elem.remaining_error >= 0) {
         Search_result search_result = ai(todo_elem.board, level, true, 0, use_multi_thread, false);
         if (-HW2 <= search_result.value && search_result.value <= HW2) {
-            book.change(todo_elem.board, search_result.value, level);
+            updates.emplace_back(Book_learn_update{BOOK_LEARN_UPDATE_CHANGE, todo_elem.board, search_result.value, MOVE_UNDEFINED, level});
             ++n_add;
             if (is_valid_policy(search_result.policy) && (todo_elem.board.get_legal() & (1ULL << search_result.policy))) {
                 int error = 0;
@@ -410,13 +522,13 @@ uint64_t expand_leaf(Book_deviate_todo_elem todo_elem, int book_depth, int level
                         prev_value *= -1;
                         if (todo_elem.board.get_legal() == 0) { // game over
                             todo_elem.board.pass();
-                            book.change(todo_elem.board, todo_elem.board.score_player(), 60);
+                            updates.emplace_back(Book_learn_update{BOOK_LEARN_UPDATE_CHANGE, todo_elem.board, todo_elem.board.score_player(), MOVE_UNDEFINED, 60});
                             ++n_add;
                             break;
                         }
                     }
                 } else{
-                    book.add_leaf(&todo_elem.board, search_result.value, search_result.policy, level);
+                    updates.emplace_back(Book_learn_update{BOOK_LEARN_UPDATE_LEAF, todo_elem.board, search_result.value, search_result.policy, level});
                     break;
                 }
             } else
@@ -431,81 +543,26 @@ uint64_t expand_leaves(int book_depth, int level, int max_error_per_move, std::u
     if (n_all == 0) {
         return 0;
     }
-    int n_done = 0;
-    int n_doing = 0;
-    std::vector<std::future<uint64_t>> tasks;
-    uint64_t s = tim();
+    std::vector<Book_deviate_todo_elem> todo(book_deviate_todo.begin(), book_deviate_todo.end());
     uint64_t n_add = 0;
-    for (Book_deviate_todo_elem elem: book_deviate_todo) {
-        if (tim() - s >= AUTO_BOOK_SAVE_TIME) {
-            book.save_egbk3(file, bak_file);
-            s = tim();
-        }
-        if (!global_searching || !(*book_learning)) {
-            break;
-        }
-        *board_copy = elem.board;
-        *player = elem.player;
-        bool use_multi_thread = (n_all - n_doing) < thread_pool.size() * 2;
-        bool pushed;
-        ++n_doing;
-        if (use_multi_thread) { // multi thread, 1 problem
-            n_add += expand_leaf(elem, book_depth, level, true, book_learning);
-            ++n_done;
-            int percent = 100ULL * n_done / n_all;
-            uint64_t eta = (tim() - strt) * ((double)n_all / n_done - 1.0);
-            std::string time_short = ms_to_time_short(tim() - all_strt);
-            std::string eta_short = ms_to_time_short(eta);
-            std::cerr << "loop " << n_loop << " book deviating " << percent << "% " <<  n_done << "/" << n_all << " registered " << n_add << " time " << time_short << " ETA " << eta_short << std::endl;
-        } else{ // single thread, multi problems
-            tasks.emplace_back(thread_pool.push(&pushed, std::bind(&expand_leaf, elem, book_depth, level, false, book_learning)));
-            if (!pushed) {
-                tasks.pop_back();
-                n_add += expand_leaf(elem, book_depth, level, true, book_learning);
-                ++n_done;
-                int percent = 100ULL * n_done / n_all;
-                uint64_t eta = (tim() - strt) * ((double)n_all / n_done - 1.0);
-                std::string time_short = ms_to_time_short(tim() - all_strt);
-                std::string eta_short = ms_to_time_short(eta);
-                std::cerr << "loop " << n_loop << " book deviating " << percent << "% " <<  n_done << "/" << n_all << " registered " << n_add << " time " << time_short << " ETA " << eta_short << std::endl;
-            }
-        }
-        int tasks_size = tasks.size();
-        for (int i = 0; i < tasks_size; ++i) {
-            if (tasks[i].valid()) {
-                if (tasks[i].wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
-                    n_add += tasks[i].get();
-                    ++n_done;
-                    int percent = 100ULL * n_done / n_all;
-                    uint64_t eta = (tim() - strt) * ((double)n_all / n_done - 1.0);
-                    std::string time_short = ms_to_time_short(tim() - all_strt);
-                    std::string eta_short = ms_to_time_short(eta);
-                    std::cerr << "loop " << n_loop << " book deviating " << percent << "% " <<  n_done << "/" << n_all << " registered " << n_add << " time " << time_short << " ETA " << eta_short << std::endl;
-                }
-            }
-        }
-        for (int i = 0; i < tasks_size; ++i) {
-            if (i >= tasks.size()) {
-                break;
-            }
-            if (!tasks[i].valid()) {
-                tasks.erase(tasks.begin() + i);
-                --i;
+    book_learn_pipeline(todo, 
+        [book_depth, level, book_learning](const Book_deviate_todo_elem &elem, bool use_multi_thread, std::vector<Book_learn_update> &updates) {
+            expand_leaf(elem, book_depth, level, use_multi_thread, book_learning, updates);
+        }, 
+        [&](const Book_learn_result &result, int n_done) {
+            *board_copy = result.elem.board;
+            *player = result.elem.player;
+            for (const Book_learn_update &update: result.updates) {
+                n_add += update.type == BOOK_LEARN_UPDATE_CHANGE;
             }
-        }
-    }
-    int tasks_size = tasks.size();
-    for (int i = 0; i < tasks_size; ++i) {
-        if (tasks[i].valid()) {
-            n_add += tasks[i].get();
-            ++n_done;
             int percent = 100ULL * n_done / n_all;
             uint64_t eta = (tim() - strt) * ((double)n_all / n_done - 1.0);
             std::string time_short = ms_to_time_short(tim() - all_strt);
             std::string eta_short = ms_to_time_short(eta);
             std::cerr << "loop " << n_loop << " book deviating " << percent << "% " <<  n_done << "/" << n_all << " registered " << n_add << " time " << time_short << " ETA " << eta_short << std::endl;
-        }
-    }
+        }, 
+        file, bak_file, book_learning
+    );
     return n_add;
 }
 
@@ -540,7 +597,7 @@ inline void book_deviate(Board root_board, int level, int book_depth, int max_er
     while (n_loop < max_n_loops) {
         ++n_loop;
         if (tim() - s > AUTO_BOOK_SAVE_TIME && *book_learning) {
-            book.save_egbk3(book_file, book_bak);
+            book.checkpoint(book_file, book_bak);
             s = tim();
         }
         Book_elem book_elem = book.get(root_board);
@@ -0,0 +1,261 @@
+/*
+    Egaroucid Project
+
+    @file book_mmap.hpp
+        Memory-mapped book (sorted fixed-size records, read-only)
+    @date 2021-2025
+    @author Takuto Yamana
+    @license GPL-3.0 license
+*/
+
+#pragma once
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "common.hpp"
+#include "board.hpp"
+#if _WIN64 || _WIN32
+    #define BOOK_MMAP_USE_MMAP false
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+    #define BOOK_MMAP_USE_MMAP true
+#endif
+
+#define BOOK_MMAP_EXTENSION ".egbkm"
+#define BOOK_MMAP_EXTENSION_NODOT "egbkm"
+
+constexpr char BOOK_MMAP_VERSION = 4;
+
+/*
+    @brief header of memory-mapped book
+
+    @param egaroucid_str        "DICUORAGE"
+    @param book_version         BOOK_MMAP_VERSION
+    @param n_boards             number of records
+    @param record_size          sizeof(Book_mmap_record)
+*/
+struct Book_mmap_header {
+    char egaroucid_str[9];
+    char book_version;
+    char reserved[6];
+    uint64_t n_boards;
+    uint64_t record_size;
+};
+
+/*
+    @brief a record of memory-mapped book
+
+    records are representative boards sorted by (player, opponent)
+*/
+struct Book_mmap_record {
+    uint64_t player;
+    uint64_t opponent;
+    uint32_t n_lines;
+    int8_t value;
+    int8_t level;
+    int8_t leaf_value;
+    int8_t leaf_move;
+    int8_t leaf_level;
+    int8_t reserved[7];
+};
+
+static_assert(sizeof(Book_mmap_header) == 32, "Book_mmap_header must be 32 bytes");
+static_assert(sizeof(Book_mmap_record) == 32, "Book_mmap_record must be 32 bytes");
+
+inline bool book_mmap_record_less(const Book_mmap_record &a, const Book_mmap_record &b) {
+    return a.player < b.player || (a.player == b.player && a.opponent < b.opponent);
+}
+
+/*
+    @brief read-only book queried in place
+
+    On POSIX the file is mapped with mmap, so startup does not parse anything and the pages are shared among processes.
+    On Windows the file is read with a single fread.
+*/
+class Book_mmap {
+    private:
+        const Book_mmap_record *records;
+        uint64_t n_records;
+#if BOOK_MMAP_USE_MMAP
+        void *mapped;
+        size_t mapped_size;
+#else
+        std::vector<Book_mmap_record> buffer;
+#endif
+
+    public:
+        Book_mmap()
+            : records(nullptr), n_records(0)
+#if BOOK_MMAP_USE_MMAP
+            , mapped(nullptr), mapped_size(0)
+#endif
+        {}
+
+        ~Book_mmap() {
+            close();
+        }
+
+        Book_mmap(const Book_mmap&) = delete;
+        Book_mmap& operator=(const Book_mmap&) = delete;
+
+        /*
+            @brief open memory-mapped book
+
+            @param file                 book file (.egbkm file)
+            @param show_log             show log?
+            @return opened? (false without error message if the file is not this format)
+        */
+        bool open(std::string file, bool show_log) {
+            close();
+            FILE* fp;
+            if (!file_open(&fp, file.c_str(), "rb")) {
+                return false;
+            }
+            Book_mmap_header header;
+            if (fread(&header, sizeof(Book_mmap_header), 1, fp) < 1) {
+                fclose(fp);
+                return false;
+            }
+            char egaroucid_str_ans[] = "DICUORAGE";
+            for (int i = 0; i < 9; ++i) {
+                if (header.egaroucid_str[i] != egaroucid_str_ans[i]) {
+                    fclose(fp);
+                    return false;
+                }
+            }
+            if (header.book_version != BOOK_MMAP_VERSION) {
+                fclose(fp);
+                return false;
+            }
+            if (header.record_size != sizeof(Book_mmap_record)) {
+                std::cerr << "[ERROR] memory-mapped book record size mismatch " << header.record_size << std::endl;
+                fclose(fp);
+                return false;
+            }
+            size_t expected_size = sizeof(Book_mmap_header) + header.n_boards * sizeof(Book_mmap_record);
+#if BOOK_MMAP_USE_MMAP
+            fclose(fp);
+            int fd = ::open(file.c_str(), O_RDONLY);
+            if (fd == -1) {
+                std::cerr << "[ERROR] can't open memory-mapped book " << file << std::endl;
+                return false;
+            }
+            struct stat st;
+            if (fstat(fd, &st) == -1 || (size_t)st.st_size != expected_size) {
+                std::cerr << "[ERROR] memory-mapped book broken " << file << std::endl;
+                ::close(fd);
+                return false;
+            }
+            void *p = mmap(nullptr, expected_size, PROT_READ, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if (p == MAP_FAILED) {
+                std::cerr << "[ERROR] mmap failed " << file << std::endl;
+                return false;
+            }
+            madvise(p, expected_size, MADV_RANDOM);
+            mapped = p;
+            mapped_size = expected_size;
+            records = (const Book_mmap_record*)((const char*)p + sizeof(Book_mmap_header));
+#else
+            buffer.resize(header.n_boards);
+            if (fread(buffer.data(), sizeof(Book_mmap_record), header.n_boards, fp) < header.n_boards || fgetc(fp) != EOF) {
+                std::cerr << "[ERROR] memory-mapped book broken " << file << std::endl;
+                buffer.clear();
+                fclose(fp);
+                return false;
+            }
+            fclose(fp);
+            records = buffer.data();
+#endif
+            n_records = header.n_boards;
+            if (show_log) {
+                std::cerr << "mapped " << n_records << " boards from " << file << std::endl;
+            }
+            return true;
+        }
+
+        /*
+            @brief release book
+        */
+        void close() {
+#if BOOK_MMAP_USE_MMAP
+            if (mapped != nullptr) {
+                munmap(mapped, mapped_size);
+                mapped = nullptr;
+                mapped_size = 0;
+            }
+#else
+            buffer.clear();
+            buffer.shrink_to_fit();
+#endif
+            records = nullptr;
+            n_records = 0;
+        }
+
+        inline bool is_open() const {
+            return records != nullptr;
+        }
+
+        inline uint64_t size() const {
+            return n_records;
+        }
+
+        inline const Book_mmap_record* begin() const {
+            return records;
+        }
+
+        inline const Book_mmap_record* end() const {
+            return records + n_records;
+        }
+
+        /*
+            @brief find a representative board
+
+            @param b                    representative board
+            @return record (nullptr if not found)
+        */
+        inline const Book_mmap_record* find(Board b) const {
+            Book_mmap_record key;
+            key.player = b.player;
+            key.opponent = b.opponent;
+            const Book_mmap_record *itr = std::lower_bound(begin(), end(), key, book_mmap_record_less);
+            if (itr != end() && itr->player == b.player && itr->opponent == b.opponent) {
+                return itr;
+            }
+            return nullptr;
+        }
+};
+
+/*
+    @brief write memory-mapped book
+
+    @param file                 file name to save
+    @param records              records (sorted in this function)
+    @return saved?
+*/
+inline bool book_mmap_write(std::string file, std::vector<Book_mmap_record> &records) {
+    std::sort(records.begin(), records.end(), book_mmap_record_less);
+    std::ofstream fout;
+    fout.open(file.c_str(), std::ios::out|std::ios::binary|std::ios::trunc);
+    if (!fout) {
+        std::cerr << "can't open " << file << std::endl;
+        return false;
+    }
+    Book_mmap_header header = {};
+    char egaroucid_str[] = "DICUORAGE";
+    for (int i = 0; i < 9; ++i) {
+        header.egaroucid_str[i] = egaroucid_str[i];
+    }
+    header.book_version = BOOK_MMAP_VERSION;
+    header.n_boards = records.size();
+    header.record_size = sizeof(Book_mmap_record);
+    fout.write((char*)&header, sizeof(Book_mmap_header));
+    fout.write((char*)records.data(), sizeof(Book_mmap_record) * records.size());
+    fout.close();
+    return !fout.fail();
+}
@@ -125,7 +125,7 @@ int clog_search(Search *search, int depth, bool *searching) {
         return CLOG_NOT_FOUND;
     }
     const int canput = pop_count_ull(legal);
-    std::vector<Flip_value> move_list(canput);
+    Move_list move_list(canput);
     int idx = 0;
     for (uint_fast8_t cell = first_bit(&legal); legal; cell = next_bit(&legal)) {
         calc_flip(&move_list[idx].flip, &search->board, cell);
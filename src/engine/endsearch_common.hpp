@@ -115,14 +115,14 @@ inline bool is_1empty(uint32_t place, uint64_t b) {
 inline int last1(Search *search, uint64_t player, int alpha, uint_fast8_t p0) {
     ++search->n_nodes;
 #if USE_SEARCH_STATISTICS
-    ++search->n_nodes_discs[63];
+    search_statistics_count_node(63);
 #endif
     int n_flip = count_last_flip(player, p0);
     int score = 2 * (pop_count_ull(player) + n_flip + 1) - HW2;	// (P + n_flip + 1) - (HW2 - 1 - P - n_flip)
     if (n_flip == 0) {
         ++search->n_nodes;
 #if USE_SEARCH_STATISTICS
-        ++search->n_nodes_discs[63];
+        search_statistics_count_node(63);
 #endif
         int score2 = score - 2;	// empty for opponent
         if (score <= 0)
@@ -28,7 +28,7 @@
 static int last2(Search *search, int alpha, int beta, uint_fast8_t p0, uint_fast8_t p1, Board board) {
     ++search->n_nodes;
 #if USE_SEARCH_STATISTICS
-    ++search->n_nodes_discs[62];
+    search_statistics_count_node(62);
 #endif
     int v;
     Flip flip;
@@ -48,7 +48,7 @@ static int last2(Search *search, int alpha, int beta, uint_fast8_t p0, uint_fast
     } else {	// pass
         ++search->n_nodes;
 #if USE_SEARCH_STATISTICS
-        ++search->n_nodes_discs[62];
+        search_statistics_count_node(62);
 #endif
         alpha = -beta;
         if (flip.calc_flip(board.opponent, board.player, p0)) { // p0
@@ -110,7 +110,7 @@ static int last3(Search *search, int alpha, int beta, uint_fast8_t p0, uint_fast
     do {
         ++search->n_nodes;
 #if USE_SEARCH_STATISTICS
-        ++search->n_nodes_discs[61];
+        search_statistics_count_node(61);
 #endif
         if ((bit_around[p0] & board.opponent) && calc_flip(&flip, &board, p0)) {
             board.move_copy(&flip, &board2);
@@ -227,7 +227,7 @@ int last4(Search *search, int alpha, int beta) {
     do {
         ++search->n_nodes;
 #if USE_SEARCH_STATISTICS
-        ++search->n_nodes_discs[60];
+        search_statistics_count_node(60);
 #endif
         if ((bit_around[p0] & board4.opponent) && calc_flip(&flip, &board4, p0)) {
             board4.move_copy(&flip, &board3);
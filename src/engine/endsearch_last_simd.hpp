@@ -38,7 +38,7 @@ static inline int vectorcall last1(Search *search, __m128i PO, int alpha, int pl
 
     ++search->n_nodes;
 #if USE_SEARCH_STATISTICS
-    ++search->n_nodes_discs[63];
+    search_statistics_count_node(63);
 #endif
     uint_fast8_t n_flip = n_flip_pre_calc[_mm_extract_epi16(II, 4)][x];
     n_flip += n_flip_pre_calc[_mm_cvtsi128_si32(II)][x];
@@ -51,7 +51,7 @@ static inline int vectorcall last1(Search *search, __m128i PO, int alpha, int pl
     if (n_flip == 0) {
         ++search->n_nodes;
         #if USE_SEARCH_STATISTICS
-            ++search->n_nodes_discs[63];
+            search_statistics_count_node(63);
         #endif
         int score2 = score - 2;	// empty for player
         if (score <= 0) {
@@ -92,7 +92,7 @@ static int vectorcall last2(Search *search, __m128i OP, int alpha, int beta, uin
 
     ++search->n_nodes;
 #if USE_SEARCH_STATISTICS
-    ++search->n_nodes_discs[62];
+    search_statistics_count_node(62);
 #endif
     int v;
     if ((bit_around[p0] & opponent) && !TESTZ_FLIP(flipped = Flip::calc_flip(OP, p0))) { // p0
@@ -109,7 +109,7 @@ static int vectorcall last2(Search *search, __m128i OP, int alpha, int beta, uin
     } else { // pass
         ++search->n_nodes;
 #if USE_SEARCH_STATISTICS
-        ++search->n_nodes_discs[62];
+        search_statistics_count_node(62);
 #endif
         alpha = -beta;
         __m128i PO = _mm_shuffle_epi32(OP, SWAP64);
@@ -161,7 +161,7 @@ static int vectorcall last3(Search *search, __m128i OP, int alpha, int beta, uin
     do {
         ++search->n_nodes;
 #if USE_SEARCH_STATISTICS
-        ++search->n_nodes_discs[61];
+        search_statistics_count_node(61);
 #endif
         opponent = _mm_extract_epi64(OP, 1);
         int x = p0;
@@ -279,7 +279,7 @@ int last4(Search *search, int alpha, int beta) {
     do {
         ++search->n_nodes;
 #if USE_SEARCH_STATISTICS
-        ++search->n_nodes_discs[60];
+        search_statistics_count_node(60);
 #endif
         opponent = _mm_extract_epi64(OP, 1);
         if ((bit_around[p0] & opponent) && !TESTZ_FLIP(flipped = Flip::calc_flip(OP, p0))) {
@@ -51,7 +51,7 @@ constexpr int LOCAL_TT_SIZE_BIT = 10;
 int nega_alpha_end_fast_nws(Search *search, int alpha, const bool skipped) {
     ++search->n_nodes;
 #if USE_SEARCH_STATISTICS
-    ++search->n_nodes_discs[search->n_discs];
+    search_statistics_count_node(search->n_discs);
 #endif
 #if USE_END_SC
     if (!skipped) {
@@ -177,7 +177,7 @@ int nega_alpha_end_simple_nws(Search *search, int alpha, const bool skipped, uin
     }
     ++search->n_nodes;
 #if USE_SEARCH_STATISTICS
-    ++search->n_nodes_discs[search->n_discs];
+    search_statistics_count_node(search->n_discs);
 #endif
 #if USE_END_SC
     if (!skipped) {
@@ -298,7 +298,7 @@ int nega_alpha_end_nws(Search *search, int alpha, const bool skipped, uint64_t l
     }
     ++search->n_nodes;
     #if USE_SEARCH_STATISTICS
-        ++search->n_nodes_discs[search->n_discs];
+        search_statistics_count_node(search->n_discs);
     #endif
     #if USE_END_SC
         if (!skipped) {
@@ -324,7 +324,7 @@ int nega_alpha_end_nws(Search *search, int alpha, const bool skipped, uint64_t l
     int best_move = MOVE_UNDEFINED;
     int g;
     const int canput = pop_count_ull(legal);
-    std::vector<Flip_value> move_list(canput);
+    Move_list move_list(canput);
     int idx = 0;
     for (uint_fast8_t cell = first_bit(&legal); legal; cell = next_bit(&legal)) {
         calc_flip(&move_list[idx].flip, &search->board, cell);
@@ -27,7 +27,7 @@
 static int last2_nws(Search *search, int alpha, uint_fast8_t p0, uint_fast8_t p1, Board board) {
     ++search->n_nodes;
 #if USE_SEARCH_STATISTICS
-    ++search->n_nodes_discs[62];
+    search_statistics_count_node(62);
 #endif
     int v;
     Flip flip;
@@ -47,7 +47,7 @@ static int last2_nws(Search *search, int alpha, uint_fast8_t p0, uint_fast8_t p1
     } else { // pass
         ++search->n_nodes;
 #if USE_SEARCH_STATISTICS
-        ++search->n_nodes_discs[62];
+        search_statistics_count_node(62);
 #endif
         alpha = -alpha - 1;
         if (flip.calc_flip(board.opponent, board.player, p0)) { // p0
@@ -108,7 +108,7 @@ static int last3_nws(Search *search, int alpha, uint_fast8_t p0, uint_fast8_t p1
     do {
         ++search->n_nodes;
 #if USE_SEARCH_STATISTICS
-        ++search->n_nodes_discs[61];
+        search_statistics_count_node(61);
 #endif
         if ((bit_around[p0] & board.opponent) && calc_flip(&flip, &board, p0)) {
             board.move_copy(&flip, &board2);
@@ -218,7 +218,7 @@ int last4_nws(Search *search, int alpha) {
     do {
         ++search->n_nodes;
 #if USE_SEARCH_STATISTICS
-        ++search->n_nodes_discs[60];
+        search_statistics_count_node(60);
 #endif
         if ((bit_around[p0] & board4.opponent) && calc_flip(&flip, &board4, p0)) {
             board4.move_copy(&flip, &board3);
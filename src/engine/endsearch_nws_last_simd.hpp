@@ -46,7 +46,7 @@ static inline int vectorcall last1_nws(Search *search, __m128i PO, int alpha, in
 
     ++search->n_nodes;
 #if USE_SEARCH_STATISTICS
-    ++search->n_nodes_discs[63];
+    search_statistics_count_node(63);
 #endif
     __m256i lM = lrmask[place].v4[0];
     __m256i rM = lrmask[place].v4[1];
@@ -63,7 +63,7 @@ static inline int vectorcall last1_nws(Search *search, __m128i PO, int alpha, in
         if (_mm256_testz_si256(_mm256_or_si256(lmO, rmO), _mm256_set1_epi64x(bit_around[place]))) {
             ++search->n_nodes;
 #if USE_SEARCH_STATISTICS
-            ++search->n_nodes_discs[63];
+            search_statistics_count_node(63);
 #endif
                 // n_flip = last_flip(pos, ~P);
                 // left: set below LS1B if O is in lM
@@ -114,7 +114,7 @@ static inline int vectorcall last1_nws(Search *search, __m128i PO, int alpha, in
 
     ++search->n_nodes;
 #if USE_SEARCH_STATISTICS
-    ++search->n_nodes_discs[63];
+    search_statistics_count_node(63);
 #endif
     if (score > alpha) {    // if player can move, high cut-off will occur regardress of n_flip.
         __m256i lM = lrmask[place].v4[0];
@@ -126,7 +126,7 @@ static inline int vectorcall last1_nws(Search *search, __m128i PO, int alpha, in
         if (_mm256_testz_si256(F, _mm256_broadcastq_epi64(*(__m128i *) &bit_around[place]))) {    // pass
             ++search->n_nodes;
 #if USE_SEARCH_STATISTICS
-            ++search->n_nodes_discs[63];
+            search_statistics_count_node(63);
 #endif
                 // n_flip = count_last_flip(~P, place);
             t = ~_mm256_movemask_epi8(_mm256_cmpeq_epi8(lmO, rmO));    // eq only if l = r = 0
@@ -172,7 +172,7 @@ static int vectorcall last2_nws(Search *search, __m128i OP, int alpha, uint32_t
 
     ++search->n_nodes;
     #if USE_SEARCH_STATISTICS
-        ++search->n_nodes_discs[62];
+        search_statistics_count_node(62);
     #endif
     int v;
     if ((bit_around[p0] & opponent) && !TESTZ_FLIP(flipped = Flip::calc_flip(OP, p0))) {
@@ -191,7 +191,7 @@ static int vectorcall last2_nws(Search *search, __m128i OP, int alpha, uint32_t
     else {    // pass
         ++search->n_nodes;
         #if USE_SEARCH_STATISTICS
-            ++search->n_nodes_discs[62];
+            search_statistics_count_node(62);
         #endif
         alpha = -(alpha + 1);    // -beta
         __m128i PO = _mm_shuffle_epi32(OP, SWAP64);
@@ -242,7 +242,7 @@ static int vectorcall last3_nws(Search *search, __m128i OP, int alpha, uint32_t
     do {
         ++search->n_nodes;
         #if USE_SEARCH_STATISTICS
-            ++search->n_nodes_discs[61];
+            search_statistics_count_node(61);
         #endif
         opponent = _mm_extract_epi64(OP, 1);
         int x = p0;
@@ -344,7 +344,7 @@ int last4_nws(Search *search, int alpha) {
     do {
         ++search->n_nodes;
         #if USE_SEARCH_STATISTICS
-            ++search->n_nodes_discs[60];
+            search_statistics_count_node(60);
         #endif
         opponent = _mm_extract_epi64(OP, 1);
         if ((bit_around[p0] & opponent) && !TESTZ_FLIP(flipped = Flip::calc_flip(OP, p0))) {
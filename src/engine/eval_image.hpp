@@ -0,0 +1,301 @@
+/*
+    Egaroucid Project
+
+    @file eval_image.hpp
+        Evaluation weights shared among processes
+    @date 2021-2025
+    @author Takuto Yamana
+    @license GPL-3.0 license
+*/
+
+#pragma once
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <cstdio>
+#include <cstdint>
+#include "common.hpp"
+#include "util.hpp"
+#if _WIN64 || _WIN32
+    #define EVAL_IMAGE_USE_MMAP false
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
+    #define EVAL_IMAGE_USE_MMAP true
+#endif
+
+constexpr char EVAL_IMAGE_VERSION = 1;
+constexpr int EVAL_IMAGE_MAX_SOURCES = 2;
+constexpr int EVAL_IMAGE_MAX_SEGMENTS = 8;
+constexpr size_t EVAL_IMAGE_ALIGNMENT = 64; // each table starts on a cache line
+
+/*
+    @brief evaluator build variant baked into the image
+
+    Tables are post-processed for the evaluator they are loaded by, so an image
+    made by another build must not be attached.
+*/
+#if USE_SIMD_EVALUATION
+    #if USE_ARM
+        constexpr char EVAL_IMAGE_VARIANT = 3; // NEON
+    #elif USE_AVX512_EVAL
+        constexpr char EVAL_IMAGE_VARIANT = 2; // AVX-512
+    #else
+        constexpr char EVAL_IMAGE_VARIANT = 1; // AVX2
+    #endif
+#else
+    constexpr char EVAL_IMAGE_VARIANT = 0; // generic
+#endif
+
+/*
+    @brief evaluation image file
+
+    If not empty, post-processed evaluation tables are baked into this file once
+    and mapped read-only by every process, so that the page cache holds one copy.
+    A file on tmpfs (e.g. /dev/shm/egaroucid.egevi) works as named shared memory.
+*/
+std::string eval_image_file;
+
+/*
+    @brief header of evaluation image
+
+    @param egaroucid_str        "DICUORAGE"
+    @param image_version        EVAL_IMAGE_VERSION
+    @param variant              EVAL_IMAGE_VARIANT
+    @param n_segments           number of tables
+    @param source_size          size of source files (eval and move ordering eval)
+    @param source_time          last write time of source files
+    @param segment_sizes        number of int16_t parameters of each table
+
+    tables follow the header, each aligned to EVAL_IMAGE_ALIGNMENT
+*/
+struct Eval_image_header {
+    char egaroucid_str[9];
+    char image_version;
+    char variant;
+    char reserved[1];
+    uint32_t n_segments;
+    uint64_t source_size[EVAL_IMAGE_MAX_SOURCES];
+    int64_t source_time[EVAL_IMAGE_MAX_SOURCES];
+    uint64_t segment_sizes[EVAL_IMAGE_MAX_SEGMENTS];
+};
+
+/*
+    @brief table of evaluation image
+
+    @param ptr                  parameters (in the process when baking, in the image when attached)
+    @param n                    number of parameters
+*/
+struct Eval_image_segment {
+    int16_t *ptr;
+    size_t n;
+};
+
+inline size_t eval_image_offset(const Eval_image_header &header, int segment_idx) {
+    size_t offset = (sizeof(Eval_image_header) + EVAL_IMAGE_ALIGNMENT - 1) / EVAL_IMAGE_ALIGNMENT * EVAL_IMAGE_ALIGNMENT;
+    for (int i = 0; i < segment_idx; ++i) {
+        offset += (header.segment_sizes[i] * sizeof(int16_t) + sizeof(int) + EVAL_IMAGE_ALIGNMENT - 1) / EVAL_IMAGE_ALIGNMENT * EVAL_IMAGE_ALIGNMENT; // SIMD gathers read 32 bits at the last parameter
+    }
+    return offset;
+}
+
+inline Eval_image_header eval_image_make_header(const std::vector<std::string> &sources, const std::vector<Eval_image_segment> &segments) {
+    Eval_image_header header = {};
+    char egaroucid_str[] = "DICUORAGE";
+    for (int i = 0; i < 9; ++i) {
+        header.egaroucid_str[i] = egaroucid_str[i];
+    }
+    header.image_version = EVAL_IMAGE_VERSION;
+    header.variant = EVAL_IMAGE_VARIANT;
+    header.n_segments = segments.size();
+    for (int i = 0; i < (int)sources.size() && i < EVAL_IMAGE_MAX_SOURCES; ++i) {
+        std::error_code ec;
+        header.source_size[i] = std::filesystem::file_size(sources[i], ec);
+        if (!ec) {
+            header.source_time[i] = std::filesystem::last_write_time(sources[i], ec).time_since_epoch().count();
+        }
+    }
+    for (int i = 0; i < (int)segments.size(); ++i) {
+        header.segment_sizes[i] = segments[i].n;
+    }
+    return header;
+}
+
+/*
+    @brief evaluation tables mapped from an image file
+*/
+class Eval_image {
+    private:
+        void *mapped;
+        size_t mapped_size;
+
+    public:
+        Eval_image()
+            : mapped(nullptr), mapped_size(0) {}
+
+        ~Eval_image() {
+            release();
+        }
+
+        Eval_image(const Eval_image&) = delete;
+        Eval_image& operator=(const Eval_image&) = delete;
+
+        /*
+            @brief map an image read-only
+
+            @param file                 image file
+            @param sources              source evaluation files (image is stale if they changed)
+            @param segments             sizes of tables, pointers into the image are set if attached
+            @return attached?
+        */
+        bool attach(std::string file, const std::vector<std::string> &sources, std::vector<Eval_image_segment> &segments) {
+#if EVAL_IMAGE_USE_MMAP
+            release();
+            if (segments.size() > EVAL_IMAGE_MAX_SEGMENTS) {
+                return false;
+            }
+            int fd = ::open(file.c_str(), O_RDONLY);
+            if (fd == -1) {
+                return false;
+            }
+            Eval_image_header header;
+            Eval_image_header expected = eval_image_make_header(sources, segments);
+            size_t file_size = lseek(fd, 0, SEEK_END);
+            if (pread(fd, &header, sizeof(Eval_image_header), 0) != sizeof(Eval_image_header) || memcmp(&header, &expected, sizeof(Eval_image_header)) != 0) {
+                ::close(fd);
+                return false;
+            }
+            size_t image_size = eval_image_offset(header, header.n_segments);
+            if (file_size < image_size) {
+                ::close(fd);
+                return false;
+            }
+            void *p = mmap(nullptr, image_size, PROT_READ, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if (p == MAP_FAILED) {
+                return false;
+            }
+            mapped = p;
+            mapped_size = image_size;
+            for (int i = 0; i < (int)segments.size(); ++i) {
+                segments[i].ptr = (int16_t*)((char*)mapped + eval_image_offset(header, i));
+            }
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        /*
+            @brief write an image
+
+            written to a temporary file and renamed, so that other processes never map a half-written image
+
+            @param file                 image file
+            @param sources              source evaluation files
+            @param segments             tables to write
+            @return written?
+        */
+        static bool bake(std::string file, const std::vector<std::string> &sources, const std::vector<Eval_image_segment> &segments) {
+            if (segments.size() > EVAL_IMAGE_MAX_SEGMENTS) {
+                return false;
+            }
+            Eval_image_header header = eval_image_make_header(sources, segments);
+#if EVAL_IMAGE_USE_MMAP
+            std::string tmp_file = file + ".tmp" + std::to_string(getpid());
+#else
+            std::string tmp_file = file + ".tmp";
+#endif
+            std::ofstream fout;
+            fout.open(tmp_file.c_str(), std::ios::out|std::ios::binary|std::ios::trunc);
+            if (!fout) {
+                return false;
+            }
+            const char padding[EVAL_IMAGE_ALIGNMENT] = {};
+            fout.write((char*)&header, sizeof(Eval_image_header));
+            fout.write(padding, eval_image_offset(header, 0) - sizeof(Eval_image_header));
+            for (int i = 0; i < (int)segments.size(); ++i) {
+                size_t n_bytes = segments[i].n * sizeof(int16_t);
+                fout.write((char*)segments[i].ptr, n_bytes);
+                fout.write(padding, eval_image_offset(header, i + 1) - eval_image_offset(header, i) - n_bytes);
+            }
+            fout.close();
+            if (fout.fail()) {
+                std::remove(tmp_file.c_str());
+                return false;
+            }
+            if (std::rename(tmp_file.c_str(), file.c_str()) != 0) {
+                std::remove(file.c_str());
+                if (std::rename(tmp_file.c_str(), file.c_str()) != 0) {
+                    std::remove(tmp_file.c_str());
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        void release() {
+#if EVAL_IMAGE_USE_MMAP
+            if (mapped != nullptr) {
+                munmap(mapped, mapped_size);
+            }
+#endif
+            mapped = nullptr;
+            mapped_size = 0;
+        }
+
+        inline bool is_attached() const {
+            return mapped != nullptr;
+        }
+
+        inline size_t size() const {
+            return mapped_size;
+        }
+};
+
+Eval_image eval_image;
+
+/*
+    @brief load evaluation tables through the evaluation image
+
+    Without eval_image_file, tables are loaded into the process as before.
+    With it, the image is attached if it is up to date,
+    otherwise tables are loaded, baked into the image and the image is attached.
+
+    @param sources              source evaluation files
+    @param storage              tables in the process
+    @param set_tables           sets table pointers used by evaluation
+    @param load                 loads source files into storage
+    @param show_log             show log?
+    @return loaded?
+*/
+template <typename Set_tables, typename Load>
+bool eval_image_load(const std::vector<std::string> &sources, const std::vector<Eval_image_segment> &storage, Set_tables set_tables, Load load, bool show_log) {
+    set_tables(storage); // never leave pointers into an image being released
+    eval_image.release();
+    std::vector<Eval_image_segment> segments = storage;
+    if (!eval_image_file.empty() && eval_image.attach(eval_image_file, sources, segments)) {
+        set_tables(segments);
+        if (show_log) {
+            std::cerr << "evaluation image " << eval_image_file << " attached " << eval_image.size() << " bytes" << std::endl;
+        }
+        return true;
+    }
+    if (!load()) {
+        return false;
+    }
+    if (!eval_image_file.empty()) {
+        if (Eval_image::bake(eval_image_file, sources, storage) && eval_image.attach(eval_image_file, sources, segments)) {
+            set_tables(segments);
+            if (show_log) {
+                std::cerr << "evaluation image " << eval_image_file << " baked " << eval_image.size() << " bytes" << std::endl;
+            }
+        } else {
+            std::cerr << "[ERROR] can't use evaluation image " << eval_image_file << ", evaluation is loaded in this process" << std::endl;
+        }
+    }
+    return true;
+}
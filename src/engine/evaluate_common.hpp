@@ -180,6 +180,9 @@ struct Coord_to_feature {
 
 #if USE_SIMD
 union Eval_features {
+#if USE_AVX512_EVAL
+    __m512i f512[N_SIMD_EVAL_FEATURES / 2];
+#endif
     __m256i f256[N_SIMD_EVAL_FEATURES];
     __m128i f128[N_SIMD_EVAL_FEATURES * 2];
 };
@@ -278,4 +281,150 @@ inline std::vector<int16_t> load_unzip_egev2(const char* file, bool show_log, bo
     }
     free(unzipped_params);
     return res;
-}
\ No newline at end of file
+}
+
+constexpr size_t EGEV2_STREAM_BUFFER_SIZE = 1 << 15; // compressed parameters read at once (64 KB)
+
+/*
+    @brief destination of decoded egev2 parameters
+
+    @param dst                  destination array
+    @param n                    number of parameters
+    @param clamp                clamp to [-max_value, max_value] and add max_value?
+*/
+struct Egev2_segment {
+    int16_t *dst;
+    size_t n;
+    bool clamp;
+};
+
+/*
+    @brief store decoded parameters with clamp and offset
+
+    @param dst                  destination
+    @param src                  decoded parameters
+    @param n                    number of parameters
+    @param max_value            clamp range and offset
+    @return number of clamped parameters
+*/
+inline uint64_t egev2_store_clamped(int16_t *dst, const int16_t *src, size_t n, int16_t max_value) {
+    uint64_t n_clamped = 0;
+    size_t i = 0;
+#if USE_SIMD
+    const __m256i lo = _mm256_set1_epi16(-max_value);
+    const __m256i hi = _mm256_set1_epi16(max_value);
+    for (; i + 16 <= n; i += 16) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(src + i));
+        __m256i out_of_range = _mm256_or_si256(_mm256_cmpgt_epi16(lo, v), _mm256_cmpgt_epi16(v, hi));
+        n_clamped += pop_count_uint((uint32_t)_mm256_movemask_epi8(out_of_range)) / 2;
+        v = _mm256_add_epi16(_mm256_min_epi16(_mm256_max_epi16(v, lo), hi), hi);
+        _mm256_storeu_si256((__m256i*)(dst + i), v);
+    }
+#endif
+    for (; i < n; ++i) {
+        int16_t v = src[i];
+        n_clamped += (v < -max_value) | (v > max_value);
+        dst[i] = std::min(std::max(v, (int16_t)-max_value), max_value) + max_value;
+    }
+    return n_clamped;
+}
+
+/*
+    @brief load egev2 evaluation file directly into parameter arrays
+
+    Compressed parameters are read in blocks and the zero runs are expanded straight into
+    the destination, so the whole unzipped parameter set is never held in another buffer.
+
+    @param file                 egev2 file
+    @param segments             destinations in the order of the file
+    @param max_value            clamp range and offset for segments with clamp
+    @param show_log             show log?
+    @return loaded?
+*/
+inline bool load_unzip_egev2_stream(const char* file, const std::vector<Egev2_segment> &segments, int16_t max_value, bool show_log) {
+    FILE* fp;
+    if (!file_open(&fp, file, "rb")) {
+        std::cerr << "[ERROR] [FATAL] can't open eval " << file << std::endl;
+        return false;
+    }
+    int n_zipped_params = -1;
+    if (fread(&n_zipped_params, 4, 1, fp) < 1 || n_zipped_params < 0) {
+        std::cerr << "[ERROR] [FATAL] evaluation file broken" << std::endl;
+        fclose(fp);
+        return false;
+    }
+    if (show_log) {
+        std::cerr << n_zipped_params << " elems found in " << file << std::endl;
+    }
+    std::vector<int16_t> buf(EGEV2_STREAM_BUFFER_SIZE);
+    size_t seg_idx = 0, seg_pos = 0;
+    size_t n_pending_zeros = 0;
+    uint64_t n_unzipped = 0, n_clamped = 0;
+    bool overflow = false;
+    int n_remaining = n_zipped_params;
+    while ((n_remaining > 0 || n_pending_zeros) && !overflow) {
+        size_t n_read = 0;
+        if (n_remaining > 0) {
+            n_read = std::min<size_t>(n_remaining, EGEV2_STREAM_BUFFER_SIZE);
+            if (fread(buf.data(), 2, n_read, fp) < n_read) {
+                std::cerr << "[ERROR] [FATAL] evaluation file broken" << std::endl;
+                fclose(fp);
+                return false;
+            }
+            n_remaining -= n_read;
+        }
+        size_t i = 0;
+        while (i < n_read || n_pending_zeros) {
+            while (seg_idx < segments.size() && seg_pos == segments[seg_idx].n) {
+                ++seg_idx;
+                seg_pos = 0;
+            }
+            if (seg_idx == segments.size()) {
+                overflow = true;
+                break;
+            }
+            const Egev2_segment &seg = segments[seg_idx];
+            size_t room = seg.n - seg_pos;
+            if (n_pending_zeros) { // a zero run may continue to the next segment
+                size_t n = std::min(n_pending_zeros, room);
+                std::fill(seg.dst + seg_pos, seg.dst + seg_pos + n, seg.clamp ? max_value : 0);
+                seg_pos += n;
+                n_pending_zeros -= n;
+                n_unzipped += n;
+            } else if (buf[i] >= N_ZEROS_PLUS) {
+                n_pending_zeros = buf[i] - N_ZEROS_PLUS;
+                ++i;
+            } else {
+                size_t j = i;
+                size_t limit = i + std::min(room, n_read - i);
+                while (j < limit && buf[j] < N_ZEROS_PLUS) {
+                    ++j;
+                }
+                if (seg.clamp) {
+                    n_clamped += egev2_store_clamped(seg.dst + seg_pos, &buf[i], j - i, max_value);
+                } else {
+                    std::memcpy(seg.dst + seg_pos, &buf[i], sizeof(int16_t) * (j - i));
+                }
+                seg_pos += j - i;
+                n_unzipped += j - i;
+                i = j;
+            }
+        }
+    }
+    fclose(fp);
+    while (seg_idx < segments.size() && seg_pos == segments[seg_idx].n) {
+        ++seg_idx;
+        seg_pos = 0;
+    }
+    if (overflow || seg_idx != segments.size()) {
+        std::cerr << "[ERROR] [FATAL] evaluation file broken (" << (overflow ? "too many" : "too few") << " parameters)" << std::endl;
+        return false;
+    }
+    if (n_clamped) {
+        std::cerr << "[ERROR] " << n_clamped << " evaluation values out of range were clamped. you can ignore this error." << std::endl;
+    }
+    if (show_log) {
+        std::cerr << n_unzipped << " elems found in unzipped " << file << std::endl;
+    }
+    return true;
+}
@@ -18,6 +18,7 @@
 #include "search.hpp"
 #include "util.hpp"
 #include "evaluate_common.hpp"
+#include "eval_image.hpp"
 
 constexpr int EVAL_IDX_START_MOVE_ORDERING_END = 32;
 constexpr int EVAL_IDX_END_MOVE_ORDERING_END = 48;
@@ -289,9 +290,30 @@ constexpr int feature_to_pattern[N_PATTERN_FEATURES] = {
 /*
     @brief evaluation parameters
 */
-int16_t pattern_arr[2][N_PHASES][N_PATTERNS][MAX_EVALUATE_IDX];
-int16_t eval_num_arr[N_PHASES][MAX_STONE_NUM];
-int16_t pattern_arr_move_ordering_end[2][N_PATTERNS][MAX_EVALUATE_IDX];
+int16_t pattern_arr_storage[2][N_PHASES][N_PATTERNS][MAX_EVALUATE_IDX];
+int16_t eval_num_arr_storage[N_PHASES][MAX_STONE_NUM];
+int16_t pattern_arr_move_ordering_end_storage[2][N_PATTERNS][MAX_EVALUATE_IDX];
+// tables used by evaluation (storage above, or read-only evaluation image)
+int16_t (*pattern_arr)[N_PHASES][N_PATTERNS][MAX_EVALUATE_IDX] = pattern_arr_storage;
+int16_t (*eval_num_arr)[MAX_STONE_NUM] = eval_num_arr_storage;
+int16_t (*pattern_arr_move_ordering_end)[N_PATTERNS][MAX_EVALUATE_IDX] = pattern_arr_move_ordering_end_storage;
+
+/*
+    @brief tables stored in evaluation image
+*/
+inline std::vector<Eval_image_segment> eval_image_storage() {
+    return {
+        {&pattern_arr_storage[0][0][0][0], 2 * N_PHASES * N_PATTERNS * MAX_EVALUATE_IDX}, 
+        {&eval_num_arr_storage[0][0], N_PHASES * MAX_STONE_NUM}, 
+        {&pattern_arr_move_ordering_end_storage[0][0][0], 2 * N_PATTERNS * MAX_EVALUATE_IDX}
+    };
+}
+
+inline void eval_image_set_tables(const std::vector<Eval_image_segment> &segments) {
+    pattern_arr = (int16_t(*)[N_PHASES][N_PATTERNS][MAX_EVALUATE_IDX])segments[0].ptr;
+    eval_num_arr = (int16_t(*)[MAX_STONE_NUM])segments[1].ptr;
+    pattern_arr_move_ordering_end = (int16_t(*)[N_PATTERNS][MAX_EVALUATE_IDX])segments[2].ptr;
+}
 
 /*
     @brief used for unzipping the evaluation function
@@ -338,19 +360,15 @@ inline bool load_eval_file(const char* file, bool show_log) {
     if (show_log) {
         std::cerr << "evaluation file " << file << std::endl;
     }
-    bool failed = false;
-    std::vector<int16_t> unzipped_params = load_unzip_egev2(file, show_log, &failed);
-    if (failed) {
-        return false;
-    }
-    size_t param_idx = 0;
+    std::vector<Egev2_segment> segments;
     for (int phase_idx = 0; phase_idx < N_PHASES; ++phase_idx) {
         for (int pattern_idx = 0; pattern_idx < N_PATTERNS; ++pattern_idx) {
-            std::memcpy(pattern_arr[0][phase_idx][pattern_idx], &unzipped_params[param_idx], sizeof(short) * pow3[pattern_sizes[pattern_idx]]);
-            param_idx += pow3[pattern_sizes[pattern_idx]];
+            segments.push_back({pattern_arr[0][phase_idx][pattern_idx], pow3[pattern_sizes[pattern_idx]], false});
         }
-        std::memcpy(eval_num_arr[phase_idx], &unzipped_params[param_idx], sizeof(short) * MAX_STONE_NUM);
-        param_idx += MAX_STONE_NUM;
+        segments.push_back({eval_num_arr[phase_idx], MAX_STONE_NUM, false});
+    }
+    if (!load_unzip_egev2_stream(file, segments, 0, show_log)) {
+        return false;
     }
     if (thread_pool.size() >= 2) {
         std::future<void> tasks[N_PHASES * N_PATTERNS];
@@ -411,14 +429,20 @@ inline bool load_eval_move_ordering_end_file(const char* file, bool show_log) {
     @return evaluation function conpletely initialized?
 */
 inline bool evaluate_init(const char* file, const char* mo_end_nws_file, bool show_log) {
-    bool eval_loaded = load_eval_file(file, show_log);
-    if (!eval_loaded) {
-        std::cerr << "[ERROR] [FATAL] evaluation file not loaded" << std::endl;
-        return false;
-    }
-    bool eval_move_ordering_end_nws_loaded = load_eval_move_ordering_end_file(mo_end_nws_file, show_log);
-    if (!eval_move_ordering_end_nws_loaded) {
-        std::cerr << "[ERROR] [FATAL] evaluation file for move ordering end not loaded" << std::endl;
+    bool loaded = eval_image_load({file, mo_end_nws_file}, eval_image_storage(), eval_image_set_tables, [&]() {
+        bool eval_loaded = load_eval_file(file, show_log);
+        if (!eval_loaded) {
+            std::cerr << "[ERROR] [FATAL] evaluation file not loaded" << std::endl;
+            return false;
+        }
+        bool eval_move_ordering_end_nws_loaded = load_eval_move_ordering_end_file(mo_end_nws_file, show_log);
+        if (!eval_move_ordering_end_nws_loaded) {
+            std::cerr << "[ERROR] [FATAL] evaluation file for move ordering end not loaded" << std::endl;
+            return false;
+        }
+        return true;
+    }, show_log);
+    if (!loaded) {
         return false;
     }
     if (show_log) {
@@ -329,27 +329,22 @@ void init_pattern_arr_rev(int phase_idx, int pattern_idx, int siz) {
 inline bool load_eval_file(const char* file, bool show_log) {
     if (show_log)
         std::cerr << "evaluation file " << file << std::endl;
-    bool failed = false;
-    std::vector<int16_t> unzipped_params = load_unzip_egev2(file, show_log, &failed);
-    if (failed) {
-        return false;
-    }
     constexpr int pattern_sizes[N_PATTERNS] = {
         8, 8, 8, 9,
         5, 6, 7, 10, 
         10, 10, 10, 10, 
         10, 10, 10, 10
     };
-    size_t param_idx = 0;
+    std::vector<Egev2_segment> segments;
     for (int phase_idx = 0; phase_idx < N_PHASES; ++phase_idx) {
         for (int pattern_idx = 0; pattern_idx < N_PATTERNS; ++pattern_idx) {
-            std::memcpy(pattern_arr[0][phase_idx][pattern_idx], &unzipped_params[param_idx], sizeof(short) * pow3[pattern_sizes[pattern_idx]]);
-            param_idx += pow3[pattern_sizes[pattern_idx]];
+            segments.push_back({pattern_arr[0][phase_idx][pattern_idx], pow3[pattern_sizes[pattern_idx]], false});
         }
-        std::memcpy(eval_num_arr[phase_idx], &unzipped_params[param_idx], sizeof(short) * MAX_STONE_NUM);
-        param_idx += MAX_STONE_NUM;
-        std::memcpy(eval_sur0_sur1_arr[phase_idx], &unzipped_params[param_idx], sizeof(short) * MAX_SURROUND * MAX_SURROUND);
-        param_idx += MAX_SURROUND * MAX_SURROUND;
+        segments.push_back({eval_num_arr[phase_idx], MAX_STONE_NUM, false});
+        segments.push_back({&eval_sur0_sur1_arr[phase_idx][0][0], MAX_SURROUND * MAX_SURROUND, false});
+    }
+    if (!load_unzip_egev2_stream(file, segments, 0, show_log)) {
+        return false;
     }
     if (thread_pool.size() >= 2) {
         std::future<void> tasks[N_PHASES * N_PATTERNS];
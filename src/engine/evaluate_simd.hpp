@@ -23,6 +23,7 @@
 #include "search.hpp"
 #include "util.hpp"
 #include "evaluate_common.hpp"
+#include "eval_image.hpp"
 
 /*
     @brief evaluation pattern definition for SIMD
@@ -230,47 +231,55 @@ __m256i coord_to_feature_simd[HW2][N_SIMD_EVAL_FEATURES];
 __m256i eval_move_unflipped_16bit[N_16BIT][N_SIMD_EVAL_FEATURE_GROUP][N_SIMD_EVAL_FEATURES];
 __m256i eval_simd_offsets_simple[N_SIMD_EVAL_FEATURES_SIMPLE]; // 16bit * 16 * N
 __m256i eval_simd_offsets_comp[N_SIMD_EVAL_FEATURES_COMP * 2]; // 32bit * 8 * N
+#if USE_AVX512_EVAL
+__m512i eval_lower_mask_512;
+__m512i eval_simd_offsets_512[N_SIMD_EVAL_FEATURES]; // 32bit * 16 * N, index offset of each f256
+#endif
 
 
 /*
     @brief evaluation parameters
 */
 // normal
-int16_t pattern_arr[N_PHASES][N_PATTERN_PARAMS];
-int16_t eval_num_arr[N_PHASES][MAX_STONE_NUM];
+int16_t pattern_arr_storage[N_PHASES][N_PATTERN_PARAMS];
+int16_t eval_num_arr_storage[N_PHASES][MAX_STONE_NUM];
 // move ordering evaluation
-int16_t pattern_move_ordering_end_arr[N_PATTERN_PARAMS_MO_END];
+int16_t pattern_move_ordering_end_arr_storage[N_PATTERN_PARAMS_MO_END];
+// tables used by evaluation (storage above, or read-only evaluation image)
+int16_t (*pattern_arr)[N_PATTERN_PARAMS] = pattern_arr_storage;
+int16_t (*eval_num_arr)[MAX_STONE_NUM] = eval_num_arr_storage;
+int16_t *pattern_move_ordering_end_arr = pattern_move_ordering_end_arr_storage;
+
+/*
+    @brief tables stored in evaluation image
+*/
+inline std::vector<Eval_image_segment> eval_image_storage() {
+    return {
+        {&pattern_arr_storage[0][0], N_PHASES * N_PATTERN_PARAMS}, 
+        {&eval_num_arr_storage[0][0], N_PHASES * MAX_STONE_NUM}, 
+        {pattern_move_ordering_end_arr_storage, N_PATTERN_PARAMS_MO_END}
+    };
+}
+
+inline void eval_image_set_tables(const std::vector<Eval_image_segment> &segments) {
+    pattern_arr = (int16_t(*)[N_PATTERN_PARAMS])segments[0].ptr;
+    eval_num_arr = (int16_t(*)[MAX_STONE_NUM])segments[1].ptr;
+    pattern_move_ordering_end_arr = segments[2].ptr;
+}
 
 inline bool load_eval_file(const char* file, bool show_log) {
     if (show_log) {
         std::cerr << "evaluation file " << file << std::endl;
     }
-    bool failed = false;
-    std::vector<int16_t> unzipped_params = load_unzip_egev2(file, show_log, &failed);
-    if (failed) {
-        return false;
-    }
-    size_t param_idx = 0;
+    std::vector<Egev2_segment> segments;
     for (int phase_idx = 0; phase_idx < N_PHASES; ++phase_idx) {
         pattern_arr[phase_idx][0] = 0; // memory bound
-        std::memcpy(pattern_arr[phase_idx] + 1, &unzipped_params[param_idx], sizeof(short) * N_PATTERN_PARAMS_RAW);
-        param_idx += N_PATTERN_PARAMS_RAW;
-        std::memcpy(eval_num_arr[phase_idx], &unzipped_params[param_idx], sizeof(short) * MAX_STONE_NUM);
-        param_idx += MAX_STONE_NUM;
+        segments.push_back({pattern_arr[phase_idx] + 1, N_PATTERN_PARAMS_RAW, true});
+        segments.push_back({eval_num_arr[phase_idx], MAX_STONE_NUM, false});
     }
-    // check max value
-    for (int phase_idx = 0; phase_idx < N_PHASES; ++phase_idx) {
-        for (int i = 1; i < N_PATTERN_PARAMS; ++i) {
-            if (pattern_arr[phase_idx][i] < -SIMD_EVAL_MAX_VALUE) {
-                std::cerr << "[ERROR] evaluation value too low. you can ignore this error. phase " << phase_idx << " index " << i << " found " << pattern_arr[phase_idx][i] << std::endl;
-                pattern_arr[phase_idx][i] = -SIMD_EVAL_MAX_VALUE;
-            }
-            if (pattern_arr[phase_idx][i] > SIMD_EVAL_MAX_VALUE) {
-                std::cerr << "[ERROR] evaluation value too high. you can ignore this error. phase " << phase_idx << " index " << i << " found " << pattern_arr[phase_idx][i] << std::endl;
-                pattern_arr[phase_idx][i] = SIMD_EVAL_MAX_VALUE;
-            }
-            pattern_arr[phase_idx][i] += SIMD_EVAL_MAX_VALUE;
-        }
+    // pattern values are clamped to [-SIMD_EVAL_MAX_VALUE, SIMD_EVAL_MAX_VALUE] and offset to be non-negative while decoding
+    if (!load_unzip_egev2_stream(file, segments, SIMD_EVAL_MAX_VALUE, show_log)) {
+        return false;
     }
     return true;
 }
@@ -409,6 +418,16 @@ inline void pre_calculate_eval_constant() {
         }
         eval_lower_mask = _mm256_set1_epi32(0x0000FFFF);
     }
+#if USE_AVX512_EVAL
+    { // AVX-512 calc_pattern initialization
+        eval_simd_offsets_512[0] = _mm512_setzero_si512();
+        eval_simd_offsets_512[1] = _mm512_inserti64x4(_mm512_set1_epi32(PATTERN6_START_IDX), _mm256_set1_epi32(PATTERN4_START_IDX), 1);
+        for (int i = 0; i < N_SIMD_EVAL_FEATURES_COMP; ++i) {
+            eval_simd_offsets_512[2 + i] = _mm512_inserti64x4(_mm512_castsi256_si512(eval_simd_offsets_comp[i * 2]), eval_simd_offsets_comp[i * 2 + 1], 1);
+        }
+        eval_lower_mask_512 = _mm512_set1_epi32(0x0000FFFF);
+    }
+#endif
 }
 
 /*
@@ -419,14 +438,20 @@ inline void pre_calculate_eval_constant() {
     @return evaluation function conpletely initialized?
 */
 inline bool evaluate_init(const char* file, const char* mo_end_nws_file, bool show_log) {
-    bool eval_loaded = load_eval_file(file, show_log);
-    if (!eval_loaded) {
-        std::cerr << "[ERROR] [FATAL] evaluation file not loaded" << std::endl;
-        return false;
-    }
-    bool eval_move_ordering_end_nws_loaded = load_eval_move_ordering_end_file(mo_end_nws_file, show_log);
-    if (!eval_move_ordering_end_nws_loaded) {
-        std::cerr << "[ERROR] [FATAL] evaluation file for move ordering end not loaded" << std::endl;
+    bool loaded = eval_image_load({file, mo_end_nws_file}, eval_image_storage(), eval_image_set_tables, [&]() {
+        bool eval_loaded = load_eval_file(file, show_log);
+        if (!eval_loaded) {
+            std::cerr << "[ERROR] [FATAL] evaluation file not loaded" << std::endl;
+            return false;
+        }
+        bool eval_move_ordering_end_nws_loaded = load_eval_move_ordering_end_file(mo_end_nws_file, show_log);
+        if (!eval_move_ordering_end_nws_loaded) {
+            std::cerr << "[ERROR] [FATAL] evaluation file for move ordering end not loaded" << std::endl;
+            return false;
+        }
+        return true;
+    }, show_log);
+    if (!loaded) {
         return false;
     }
     pre_calculate_eval_constant();
@@ -471,7 +496,7 @@ inline __m256i gather_eval(const int *start_addr, const __m256i idx8) {
     // return _mm256_and_si256(_mm256_i32gather_epi32(start_addr, idx8, 2), eval_lower_mask);
 }
 
-inline int calc_pattern(const int phase_idx, Eval_features *features) {
+inline int calc_pattern_avx2(const int phase_idx, Eval_features *features) {
     const int *start_addr0 = (int*)pattern_arr[phase_idx];
     const int *start_addr4 = (int*)&pattern_arr[phase_idx][PATTERN4_START_IDX];
     const int *start_addr6 = (int*)&pattern_arr[phase_idx][PATTERN6_START_IDX];
@@ -489,7 +514,7 @@ inline int calc_pattern(const int phase_idx, Eval_features *features) {
     return _mm_cvtsi128_si32(res128) + _mm_extract_epi32(res128, 1) - SIMD_EVAL_MAX_VALUE * N_PATTERN_FEATURES;
 }
 
-inline int calc_pattern_move_ordering_end(Eval_features *features) {
+inline int calc_pattern_move_ordering_end_avx2(Eval_features *features) {
     const int *start_addr = (int*)(pattern_move_ordering_end_arr - SHIFT_EVAL_MO_END);
     __m256i res256 =                  gather_eval(start_addr, calc_idx8_comp(features->f128[4], 0));        // corner+block cross
     res256 = _mm256_add_epi32(res256, gather_eval(start_addr, calc_idx8_comp(features->f128[5], 1)));       // edge+2X triangle
@@ -499,6 +524,52 @@ inline int calc_pattern_move_ordering_end(Eval_features *features) {
     return _mm_cvtsi128_si32(res128) + _mm_extract_epi32(res128, 1) - SIMD_EVAL_MAX_VALUE_MO_END * N_PATTERN_FEATURES_MO_END;
 }
 
+#if USE_AVX512_EVAL
+inline __m512i gather_eval_avx512(const int *start_addr, const __m256i feature, const int i) {
+    __m512i idx16 = _mm512_add_epi32(_mm512_cvtepu16_epi32(feature), eval_simd_offsets_512[i]);
+    return _mm512_i32gather_epi32(idx16, start_addr, 2); // same HACK as gather_eval
+}
+
+/*
+    @brief pattern evaluation with AVX-512
+
+    16 features per gather, PATTERN4_START_IDX / PATTERN6_START_IDX are added to the index
+    so that all gathers share one base address
+*/
+inline int calc_pattern_avx512(const int phase_idx, Eval_features *features) {
+    const int *start_addr0 = (int*)pattern_arr[phase_idx];
+    __m512i res512 =                  gather_eval_avx512(start_addr0, features->f256[0], 0);    // hv3 d7+2Corner hv2 d6+2C+X
+    res512 = _mm512_add_epi32(res512, gather_eval_avx512(start_addr0, features->f256[1], 1));   // d5+2X d8+wC hv4 corner9
+    res512 = _mm512_add_epi32(res512, gather_eval_avx512(start_addr0, features->f256[2], 2));   // corner+block cross edge+2X triangle
+    res512 = _mm512_add_epi32(res512, gather_eval_avx512(start_addr0, features->f256[3], 3));   // fish kite edge+2Y narrow_triangle
+    res512 = _mm512_and_si512(res512, eval_lower_mask_512);
+    return _mm512_reduce_add_epi32(res512) - SIMD_EVAL_MAX_VALUE * N_PATTERN_FEATURES;
+}
+
+inline int calc_pattern_move_ordering_end_avx512(Eval_features *features) {
+    const int *start_addr = (int*)(pattern_move_ordering_end_arr - SHIFT_EVAL_MO_END);
+    __m512i res512 = gather_eval_avx512(start_addr, features->f256[2], 2);                      // corner+block cross edge+2X triangle
+    res512 = _mm512_and_si512(res512, eval_lower_mask_512);
+    return _mm512_reduce_add_epi32(res512) - SIMD_EVAL_MAX_VALUE_MO_END * N_PATTERN_FEATURES_MO_END;
+}
+#endif
+
+inline int calc_pattern(const int phase_idx, Eval_features *features) {
+#if USE_AVX512_EVAL && USE_AVX512_CALC_PATTERN
+    return calc_pattern_avx512(phase_idx, features);
+#else
+    return calc_pattern_avx2(phase_idx, features);
+#endif
+}
+
+inline int calc_pattern_move_ordering_end(Eval_features *features) {
+#if USE_AVX512_EVAL && USE_AVX512_CALC_PATTERN
+    return calc_pattern_move_ordering_end_avx512(features);
+#else
+    return calc_pattern_move_ordering_end_avx2(features);
+#endif
+}
+
 inline void calc_eval_features(Board *board, Eval_search *eval);
 
 /*
@@ -591,7 +662,7 @@ inline void calc_eval_features(Board *board, Eval_search *eval) {
     @param eval                 evaluation features
     @param flip                 flip information
 */
-inline void eval_move(Eval_search *eval, const Flip *flip, const Board *board) {
+inline void eval_move_avx2(Eval_search *eval, const Flip *flip, const Board *board) {
     const uint16_t *flipped_group = (uint16_t*)&(flip->flip);
     const uint16_t *player_group = (uint16_t*)&(board->player);
     const uint16_t *opponent_group = (uint16_t*)&(board->opponent);
@@ -641,7 +712,7 @@ inline void eval_undo(Eval_search *eval) {
 
     @param eval                 evaluation features
 */
-inline void eval_pass(Eval_search *eval, const Board *board) {
+inline void eval_pass_avx2(Eval_search *eval, const Board *board) {
     const uint16_t *player_group = (uint16_t*)&(board->player);
     const uint16_t *opponent_group = (uint16_t*)&(board->opponent);
     __m256i f0, f1, f2, f3;
@@ -668,6 +739,73 @@ inline void eval_pass(Eval_search *eval, const Board *board) {
 
 
 
+#if USE_AVX512_EVAL
+inline __m512i eval_load_avx512(const __m256i *f) { // 2 contiguous __m256i
+    return _mm512_loadu_si512((const void*)f);
+}
+
+/*
+    @brief move evaluation features with AVX-512
+
+    same as eval_move_avx2, 2 feature vectors are updated with one instruction
+*/
+inline void eval_move_avx512(Eval_search *eval, const Flip *flip, const Board *board) {
+    const uint16_t *flipped_group = (uint16_t*)&(flip->flip);
+    const uint16_t *player_group = (uint16_t*)&(board->player);
+    const uint16_t *opponent_group = (uint16_t*)&(board->opponent);
+    __m512i f01, f23;
+    uint16_t unflipped_p;
+    uint16_t unflipped_o;
+    // put cell 2 -> 1
+    f01 = _mm512_sub_epi16(eval->features[eval->feature_idx].f512[0], eval_load_avx512(&coord_to_feature_simd[flip->pos][0]));
+    f23 = _mm512_sub_epi16(eval->features[eval->feature_idx].f512[1], eval_load_avx512(&coord_to_feature_simd[flip->pos][2]));
+    for (int i = 0; i < N_SIMD_EVAL_FEATURE_GROUP; ++i) {
+        // player discs 0 -> 1
+        unflipped_p = ~flipped_group[i] & player_group[i];
+        f01 = _mm512_add_epi16(f01, eval_load_avx512(&eval_move_unflipped_16bit[unflipped_p][i][0]));
+        f23 = _mm512_add_epi16(f23, eval_load_avx512(&eval_move_unflipped_16bit[unflipped_p][i][2]));
+        // opponent discs 1 -> 0
+        unflipped_o = ~flipped_group[i] & opponent_group[i];
+        f01 = _mm512_sub_epi16(f01, eval_load_avx512(&eval_move_unflipped_16bit[unflipped_o][i][0]));
+        f23 = _mm512_sub_epi16(f23, eval_load_avx512(&eval_move_unflipped_16bit[unflipped_o][i][2]));
+    }
+    ++eval->feature_idx;
+    eval->features[eval->feature_idx].f512[0] = f01;
+    eval->features[eval->feature_idx].f512[1] = f23;
+}
+
+inline void eval_pass_avx512(Eval_search *eval, const Board *board) {
+    const uint16_t *player_group = (uint16_t*)&(board->player);
+    const uint16_t *opponent_group = (uint16_t*)&(board->opponent);
+    __m512i f01 = eval->features[eval->feature_idx].f512[0];
+    __m512i f23 = eval->features[eval->feature_idx].f512[1];
+    for (int i = 0; i < N_SIMD_EVAL_FEATURE_GROUP; ++i) {
+        f01 = _mm512_add_epi16(f01, eval_load_avx512(&eval_move_unflipped_16bit[player_group[i]][i][0]));
+        f23 = _mm512_add_epi16(f23, eval_load_avx512(&eval_move_unflipped_16bit[player_group[i]][i][2]));
+        f01 = _mm512_sub_epi16(f01, eval_load_avx512(&eval_move_unflipped_16bit[opponent_group[i]][i][0]));
+        f23 = _mm512_sub_epi16(f23, eval_load_avx512(&eval_move_unflipped_16bit[opponent_group[i]][i][2]));
+    }
+    eval->features[eval->feature_idx].f512[0] = f01;
+    eval->features[eval->feature_idx].f512[1] = f23;
+}
+#endif
+
+inline void eval_move(Eval_search *eval, const Flip *flip, const Board *board) {
+#if USE_AVX512_EVAL
+    eval_move_avx512(eval, flip, board);
+#else
+    eval_move_avx2(eval, flip, board);
+#endif
+}
+
+inline void eval_pass(Eval_search *eval, const Board *board) {
+#if USE_AVX512_EVAL
+    eval_pass_avx512(eval, board);
+#else
+    eval_pass_avx2(eval, board);
+#endif
+}
+
 // only corner+block cross edge+2X triangle
 inline void eval_move_endsearch(Eval_search *eval, const Flip *flip, const Board *board) {
     const uint16_t *flipped_group = (uint16_t*)&(flip->flip);
@@ -243,34 +243,16 @@ int16_t pattern_move_ordering_end_arr[N_PATTERN_PARAMS_MO_END];
 inline bool load_eval_file(const char* file, bool show_log) {
     if (show_log)
         std::cerr << "evaluation file " << file << std::endl;
-    bool failed = false;
-    std::vector<int16_t> unzipped_params = load_unzip_egev2(file, show_log, &failed);
-    if (failed) {
-        return false;
-    }
-    size_t param_idx = 0;
+    std::vector<Egev2_segment> segments;
     for (int phase_idx = 0; phase_idx < N_PHASES; ++phase_idx) {
         pattern_arr[phase_idx][0] = 0; // memory bound
-        std::memcpy(pattern_arr[phase_idx] + 1, &unzipped_params[param_idx], sizeof(short) * N_PATTERN_PARAMS_RAW);
-        param_idx += N_PATTERN_PARAMS_RAW;
-        std::memcpy(eval_num_arr[phase_idx], &unzipped_params[param_idx], sizeof(short) * MAX_STONE_NUM);
-        param_idx += MAX_STONE_NUM;
-        std::memcpy(eval_sur0_sur1_arr[phase_idx], &unzipped_params[param_idx], sizeof(short) * MAX_SURROUND * MAX_SURROUND);
-        param_idx += MAX_SURROUND * MAX_SURROUND;
+        segments.push_back({pattern_arr[phase_idx] + 1, N_PATTERN_PARAMS_RAW, true});
+        segments.push_back({eval_num_arr[phase_idx], MAX_STONE_NUM, false});
+        segments.push_back({&eval_sur0_sur1_arr[phase_idx][0][0], MAX_SURROUND * MAX_SURROUND, false});
     }
-    // check max value
-    for (int phase_idx = 0; phase_idx < N_PHASES; ++phase_idx) {
-        for (int i = 1; i < N_PATTERN_PARAMS; ++i) {
-            if (pattern_arr[phase_idx][i] < -SIMD_EVAL_MAX_VALUE) {
-                std::cerr << "[ERROR] evaluation value too low. you can ignore this error. phase " << phase_idx << " index " << i << " found " << pattern_arr[phase_idx][i] << std::endl;
-                pattern_arr[phase_idx][i] = -SIMD_EVAL_MAX_VALUE;
-            }
-            if (pattern_arr[phase_idx][i] > SIMD_EVAL_MAX_VALUE) {
-                std::cerr << "[ERROR] evaluation value too high. you can ignore this error. phase " << phase_idx << " index " << i << " found " << pattern_arr[phase_idx][i] << std::endl;
-                pattern_arr[phase_idx][i] = SIMD_EVAL_MAX_VALUE;
-            }
-            pattern_arr[phase_idx][i] += SIMD_EVAL_MAX_VALUE;
-        }
+    // pattern values are clamped to [-SIMD_EVAL_MAX_VALUE, SIMD_EVAL_MAX_VALUE] and offset to be non-negative while decoding
+    if (!load_unzip_egev2_stream(file, segments, SIMD_EVAL_MAX_VALUE, show_log)) {
+        return false;
     }
     return true;
 }
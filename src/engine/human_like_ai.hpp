@@ -61,7 +61,7 @@ int nega_alpha_human_like(Search *search, int alpha, int beta, int depth, bool s
         return v;
     }
     int canput = pop_count_ull(legal);
-    std::vector<Flip_value> move_list(canput);
+    Move_list move_list(canput);
     int idx = 0;
     for (uint_fast8_t cell = first_bit(&legal); legal; cell = next_bit(&legal)) {
         calc_flip(&move_list[idx].flip, &search->board, cell);
@@ -106,7 +106,7 @@ Search_result nega_alpha_human_like_root(Search *search, int alpha, int beta, in
         return res;
     }
     int canput = pop_count_ull(legal);
-    std::vector<Flip_value> move_list(canput);
+    Move_list move_list(canput);
     int idx = 0;
     for (uint_fast8_t cell = first_bit(&legal); legal; cell = next_bit(&legal)) {
         calc_flip(&move_list[idx].flip, &search->board, cell);
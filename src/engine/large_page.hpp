@@ -0,0 +1,230 @@
+/*
+    Egaroucid Project
+
+    @file large_page.hpp
+        Large page allocation for big tables
+    @date 2021-2025
+    @author Takuto Yamana
+    @license GPL-3.0 license
+*/
+
+#pragma once
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#if _WIN64 || _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
+/*
+    @brief page types
+
+    LARGE_PAGE_NONE             normal pages
+    LARGE_PAGE_TRANSPARENT      normal allocation advised to be backed by transparent huge pages (Linux)
+    LARGE_PAGE_2MB              explicit 2 MB pages (MAP_HUGETLB / MEM_LARGE_PAGES)
+    LARGE_PAGE_1GB              explicit 1 GB pages (MAP_HUGETLB)
+*/
+#define LARGE_PAGE_NONE 0
+#define LARGE_PAGE_TRANSPARENT 1
+#define LARGE_PAGE_2MB 2
+#define LARGE_PAGE_1GB 3
+#define N_LARGE_PAGE_TYPES 4
+
+const std::string large_page_names[N_LARGE_PAGE_TYPES] = {"normal", "2MB transparent huge page", "2MB huge page", "1GB huge page"};
+
+constexpr size_t LARGE_PAGE_2MB_SIZE = 2ULL * 1024 * 1024;
+constexpr size_t LARGE_PAGE_1GB_SIZE = 1024ULL * 1024 * 1024;
+
+#if !(_WIN64 || _WIN32) && defined(MAP_HUGETLB)
+    #ifndef MAP_HUGE_SHIFT
+        #define MAP_HUGE_SHIFT 26
+    #endif
+    #ifndef MAP_HUGE_2MB
+        #define MAP_HUGE_2MB (21 << MAP_HUGE_SHIFT)
+    #endif
+    #ifndef MAP_HUGE_1GB
+        #define MAP_HUGE_1GB (30 << MAP_HUGE_SHIFT)
+    #endif
+#endif
+
+inline size_t large_page_round_up(size_t size, size_t unit) {
+    return (size + unit - 1) / unit * unit;
+}
+
+/*
+    @brief transparent huge pages are enabled on this system?
+
+    @return enabled? (false if not Linux or set to never)
+*/
+inline bool large_page_transparent_available() {
+#if defined(__linux__)
+    std::ifstream ifs("/sys/kernel/mm/transparent_hugepage/enabled");
+    std::string line;
+    if (!std::getline(ifs, line)) {
+        return false;
+    }
+    return line.find("[never]") == std::string::npos;
+#else
+    return false;
+#endif
+}
+
+/*
+    @brief advise a range to be backed by transparent huge pages
+
+    @param ptr                  start of memory
+    @param size                 size in bytes
+    @return advised?
+*/
+inline bool large_page_advise(void *ptr, size_t size) {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    uintptr_t s = large_page_round_up((uintptr_t)ptr, LARGE_PAGE_2MB_SIZE);
+    uintptr_t e = ((uintptr_t)ptr + size) / LARGE_PAGE_2MB_SIZE * LARGE_PAGE_2MB_SIZE;
+    if (s >= e || !large_page_transparent_available()) {
+        return false;
+    }
+    return madvise((void*)s, e - s, MADV_HUGEPAGE) == 0;
+#else
+    return false;
+#endif
+}
+
+/*
+    @brief memory backed by the largest page size available
+
+    Tries 1 GB pages (if large enough), 2 MB pages, transparent huge pages and normal pages in this order.
+    Memory is aligned to at least 4 KB.
+*/
+class Large_page_memory {
+    private:
+        void *ptr;
+        size_t size;
+        int page_type;
+
+    public:
+        Large_page_memory()
+            : ptr(nullptr), size(0), page_type(LARGE_PAGE_NONE) {}
+
+        ~Large_page_memory() {
+            release();
+        }
+
+        Large_page_memory(const Large_page_memory&) = delete;
+        Large_page_memory& operator=(const Large_page_memory&) = delete;
+
+        /*
+            @brief allocate memory
+
+            @param bytes                size in bytes
+            @param use_large_page       try large pages?
+            @return pointer to memory (nullptr if failed)
+        */
+        void* allocate(size_t bytes, bool use_large_page) {
+            release();
+            if (bytes == 0) {
+                return nullptr;
+            }
+#if _WIN64 || _WIN32
+            if (use_large_page) {
+                size_t large_page_size = GetLargePageMinimum();
+                if (large_page_size) {
+                    size_t n_bytes = large_page_round_up(bytes, large_page_size);
+                    void *p = VirtualAlloc(nullptr, n_bytes, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE); // needs SeLockMemoryPrivilege
+                    if (p != nullptr) {
+                        ptr = p;
+                        size = n_bytes;
+                        page_type = LARGE_PAGE_2MB;
+                        return ptr;
+                    }
+                }
+            }
+            void *p = VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+            if (p == nullptr) {
+                return nullptr;
+            }
+            ptr = p;
+            size = bytes;
+            page_type = LARGE_PAGE_NONE;
+            return ptr;
+#else
+    #if defined(MAP_HUGETLB)
+            if (use_large_page) {
+                if (bytes >= LARGE_PAGE_1GB_SIZE && try_map(large_page_round_up(bytes, LARGE_PAGE_1GB_SIZE), MAP_HUGETLB | MAP_HUGE_1GB)) {
+                    page_type = LARGE_PAGE_1GB;
+                    return ptr;
+                }
+                if (bytes >= LARGE_PAGE_2MB_SIZE && try_map(large_page_round_up(bytes, LARGE_PAGE_2MB_SIZE), MAP_HUGETLB | MAP_HUGE_2MB)) {
+                    page_type = LARGE_PAGE_2MB;
+                    return ptr;
+                }
+            }
+    #endif
+            // normal pages, aligned to 2 MB so that transparent huge pages cover the whole table
+            size_t n_bytes = large_page_round_up(bytes, LARGE_PAGE_2MB_SIZE);
+            if (!try_map(n_bytes + LARGE_PAGE_2MB_SIZE, 0)) {
+                return nullptr;
+            }
+            uintptr_t s = large_page_round_up((uintptr_t)ptr, LARGE_PAGE_2MB_SIZE);
+            uintptr_t e = s + n_bytes;
+            if (s > (uintptr_t)ptr) {
+                munmap(ptr, s - (uintptr_t)ptr);
+            }
+            if ((uintptr_t)ptr + size > e) {
+                munmap((void*)e, (uintptr_t)ptr + size - e);
+            }
+            ptr = (void*)s;
+            size = n_bytes;
+            page_type = LARGE_PAGE_NONE;
+            if (use_large_page && large_page_advise(ptr, size)) {
+                page_type = LARGE_PAGE_TRANSPARENT;
+            }
+            return ptr;
+#endif
+        }
+
+        /*
+            @brief free memory
+        */
+        void release() {
+            if (ptr != nullptr) {
+#if _WIN64 || _WIN32
+                VirtualFree(ptr, 0, MEM_RELEASE);
+#else
+                munmap(ptr, size);
+#endif
+            }
+            ptr = nullptr;
+            size = 0;
+            page_type = LARGE_PAGE_NONE;
+        }
+
+        inline void* get() const {
+            return ptr;
+        }
+
+        inline int get_page_type() const {
+            return page_type;
+        }
+
+    private:
+#if !(_WIN64 || _WIN32)
+        bool try_map(size_t n_bytes, int flags) {
+            void *p = mmap(nullptr, n_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | flags, -1, 0);
+            if (p == MAP_FAILED) {
+                return false;
+            }
+            ptr = p;
+            size = n_bytes;
+            return true;
+        }
+#endif
+};
@@ -0,0 +1,267 @@
+/*
+    Egaroucid Project
+
+    @file lazy_smp.hpp
+        Lazy SMP helper searches sharing the transposition table
+    @date 2021-2025
+    @author Takuto Yamana
+    @license GPL-3.0 license
+*/
+
+#pragma once
+#include <iostream>
+#include <vector>
+#include <future>
+#include <mutex>
+#include <memory>
+#include <algorithm>
+#include "setting.hpp"
+#include "common.hpp"
+#include "board.hpp"
+#include "search.hpp"
+#include "midsearch.hpp"
+#include "thread_pool.hpp"
+#include "transposition_table.hpp"
+
+#if USE_LAZY_SMP
+constexpr int LAZY_SMP_DEFAULT_MAX_MAIN_DEPTH = 10;
+constexpr int LAZY_SMP_N_HELPER_DECAY_DEPTH = 6; // number of helpers decreases 10% per depth over it
+
+/*
+    @brief Lazy SMP schedule
+
+    helper i (0-indexed) searches main depth + min(ctz(i + 1), max_depth_offset),
+    helpers of the same depth use higher MPC levels one by one
+    (from one level over the main search at the main depth, from deeper_mpc_level deeper)
+
+    @param max_main_depth       helpers work while the main iteration depth is at most this (0: no helper)
+    @param max_depth_offset     maximum depth offset of helpers
+    @param deeper_mpc_level     first MPC level of helpers deeper than the main search
+    @param use_time_limit       use helpers also in time-limited search
+*/
+struct Lazy_SMP_schedule {
+    int max_main_depth;
+    int max_depth_offset;
+    int deeper_mpc_level;
+    bool use_time_limit;
+};
+
+Lazy_SMP_schedule lazy_smp_schedule = {LAZY_SMP_DEFAULT_MAX_MAIN_DEPTH, HW2, MPC_74_LEVEL, false};
+
+struct Lazy_SMP_task {
+    uint_fast8_t mpc_level;
+    int depth;
+    bool is_end_search;
+
+    bool operator==(const Lazy_SMP_task &another) const {
+        return mpc_level == another.mpc_level && depth == another.depth && is_end_search == another.is_end_search;
+    }
+};
+
+/*
+    @brief tasks of helpers for an iteration
+
+    @param main_depth           depth of the main iteration
+    @param main_mpc_level       MPC level of the main iteration
+    @param max_depth            number of empties
+    @param n_threads            number of threads for helpers
+    @return tasks
+*/
+std::vector<Lazy_SMP_task> lazy_smp_get_tasks(int main_depth, uint_fast8_t main_mpc_level, int max_depth, int n_threads) {
+    std::vector<Lazy_SMP_task> res;
+    if (main_depth > lazy_smp_schedule.max_main_depth) {
+        return res;
+    }
+    for (int i = 0; i < main_depth - LAZY_SMP_N_HELPER_DECAY_DEPTH; ++i) {
+        n_threads *= 0.9;
+    }
+    uint_fast8_t next_mpc_level[HW2 + 1];
+    for (int depth = 0; depth <= HW2; ++depth) {
+        next_mpc_level[depth] = lazy_smp_schedule.deeper_mpc_level;
+    }
+    next_mpc_level[main_depth] = main_mpc_level + 1;
+    for (int i = 0; i < n_threads; ++i) {
+        int depth = std::min(max_depth, main_depth + std::min((int)ctz_uint32(i + 1), lazy_smp_schedule.max_depth_offset));
+        if (next_mpc_level[depth] <= MPC_100_LEVEL) {
+            res.emplace_back(Lazy_SMP_task{next_mpc_level[depth], depth, depth == max_depth});
+            ++next_mpc_level[depth];
+        }
+    }
+    return res;
+}
+
+/*
+    @brief statistics of Lazy SMP
+
+    @param n_tasks              helper searches started
+    @param n_completed          helper searches completed
+    @param n_aborted            helper searches stopped (caught up by the main search or finished)
+    @param n_nodes              nodes searched by helpers
+    @param n_root_moves         root moves probed before main iterations
+    @param n_root_moves_ready   root moves already in TT with enough depth at the probe (found mostly by helpers)
+*/
+struct Lazy_SMP_statistics {
+    uint64_t n_tasks;
+    uint64_t n_completed;
+    uint64_t n_aborted;
+    uint64_t n_nodes;
+    uint64_t n_root_moves;
+    uint64_t n_root_moves_ready;
+
+    Lazy_SMP_statistics()
+        : n_tasks(0), n_completed(0), n_aborted(0), n_nodes(0), n_root_moves(0), n_root_moves_ready(0) {}
+
+    void print(uint64_t n_main_nodes, std::ostream &out) const {
+        uint64_t n_all_nodes = n_main_nodes + n_nodes;
+        out << "lazy smp tasks " << n_tasks << " completed " << n_completed << " aborted " << n_aborted;
+        out << " helper nodes " << n_nodes << " (" << (n_all_nodes ? 100.0 * n_nodes / n_all_nodes : 0.0) << "%)";
+        out << " root moves ready in TT " << n_root_moves_ready << "/" << n_root_moves << std::endl;
+    }
+};
+
+/*
+    @brief Lazy SMP helpers of a root search
+
+    Each helper searches one task in the thread pool.
+    When the tasks of the next iteration are set, a running helper keeps searching
+    if its task is still in the schedule, so deep helper searches survive main iterations.
+    Helpers whose task left the schedule are stopped. Completed tasks are not searched again.
+*/
+class Lazy_SMP {
+    private:
+        struct Helper {
+            Lazy_SMP_task task;
+            Search search;
+            bool searching;
+            bool running;
+            std::future<void> future;
+        };
+
+        Board board;
+        int alpha;
+        int beta;
+        uint64_t use_legal;
+        std::mutex mtx;
+        std::vector<std::unique_ptr<Helper>> helpers;
+        std::vector<Lazy_SMP_task> done_tasks;
+        Lazy_SMP_statistics statistics;
+
+    public:
+        Lazy_SMP(const Board *board_, int alpha_, int beta_, uint64_t use_legal_)
+            : board(board_->copy()), alpha(alpha_), beta(beta_), use_legal(use_legal_) {}
+
+        ~Lazy_SMP() {
+            finish();
+        }
+
+        /*
+            @brief set tasks for the next iteration
+
+            @param tasks                new schedule (empty: stop all helpers)
+        */
+        void set_tasks(std::vector<Lazy_SMP_task> tasks) {
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                for (std::unique_ptr<Helper> &helper: helpers) {
+                    if (helper->running) {
+                        auto it = std::find(tasks.begin(), tasks.end(), helper->task);
+                        if (it != tasks.end()) {
+                            tasks.erase(it);
+                        } else {
+                            helper->searching = false;
+                        }
+                    }
+                }
+                for (const Lazy_SMP_task &task: done_tasks) {
+                    auto it = std::find(tasks.begin(), tasks.end(), task);
+                    if (it != tasks.end()) {
+                        tasks.erase(it);
+                    }
+                }
+            }
+            for (const Lazy_SMP_task &task: tasks) {
+                std::unique_ptr<Helper> helper = std::make_unique<Helper>();
+                helper->task = task;
+                helper->search = Search{&board, task.mpc_level, false, true};
+                helper->searching = true;
+                helper->running = true;
+                Helper *helper_ptr = helper.get();
+                bool pushed;
+                helper->future = thread_pool.push(&pushed, [this, helper_ptr]() {
+                    nega_scout(&helper_ptr->search, alpha, beta, helper_ptr->task.depth, false, use_legal, helper_ptr->task.is_end_search, &helper_ptr->searching);
+                    std::lock_guard<std::mutex> lock(mtx);
+                    helper_ptr->running = false;
+                    if (helper_ptr->searching) {
+                        ++statistics.n_completed;
+                        done_tasks.emplace_back(helper_ptr->task);
+                    } else {
+                        ++statistics.n_aborted;
+                    }
+                    statistics.n_nodes += helper_ptr->search.n_nodes;
+                });
+                if (!pushed) {
+                    break;
+                }
+                std::lock_guard<std::mutex> lock(mtx);
+                ++statistics.n_tasks;
+                helpers.emplace_back(std::move(helper));
+            }
+        }
+
+        /*
+            @brief count root moves already searched at the depth of the next main iteration
+
+            @param depth                depth of the main iteration
+            @param mpc_level            MPC level of the main iteration
+        */
+        void check_tt(int depth, uint_fast8_t mpc_level) {
+            if (depth <= 1) {
+                return;
+            }
+            uint64_t n_root_moves = 0, n_root_moves_ready = 0;
+            Flip flip;
+            uint64_t legal = use_legal;
+            for (uint_fast8_t cell = first_bit(&legal); legal; cell = next_bit(&legal)) {
+                calc_flip(&flip, &board, cell);
+                Board child = board.move_copy(&flip);
+                Search child_search(&child, mpc_level, false, false);
+                ++n_root_moves;
+                n_root_moves_ready += transposition_table.has_node(&child_search, child.hash(), depth - 1);
+            }
+            std::lock_guard<std::mutex> lock(mtx);
+            statistics.n_root_moves += n_root_moves;
+            statistics.n_root_moves_ready += n_root_moves_ready;
+        }
+
+        /*
+            @brief stop all helpers and wait for them
+        */
+        void finish() {
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                for (std::unique_ptr<Helper> &helper: helpers) {
+                    helper->searching = false;
+                }
+            }
+            for (std::unique_ptr<Helper> &helper: helpers) {
+                if (helper->future.valid()) {
+                    helper->future.get();
+                }
+            }
+        }
+
+        int get_n_running() {
+            std::lock_guard<std::mutex> lock(mtx);
+            int res = 0;
+            for (const std::unique_ptr<Helper> &helper: helpers) {
+                res += helper->running;
+            }
+            return res;
+        }
+
+        Lazy_SMP_statistics get_statistics() {
+            std::lock_guard<std::mutex> lock(mtx);
+            return statistics;
+        }
+};
+#endif
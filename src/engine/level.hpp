@@ -11,6 +11,7 @@
 #pragma once
 #include <iostream>
 #include <cmath>
+#include <algorithm>
 #include "common.hpp"
 
 /*
@@ -9,6 +9,10 @@
 */
 
 #pragma once
+#include <vector>
+#include <atomic>
+#include <future>
+#include <algorithm>
 #include "ai.hpp"
 
 constexpr int MAX_LOCAL_STRATEGY_LEVEL = 25;
@@ -91,87 +95,73 @@ void print_local_strategy(const double arr[]) {
     }
 }
 
+/*
+    @brief calculate local strategy
+
+    Each disc is flipped and the perturbed board is searched again.
+    The perturbed searches of a level are done in parallel (one search per thread, sharing the transposition table),
+    and cells that changed the value most in the previous level are searched first.
+    res[] is updated as each search finishes, and done_level is set when all cells of the level are searched.
+
+    @param board                board to analyze
+    @param max_level            maximum level (exclusive)
+    @param res                  result (positive: good for black)
+    @param player               player to move
+    @param searching            flag for terminating
+    @param done_level           the last completed level
+    @param show_log             show log?
+*/
 void calc_local_strategy_player(Board board, int max_level, double res[], int player, bool *searching, int *done_level, bool show_log) {
     for (int cell = 0; cell < HW2; ++cell) {
         res[cell] = 0.0;
     }
-    uint64_t legal = board.get_legal();
+    const double sgn = player == WHITE ? -1.0 : 1.0;
+    uint64_t discs = board.player | board.opponent;
+    std::vector<int> cells;
+    for (uint_fast8_t cell = first_bit(&discs); discs; cell = next_bit(&discs)) {
+        cells.emplace_back(cell);
+    }
     double value_diffs[HW2];
+    for (int cell = 0; cell < HW2; ++cell) {
+        value_diffs[cell] = 0;
+    }
     for (int level = 1; level < max_level && *searching && global_searching; ++level) {
         Search_result complete_result = ai_searching(board, level, true, 0, true, false, searching);
         if (show_log) {
             std::cerr << "result " << complete_result.value << std::endl;
         }
-        for (int cell = 0; cell < HW2; ++cell) {
-            value_diffs[cell] = 0;
-        }
-        for (int cell = 0; cell < HW2 && *searching && global_searching; ++cell) {
-            uint64_t bit = 1ULL << cell;
-            if (board.player & bit) { // player
-                // player -> opponent
-                board.player ^= bit;
-                board.opponent ^= bit;
-                    Search_result result = ai_searching(board, level, true, 0, true, false, searching);
-                    //value_diffs[cell] = -(result.value - complete_result.value + local_strategy_cell_weight[board.n_discs()][cell_type[cell]]);
-                    value_diffs[cell] = -(result.value - complete_result.value);
-                    //std::cerr << idx_to_coord(cell) << " " << complete_result.value << " " << result.value << " " << local_strategy_cell_weight[board.n_discs()][cell_type[cell]] << " " << value_diffs[cell] << std::endl;
-                board.player ^= bit;
-                board.opponent ^= bit;
-            } else if (board.opponent & bit) {
-                // opponent -> player
-                board.player ^= bit;
-                board.opponent ^= bit;
-                    Search_result result = ai_searching(board, level, true, 0, true, false, searching);
-                    //value_diffs[cell] = -(result.value - complete_result.value - local_strategy_cell_weight[board.n_discs()][cell_type[cell]]);
-                    value_diffs[cell] = -(result.value - complete_result.value);
-                    //std::cerr << idx_to_coord(cell) << " " << complete_result.value << " " << result.value << " " << local_strategy_cell_weight[board.n_discs()][cell_type[cell]] << " " << value_diffs[cell] << std::endl;
-                    /*
-                    uint64_t legal_diff = ~board.get_legal() & legal;
-                    for (uint_fast8_t nolegal_cell = first_bit(&legal_diff); legal_diff; nolegal_cell = next_bit(&legal_diff)) {
-                        value_diffs[nolegal_cell] = value_diffs[cell]; // nolegal_cell belongs to actual legal
-                    }
-                    */
-                board.player ^= bit;
-                board.opponent ^= bit;
-            } else { // empty
-                /*
-                if ((board.player | board.opponent) & bit_around[cell]) { // next to disc
-                    if ((legal & bit) == 0) { // can't put there
-                        board.player ^= bit; // put there (no flip)
-                        board.pass(); // opponent's move
-                            int alpha = -SCORE_MAX; 
-                            int beta = -complete_result.value; // just want to know better move than complete_result
-                            Search_result result = ai_window_searching(board, alpha, beta, level, true, 0, true, false, searching);
-                            int result_value = -result.value; // need -1 because it's opponent move
-                            value_diffs[cell] = -std::max(0, result_value - complete_result.value); // need max because if the move is bad, just don't put it
-                        board.pass();
-                        board.player ^= bit;
-                    }
+        // most important cells first (stable, so cell order on level 1)
+        std::stable_sort(cells.begin(), cells.end(), [&](int a, int b) { return std::abs(value_diffs[a]) > std::abs(value_diffs[b]); });
+        std::atomic<int> next_idx(0);
+        auto worker = [&]() {
+            int i;
+            while ((i = next_idx.fetch_add(1)) < (int)cells.size() && *searching && global_searching) {
+                uint64_t bit = 1ULL << cells[i];
+                // player <-> opponent
+                Board perturbed_board = board;
+                perturbed_board.player ^= bit;
+                perturbed_board.opponent ^= bit;
+                Search_result result = ai_searching(perturbed_board, level, true, 0, false, false, searching);
+                if (*searching && global_searching) {
+                    value_diffs[cells[i]] = -(result.value - complete_result.value);
+                    res[cells[i]] = sgn * std::tanh(0.2 * value_diffs[cells[i]]); // 10 discs ~ 1.0
                 }
-                */
             }
+        };
+        std::vector<std::future<void>> tasks;
+        for (int i = 0; i < thread_pool.size(); ++i) {
+            bool pushed;
+            tasks.emplace_back(thread_pool.push(&pushed, worker));
+            if (!pushed) {
+                tasks.pop_back();
+                break;
+            }
+        }
+        worker();
+        for (std::future<void> &task: tasks) {
+            task.get();
         }
         if (*searching && global_searching) {
-            /*
-            if (show_log) {
-                std::cerr << "value_diffs" << std::endl;
-                print_local_strategy(value_diffs);
-                std::cerr << std::endl;
-            }
-            */
-            for (int cell = 0; cell < HW2; ++cell) {
-                res[cell] = std::tanh(0.2 * value_diffs[cell]); // 10 discs ~ 1.0
-            }
-            if (player == WHITE) {
-                for (int cell = 0; cell < HW2; ++cell) {
-                    res[cell] *= -1;
-                }
-            }
-            /*
-            if (show_log) {
-                print_local_strategy(res);
-            }
-            */
             *done_level = level;
             if (show_log) {
                 std::cerr << "local strategy level " << level << std::endl;
@@ -46,7 +46,7 @@ inline int aspiration_search(Search *search, int alpha, int beta, int predicted_
 inline int nega_alpha_eval1(Search *search, int alpha, int beta, const bool skipped) {
     ++search->n_nodes;
 #if USE_SEARCH_STATISTICS
-    ++search->n_nodes_discs[search->n_discs];
+    search_statistics_count_node(search->n_discs);
 #endif
     int v = -SCORE_INF;
     uint64_t legal = search->board.get_legal();
@@ -121,7 +121,7 @@ int nega_scout(Search *search, int alpha, int beta, const int depth, const bool
     int first_alpha = alpha;
     int first_beta = beta;
 #if USE_SEARCH_STATISTICS
-    ++search->n_nodes_discs[search->n_discs];
+    search_statistics_count_node(search->n_discs);
 #endif
 #if USE_END_SC
     if (is_end_search) {
@@ -150,9 +150,16 @@ int nega_scout(Search *search, int alpha, int beta, const int depth, const bool
     if (transposition_cutoff(search, hash_code, depth, &alpha, &beta, &v, moves)) {
         return v;
     }
+#if USE_SOLVED_STORE
+    if (is_end_search && depth >= SOLVED_STORE_MIN_LOOKUP_DEPTH && solved_store.has_records()) {
+        if (solved_store.get_value(&search->board, &v)) {
+            return v;
+        }
+    }
+#endif
     int best_move = MOVE_UNDEFINED;
     const int canput = pop_count_ull(legal);
-    std::vector<Flip_value> move_list(canput);
+    Move_list move_list(canput);
     int idx = 0;
     int tt_moves_idx0 = -1;
     for (uint_fast8_t cell = first_bit(&legal); legal; cell = next_bit(&legal)) {
@@ -265,6 +272,11 @@ int nega_scout(Search *search, int alpha, int beta, const int depth, const bool
     }
     if (*searching && global_searching) {
         transposition_table.reg(search, hash_code, depth, first_alpha, first_beta, v, best_move);
+#if USE_SOLVED_STORE
+        if (is_end_search && search->mpc_level == MPC_100_LEVEL && depth >= SOLVED_STORE_MIN_DEPTH && first_alpha < v && v < first_beta && solved_store.is_open()) {
+            solved_store.add(&search->board, v, best_move);
+        }
+#endif
     }
     return v;
 }
@@ -328,7 +340,7 @@ inline int aspiration_search(Search *search, int alpha, int beta, int predicted_
 std::pair<int, int> first_nega_scout_legal(Search *search, int alpha, int beta, const int depth, const bool is_end_search, const std::vector<Clog_result> clogs, uint64_t legal, uint64_t strt, bool *searching) {
     ++search->n_nodes;
 #if USE_SEARCH_STATISTICS
-    ++search->n_nodes_discs[search->n_discs];
+    search_statistics_count_node(search->n_discs);
 #endif
     int g, v = -SCORE_INF, first_alpha = alpha;
     if (legal == 0ULL) {
@@ -353,7 +365,7 @@ std::pair<int, int> first_nega_scout_legal(Search *search, int alpha, int beta,
     if (alpha < beta && legal) {
         int pv_idx = 1;
         const int canput = pop_count_ull(legal);
-        std::vector<Flip_value> move_list(canput);
+        Move_list move_list(canput);
         int idx = 0;
         for (uint_fast8_t cell = first_bit(&legal); legal; cell = next_bit(&legal)) {
             calc_flip(&move_list[idx].flip, &search->board, cell);
@@ -443,10 +455,110 @@ std::pair<int, int> first_nega_scout(Search *search, int alpha, int beta, const
     return first_nega_scout_legal(search, alpha, beta, depth, is_end_search, clogs, search->board.get_legal(), strt, searching);
 }
 
+/*
+    @brief insert a root move into multi-PV list
+
+    @param pvs                  list of (value, move) sorted by value (descending)
+    @param n_pv                 max size of the list
+    @param value                value of the move
+    @param move                 move
+*/
+inline void multi_pv_insert(std::vector<std::pair<int, int>> &pvs, int n_pv, int value, int move) {
+    auto itr = pvs.begin();
+    while (itr != pvs.end() && itr->first >= value) {
+        ++itr;
+    }
+    pvs.insert(itr, std::make_pair(value, move));
+    if ((int)pvs.size() > n_pv) {
+        pvs.pop_back();
+    }
+}
+
+/*
+    @brief Multi-PV version of first_nega_scout_legal
+
+    Keeps n_pv best moves. Once n_pv moves are found, other moves are searched with
+    a null window on the n_pv-th best value (shared lower bound) and re-searched only
+    if they enter the list. Values are exact if they are in (alpha, beta).
+
+    @param search               search information
+    @param alpha                alpha value
+    @param beta                 beta value
+    @param depth                remaining depth
+    @param is_end_search        search till the end?
+    @param clogs                previously found clog moves
+    @param legal                moves to search
+    @param n_pv                 number of best moves to keep
+    @return list of (value, move) sorted by value (descending)
+*/
+std::vector<std::pair<int, int>> first_nega_scout_multi_pv(Search *search, int alpha, int beta, const int depth, const bool is_end_search, const std::vector<Clog_result> clogs, uint64_t legal, int n_pv, uint64_t strt, bool *searching) {
+    ++search->n_nodes;
+#if USE_SEARCH_STATISTICS
+    search_statistics_count_node(search->n_discs);
+#endif
+    std::vector<std::pair<int, int>> pvs;
+    if (legal == 0ULL) {
+        return pvs;
+    }
+    int g, first_alpha = alpha;
+    bool is_all_legal = legal == search->board.get_legal();
+    for (const Clog_result clog: clogs) {
+        if (legal & (1ULL << clog.pos)) {
+            multi_pv_insert(pvs, n_pv, clog.val, clog.pos);
+            legal &= ~(1ULL << clog.pos);
+        }
+    }
+    uint32_t hash_code = search->board.hash();
+    if (legal) {
+        const int canput = pop_count_ull(legal);
+        Move_list move_list(canput);
+        int idx = 0;
+        for (uint_fast8_t cell = first_bit(&legal); legal; cell = next_bit(&legal)) {
+            calc_flip(&move_list[idx].flip, &search->board, cell);
+            ++idx;
+        }
+        int pv_alpha = alpha;
+        if ((int)pvs.size() == n_pv) {
+            pv_alpha = std::max(alpha, pvs.back().first);
+        }
+        uint_fast8_t moves[N_TRANSPOSITION_MOVES] = {MOVE_UNDEFINED, MOVE_UNDEFINED};
+        transposition_table.get_moves_any_level(&search->board, hash_code, moves);
+        move_list_evaluate(search, move_list, moves, depth, pv_alpha, beta, searching);
+        for (int move_idx = 0; move_idx < canput && *searching && pv_alpha < beta; ++move_idx) {
+            swap_next_best_move(move_list, move_idx, canput);
+            bool is_full = (int)pvs.size() == n_pv;
+            if (move_list[move_idx].flip.flip == search->board.opponent) {
+                g = SCORE_MAX;
+            } else {
+                search->move(&move_list[move_idx].flip);
+                if (!is_full) {
+                    g = -nega_scout(search, -beta, -alpha, depth - 1, false, move_list[move_idx].n_legal, is_end_search, searching);
+                } else {
+                    g = -nega_alpha_ordering_nws(search, -pv_alpha - 1, depth - 1, false, move_list[move_idx].n_legal, is_end_search, searching);
+                    if (pv_alpha < g && g < beta) {
+                        g = -nega_scout(search, -beta, -pv_alpha, depth - 1, false, move_list[move_idx].n_legal, is_end_search, searching);
+                    }
+                }
+                search->undo(&move_list[move_idx].flip);
+            }
+            if (!is_full || pv_alpha < g) {
+                multi_pv_insert(pvs, n_pv, g, move_list[move_idx].flip.pos);
+                if ((int)pvs.size() == n_pv) {
+                    pv_alpha = std::max(alpha, pvs.back().first);
+                }
+            }
+        }
+    }
+    if (*searching && global_searching && is_all_legal && pvs.size()) {
+        transposition_table.reg(search, hash_code, depth, first_alpha, beta, pvs[0].first, pvs[0].second);
+    }
+    return pvs;
+}
+
 Analyze_result first_nega_scout_analyze(Search *search, int alpha, int beta, const int depth, const bool is_end_search, const std::vector<Clog_result> clogs, int clog_depth, uint_fast8_t played_move, uint64_t strt, bool *searching) {
     ++search->n_nodes;
 #if USE_SEARCH_STATISTICS
-    ++search->n_nodes_discs[search->n_discs];
+    search_statistics_count_node(search->n_discs);
 #endif
     Analyze_result res;
     res.played_move = played_move;
@@ -490,7 +602,7 @@ Analyze_result first_nega_scout_analyze(Search *search, int alpha, int beta, con
     if (alpha < beta && legal) {
         int pv_idx = 1;
         const int canput = pop_count_ull(legal);
-        std::vector<Flip_value> move_list(canput);
+        Move_list move_list(canput);
         int idx = 0;
         for (uint_fast8_t cell = first_bit(&legal); legal; cell = next_bit(&legal)) {
             calc_flip(&move_list[idx].flip, &search->board, cell);
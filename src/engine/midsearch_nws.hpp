@@ -24,11 +24,13 @@
 #include "move_ordering.hpp"
 #include "multi_probcut.hpp"
 #include "thread_pool.hpp"
+#include "parallel.hpp"
 #include "ybwc.hpp"
 #include "util.hpp"
 #include "stability_cutoff.hpp"
+#include "solved_store.hpp"
 
-inline bool mpc(Search* search, int alpha, int beta, int depth, uint64_t legal, const bool is_end_search, int* v, std::vector<bool*> &searchings);
+inline bool mpc(Search* search, int alpha, int beta, int depth, uint64_t legal, const bool is_end_search, int* v, const Search_flag_chain *searchings);
 inline bool mpc(Search* search, int alpha, int beta, const int depth, uint64_t legal, const bool is_end_search, int* v, const bool* searching);
 
 /*
@@ -44,7 +46,7 @@ inline bool mpc(Search* search, int alpha, int beta, const int depth, uint64_t l
 inline int nega_alpha_eval1_nws(Search *search, int alpha, const bool skipped) {
     ++search->n_nodes;
 #if USE_SEARCH_STATISTICS
-    ++search->n_nodes_discs[search->n_discs];
+    search_statistics_count_node(search->n_discs);
 #endif
     int v = -SCORE_INF;
     uint64_t legal = search->board.get_legal();
@@ -104,7 +106,7 @@ int nega_alpha_ordering_nws_simple(Search *search, int alpha, const int depth, c
     }
     ++search->n_nodes;
 #if USE_SEARCH_STATISTICS
-    ++search->n_nodes_discs[search->n_discs];
+    search_statistics_count_node(search->n_discs);
 #endif
     if (legal == LEGAL_UNDEFINED) {
         legal = search->board.get_legal();
@@ -135,7 +137,7 @@ int nega_alpha_ordering_nws_simple(Search *search, int alpha, const int depth, c
     int best_move = MOVE_UNDEFINED;
     int g;
     const int canput = pop_count_ull(legal);
-    std::vector<Flip_value> move_list(canput);
+    Move_list move_list(canput);
     int idx = 0;
     int tt_moves_idx0 = -1;
     int tt_moves_idx1 = -1;
@@ -213,19 +215,6 @@ int nega_alpha_ordering_nws_simple(Search *search, int alpha, const int depth, c
 }
 
 
-inline bool is_searching(std::vector<bool*> &searchings) {
-    int idx = 0;
-    for (bool* &elem: searchings) {
-        if (!(*elem)) {
-            return false;
-        }
-        ++idx;
-    }
-    return true;
-}
-
-
-
 /*
     @brief Get a value with given depth with Nega-Alpha algorithm (NWS)
 
@@ -241,7 +230,7 @@ inline bool is_searching(std::vector<bool*> &searchings) {
     @param searching            flag for terminating this search
     @return the value
 */
-int nega_alpha_ordering_nws(Search *search, int alpha, const int depth, const bool skipped, uint64_t legal, const bool is_end_search, std::vector<bool*> &searchings) {
+int nega_alpha_ordering_nws(Search *search, int alpha, const int depth, const bool skipped, uint64_t legal, const bool is_end_search, const Search_flag_chain *searchings) {
     if (!global_searching || !is_searching(searchings)) {
         return SCORE_UNDEFINED;
     }
@@ -251,13 +240,13 @@ int nega_alpha_ordering_nws(Search *search, int alpha, const int depth, const bo
         }
     } else {
         if (depth <= MID_SIMPLE_DEPTH) {
-            return nega_alpha_ordering_nws_simple(search, alpha, depth, skipped, legal, searchings.back());
+            return nega_alpha_ordering_nws_simple(search, alpha, depth, skipped, legal, searchings->searching);
         }
     }
     int v = -SCORE_INF;
     ++search->n_nodes;
 #if USE_SEARCH_STATISTICS
-    ++search->n_nodes_discs[search->n_discs];
+    search_statistics_count_node(search->n_discs);
 #endif
     if (legal == LEGAL_UNDEFINED) {
         legal = search->board.get_legal();
@@ -277,6 +266,13 @@ int nega_alpha_ordering_nws(Search *search, int alpha, const int depth, const bo
     if (transposition_cutoff_nws(search, hash_code, depth, alpha, &v, moves)) {
         return v;
     }
+#if USE_SOLVED_STORE
+    if (is_end_search && depth >= SOLVED_STORE_MIN_LOOKUP_DEPTH && solved_store.has_records()) {
+        if (solved_store.get_value(&search->board, &v)) {
+            return v;
+        }
+    }
+#endif
 #if USE_MID_MPC
     if (search->mpc_level < MPC_100_LEVEL && depth >= USE_MPC_MIN_DEPTH) {
         if (mpc(search, alpha, alpha + 1, depth, legal, is_end_search, &v, searchings)) {
@@ -287,7 +283,7 @@ int nega_alpha_ordering_nws(Search *search, int alpha, const int depth, const bo
     int best_move = MOVE_UNDEFINED;
     int g;
     const int canput = pop_count_ull(legal);
-    std::vector<Flip_value> move_list(canput);
+    Move_list move_list(canput);
     int idx = 0;
     int tt_moves_idx0 = -1;
     for (uint_fast8_t cell = first_bit(&legal); legal; cell = next_bit(&legal)) {
@@ -309,6 +305,9 @@ int nega_alpha_ordering_nws(Search *search, int alpha, const int depth, const bo
     }
 #endif
     bool serial_searched = false;
+#if USE_SEARCH_STATISTICS
+    bool first_move_fail_high = false;
+#endif
     if (tt_moves_idx0 != -1 && move_list[tt_moves_idx0].flip.flip) {
         search->move(&move_list[tt_moves_idx0].flip);
             g = -nega_alpha_ordering_nws(search, -alpha - 1, depth - 1, false, move_list[tt_moves_idx0].n_legal, is_end_search, searchings);
@@ -318,11 +317,14 @@ int nega_alpha_ordering_nws(Search *search, int alpha, const int depth, const bo
             best_move = move_list[tt_moves_idx0].flip.pos;
         }
         serial_searched = true;
+#if USE_SEARCH_STATISTICS
+        first_move_fail_high = alpha < v;
+#endif
         move_list[tt_moves_idx0].flip.flip = 0;
         move_list[tt_moves_idx0].value = -INF;
     }
     if (v <= alpha) {
-        move_list_evaluate_nws(search, move_list, moves, depth, alpha, searchings.back());
+        move_list_evaluate_nws(search, move_list, moves, depth, alpha, searchings->searching);
 #if USE_YBWC_NWS
         if (
             search->use_multi_thread && 
@@ -341,6 +343,9 @@ int nega_alpha_ordering_nws(Search *search, int alpha, const int depth, const bo
                         v = g;
                         best_move = move_list[0].flip.pos;
                     }
+#if USE_SEARCH_STATISTICS
+                    first_move_fail_high = alpha < v;
+#endif
                 }
                 if (v <= alpha) {
                     ybwc_search_young_brothers_nws(search, alpha, &v, &best_move, canput - n_etc_done - 1, hash_code, depth, is_end_search, move_list, searchings);
@@ -362,6 +367,9 @@ int nega_alpha_ordering_nws(Search *search, int alpha, const int depth, const bo
                     v = g;
                     best_move = move_list[move_idx].flip.pos;
                     if (alpha < v) {
+#if USE_SEARCH_STATISTICS
+                        first_move_fail_high = move_idx == 0 && !serial_searched;
+#endif
                         break;
                     }
                 }
@@ -372,11 +380,19 @@ int nega_alpha_ordering_nws(Search *search, int alpha, const int depth, const bo
     }
     if (global_searching && is_searching(searchings)) {
         transposition_table.reg(search, hash_code, depth, alpha, alpha + 1, v, best_move);
+#if USE_SEARCH_STATISTICS
+        if (alpha < v) {
+            search_statistics_count(SEARCH_STATISTICS_FAIL_HIGH, depth);
+            if (first_move_fail_high) {
+                search_statistics_count(SEARCH_STATISTICS_FIRST_MOVE_FAIL_HIGH, depth);
+            }
+        }
+#endif
     }
     return v;
 }
 
 inline int nega_alpha_ordering_nws(Search *search, int alpha, const int depth, const bool skipped, uint64_t legal, const bool is_end_search, bool *searching) {
-    std::vector<bool*> searchings = {searching};
-    return nega_alpha_ordering_nws(search, alpha, depth, skipped, legal, is_end_search, searchings);
+    Search_flag_chain searchings = {searching, nullptr};
+    return nega_alpha_ordering_nws(search, alpha, depth, skipped, legal, is_end_search, &searchings);
 }
\ No newline at end of file
@@ -312,7 +312,7 @@ inline void move_evaluate_end_simple_nws(Search *search, Flip_value *flip_value)
     @param strt                 the first index
     @param siz                  the size of move_list
 */
-inline void swap_next_best_move(std::vector<Flip_value> &move_list, const int strt, const int siz) {
+inline void swap_next_best_move(Move_list &move_list, const int strt, const int siz) {
     if (strt == siz - 1) {
         return;
     }
@@ -354,7 +354,7 @@ inline void swap_next_best_move(Flip_value move_list[], const int strt, const in
 }
 
 /*
-inline bool move_list_tt_check(Search *search, std::vector<Flip_value> &move_list, uint_fast8_t moves[], int depth, int alpha, int beta, int tt_bonus, int *best_move, int *best_score) {
+inline bool move_list_tt_check(Search *search, Move_list &move_list, uint_fast8_t moves[], int depth, int alpha, int beta, int tt_bonus, int *best_move, int *best_score) {
     bool disable_move;
     *best_score = -SCORE_INF;
     for (Flip_value &flip_value: move_list) {
@@ -409,7 +409,7 @@ inline bool move_list_tt_check(Search *search, std::vector<Flip_value> &move_lis
     @param beta                 beta value
     @param searching            flag for terminating this search
 */
-inline bool move_list_evaluate(Search *search, std::vector<Flip_value> &move_list, uint_fast8_t moves[], int depth, int alpha, int beta, bool *searching) {
+inline bool move_list_evaluate(Search *search, Move_list &move_list, uint_fast8_t moves[], int depth, int alpha, int beta, bool *searching) {
     if (move_list.size() == 1) {
         return false;
     }
@@ -447,7 +447,7 @@ inline bool move_list_evaluate(Search *search, std::vector<Flip_value> &move_lis
     @param alpha                alpha value (beta = alpha + 1)
     @param searching            flag for terminating this search
 */
-inline bool move_list_evaluate_nws(Search *search, std::vector<Flip_value> &move_list, uint_fast8_t moves[], int depth, int alpha, bool *searching) {
+inline bool move_list_evaluate_nws(Search *search, Move_list &move_list, uint_fast8_t moves[], int depth, int alpha, bool *searching) {
     if (move_list.size() <= 1) {
         return false;
     }
@@ -474,7 +474,7 @@ inline bool move_list_evaluate_nws(Search *search, std::vector<Flip_value> &move
     @param search               search information
     @param move_list            list of moves
 */
-inline void move_list_evaluate_end_nws(Search *search, std::vector<Flip_value> &move_list, uint_fast8_t moves[], bool *searching) {
+inline void move_list_evaluate_end_nws(Search *search, Move_list &move_list, uint_fast8_t moves[], bool *searching) {
     if (move_list.size() <= 1) {
         return;
     }
@@ -504,7 +504,7 @@ inline void move_list_evaluate_end_simple_nws(Search *search, Flip_value move_li
     }
 }
 
-inline void move_list_sort(std::vector<Flip_value> &move_list) {
+inline void move_list_sort(Move_list &move_list) {
     std::sort(move_list.begin(), move_list.end(), [](Flip_value &a, Flip_value &b) { return a.value > b.value; });
 }
 
@@ -13,6 +13,7 @@
 #include "board.hpp"
 #include "evaluate.hpp"
 #include "search.hpp"
+#include "parallel.hpp"
 #include "midsearch.hpp"
 #include "util.hpp"
 
@@ -55,7 +56,7 @@ inline double probcut_sigma(int n_discs, int depth1, int depth2) {
     return res;
 }
 
-int nega_alpha_ordering_nws(Search *search, int alpha, int depth, bool skipped, uint64_t legal, const bool is_end_search, std::vector<bool*> &searchings);
+int nega_alpha_ordering_nws(Search *search, int alpha, int depth, bool skipped, uint64_t legal, const bool is_end_search, const Search_flag_chain *searchings);
 
 /*
     @brief Multi-ProbCut for normal search
@@ -70,9 +71,12 @@ int nega_alpha_ordering_nws(Search *search, int alpha, int depth, bool skipped,
     @param searching            flag for terminating this search
     @return cutoff occurred?
 */
-inline bool mpc(Search* search, int alpha, int beta, int depth, uint64_t legal, const bool is_end_search, int* v, std::vector<bool*> &searchings) {
+inline bool mpc(Search* search, int alpha, int beta, int depth, uint64_t legal, const bool is_end_search, int* v, const Search_flag_chain *searchings) {
     int search_depth = ((depth / 3) & 0b11111110) + (depth & 1); // depth / 3 + parity
     int d0value = mid_evaluate_diff(search);
+#if USE_SEARCH_STATISTICS
+    search_statistics_count(SEARCH_STATISTICS_MPC_PROBE, depth);
+#endif
     /*
     if (alpha - MPC_ADD_DEPTH_VALUE_THRESHOLD < d0value && d0value < beta + MPC_ADD_DEPTH_VALUE_THRESHOLD && depth >= 20 && search_depth < depth - 2) {
         search_depth += 2; // if value is near [alpha, beta], increase search_depth
@@ -99,6 +103,9 @@ inline bool mpc(Search* search, int alpha, int beta, int depth, uint64_t legal,
             if (is_end_search) {
                 *v += beta & 1;
             }
+#if USE_SEARCH_STATISTICS
+            search_statistics_count(SEARCH_STATISTICS_MPC_CUTOFF, depth);
+#endif
             return true;
         }
         if (d0value <= alpha - error) {
@@ -106,6 +113,9 @@ inline bool mpc(Search* search, int alpha, int beta, int depth, uint64_t legal,
             if (is_end_search) {
                 *v -= alpha & 1;
             }
+#if USE_SEARCH_STATISTICS
+            search_statistics_count(SEARCH_STATISTICS_MPC_CUTOFF, depth);
+#endif
             return true;
         }
     } else {
@@ -130,7 +140,10 @@ inline bool mpc(Search* search, int alpha, int beta, int depth, uint64_t legal,
                         *v += beta & 1;
                     }
                     search->mpc_level = mpc_level;
-                    return true;
+        #if USE_SEARCH_STATISTICS
+            search_statistics_count(SEARCH_STATISTICS_MPC_CUTOFF, depth);
+#endif
+            return true;
                 }
             }
         }
@@ -143,7 +156,10 @@ inline bool mpc(Search* search, int alpha, int beta, int depth, uint64_t legal,
                         *v -= alpha & 1;
                     }
                     search->mpc_level = mpc_level;
-                    return true;
+        #if USE_SEARCH_STATISTICS
+            search_statistics_count(SEARCH_STATISTICS_MPC_CUTOFF, depth);
+#endif
+            return true;
                 }
             }
         }
@@ -153,8 +169,8 @@ inline bool mpc(Search* search, int alpha, int beta, int depth, uint64_t legal,
 }
 
 inline bool mpc(Search* search, int alpha, int beta, int depth, uint64_t legal, const bool is_end_search, int* v, bool *searching) {
-    std::vector<bool*> searchings = {searching};
-    return mpc(search, alpha, beta, depth, legal, is_end_search, v, searchings);
+    Search_flag_chain searchings = {searching, nullptr};
+    return mpc(search, alpha, beta, depth, legal, is_end_search, v, &searchings);
 }
 
 
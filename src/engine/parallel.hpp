@@ -26,4 +26,33 @@ struct Parallel_task {
     uint64_t n_nodes;
     uint_fast8_t cell;
     int move_idx;
-};
\ No newline at end of file
+};
+
+/*
+    @brief Chain of flags for terminating splitted searches
+
+    each YBWC split node adds its own flag pointing to the parent chain,
+    so splitting a task needs no copy of the flags
+
+    @param searching            flag of this node
+    @param parent               chain of the parent nodes (nullptr at the root)
+*/
+struct Search_flag_chain {
+    bool *searching;
+    const Search_flag_chain *parent;
+};
+
+/*
+    @brief Check all flags in the chain
+
+    @param searchings           chain of flags
+    @return true if no flag in the chain is false
+*/
+inline bool is_searching(const Search_flag_chain *searchings) {
+    for (; searchings != nullptr; searchings = searchings->parent) {
+        if (!(*searchings->searching)) {
+            return false;
+        }
+    }
+    return true;
+}
\ No newline at end of file
@@ -9,7 +9,126 @@
 */
 
 #pragma once
+#include <vector>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <new>
+#include <algorithm>
 #include "board.hpp"
+#include "util.hpp"
+#include "thread_pool.hpp"
+
+/*
+    @brief parallel perft settings
+*/
+constexpr int PERFT_N_TASKS_PER_THREAD = 32; // subtrees per thread for load balancing
+constexpr int PERFT_HASH_MIN_DEPTH = 3; // smaller subtrees are cheaper than the symmetry calculation
+constexpr int PERFT_HASH_MIN_LEVEL = 10;
+constexpr int PERFT_HASH_MAX_LEVEL = 30;
+
+/*
+    @brief hash entry of a subtree count
+
+    guarded by a sequence number (seqlock): odd while being written, so a reader
+    that sees an odd or changed sequence treats the entry as not found, and a
+    writer that finds the entry busy skips the store
+*/
+struct Perft_hash_entry {
+    std::atomic<uint64_t> seq;
+    std::atomic<uint64_t> player;
+    std::atomic<uint64_t> opponent;
+    std::atomic<uint64_t> info;
+    std::atomic<uint64_t> count;
+};
+
+/*
+    @brief hash of subtree counts
+
+    symmetric boards have the same count, so only the representative board of the 8 symmetries is stored
+*/
+class Perft_hash {
+    private:
+        std::unique_ptr<Perft_hash_entry[]> table;
+        uint64_t mask;
+        std::atomic<uint64_t> n_hits;
+
+    public:
+        Perft_hash()
+            : mask(0), n_hits(0) {}
+
+        /*
+            @brief allocate 2 ^ hash_level entries
+
+            @param hash_level           log2 of number of entries
+            @return allocated?
+        */
+        bool init(int hash_level) {
+            uint64_t n_entries = 1ULL << hash_level;
+            table.reset(new(std::nothrow) Perft_hash_entry[n_entries]);
+            if (!table) {
+                mask = 0;
+                return false;
+            }
+            mask = n_entries - 1;
+            for (uint64_t i = 0; i < n_entries; ++i) {
+                table[i].seq.store(0, std::memory_order_relaxed);
+                table[i].player.store(0, std::memory_order_relaxed);
+                table[i].opponent.store(0, std::memory_order_relaxed);
+                table[i].info.store(0, std::memory_order_relaxed);
+                table[i].count.store(0, std::memory_order_relaxed);
+            }
+            n_hits = 0;
+            return true;
+        }
+
+        inline bool enabled() const {
+            return (bool)table;
+        }
+
+        inline uint64_t get_n_hits() const {
+            return n_hits.load(std::memory_order_relaxed);
+        }
+
+        inline bool get(const Board *board, uint64_t info, uint64_t *count) {
+            Perft_hash_entry *entry = &table[index(board, info)];
+            uint64_t seq = entry->seq.load(std::memory_order_acquire);
+            if (seq & 1) {
+                return false;
+            }
+            uint64_t p = entry->player.load(std::memory_order_relaxed);
+            uint64_t o = entry->opponent.load(std::memory_order_relaxed);
+            uint64_t i = entry->info.load(std::memory_order_relaxed);
+            uint64_t c = entry->count.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (entry->seq.load(std::memory_order_relaxed) != seq || p != board->player || o != board->opponent || i != info) {
+                return false;
+            }
+            *count = c;
+            n_hits.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        inline void set(const Board *board, uint64_t info, uint64_t count) {
+            Perft_hash_entry *entry = &table[index(board, info)];
+            uint64_t seq = entry->seq.load(std::memory_order_relaxed);
+            if ((seq & 1) || !entry->seq.compare_exchange_strong(seq, seq + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+                return;
+            }
+            std::atomic_thread_fence(std::memory_order_release);
+            entry->player.store(board->player, std::memory_order_relaxed);
+            entry->opponent.store(board->opponent, std::memory_order_relaxed);
+            entry->info.store(info, std::memory_order_relaxed);
+            entry->count.store(count, std::memory_order_relaxed);
+            entry->seq.store(seq + 2, std::memory_order_release);
+        }
+
+    private:
+        inline uint64_t index(const Board *board, uint64_t info) const {
+            uint64_t h = board->player * 0x9E3779B97F4A7C15ULL ^ board->opponent * 0xC2B2AE3D27D4EB4FULL ^ info;
+            return (h ^ (h >> 29)) & mask;
+        }
+};
 
 uint64_t perft(Board *board, int depth, bool passed) {
     if (depth == 0) {
@@ -65,4 +184,147 @@ uint64_t perft_no_pass_count(Board *board, int depth, bool passed) {
         board->undo_board(&flip);
     }
     return res;
+}
+
+/*
+    @brief Perft with hash of subtree counts
+
+    @param board                board
+    @param depth                remaining depth
+    @param passed               already passed?
+    @param pass_counted         pass is counted as 1 move? (true: perft, false: perft_no_pass_count)
+    @param hash                 hash of subtree counts
+    @return number of leaves
+*/
+uint64_t perft_hash(Board *board, int depth, bool passed, bool pass_counted, Perft_hash *hash) {
+    if (depth < PERFT_HASH_MIN_DEPTH) {
+        return pass_counted ? perft(board, depth, passed) : perft_no_pass_count(board, depth, passed);
+    }
+    uint64_t legal = board->get_legal();
+    if (legal == 0) {
+        if (passed) {
+            return 1ULL; // game over
+        }
+        board->pass();
+            uint64_t res = perft_hash(board, pass_counted ? depth - 1 : depth, true, pass_counted, hash);
+        board->pass();
+        return res;
+    }
+    Board unique_board = representative_board(board);
+    uint64_t info = ((uint64_t)depth << 2) | ((uint64_t)passed << 1) | (uint64_t)pass_counted;
+    uint64_t res;
+    if (hash->get(&unique_board, info, &res)) {
+        return res;
+    }
+    res = 0;
+    Flip flip;
+    for (uint_fast8_t cell = first_bit(&legal); legal; cell = next_bit(&legal)) {
+        calc_flip(&flip, board, cell);
+        board->move_board(&flip);
+            res += perft_hash(board, depth - 1, false, pass_counted, hash);
+        board->undo_board(&flip);
+    }
+    hash->set(&unique_board, info, res);
+    return res;
+}
+
+/*
+    @brief subtree of parallel perft
+*/
+struct Perft_task {
+    Board board;
+    int depth;
+    bool passed;
+};
+
+/*
+    @brief expand subtrees by 1 ply
+
+    @param tasks                subtrees (replaced by their children)
+    @param pass_counted         pass is counted as 1 move?
+    @return number of leaves found while expanding
+*/
+uint64_t perft_expand_tasks(std::vector<Perft_task> &tasks, bool pass_counted) {
+    uint64_t res = 0;
+    std::vector<Perft_task> next_tasks;
+    Flip flip;
+    for (Perft_task &task: tasks) {
+        if (task.depth == 0) {
+            ++res;
+            continue;
+        }
+        uint64_t legal = task.board.get_legal();
+        if (legal == 0) {
+            if (task.passed) {
+                ++res; // game over
+            } else {
+                task.board.pass();
+                next_tasks.emplace_back(Perft_task{task.board, pass_counted ? task.depth - 1 : task.depth, true});
+            }
+            continue;
+        }
+        if (task.depth == 1) {
+            res += pop_count_ull(legal);
+            continue;
+        }
+        for (uint_fast8_t cell = first_bit(&legal); legal; cell = next_bit(&legal)) {
+            calc_flip(&flip, &task.board, cell);
+            next_tasks.emplace_back(Perft_task{task.board.move_copy(&flip), task.depth - 1, false});
+        }
+    }
+    tasks.swap(next_tasks);
+    return res;
+}
+
+/*
+    @brief Perft in parallel
+
+    The tree is expanded until there are enough subtrees, then subtrees are counted by thread_pool and this thread.
+
+    @param board                root board
+    @param depth                depth
+    @param pass_counted         pass is counted as 1 move? (true: perft, false: perft_no_pass_count)
+    @param n_threads            number of threads including this thread (at most thread_pool.size() + 1)
+    @param hash                 hash of subtree counts (nullptr: not used)
+    @return number of leaves
+*/
+uint64_t perft_parallel(Board board, int depth, bool pass_counted, int n_threads, Perft_hash *hash) {
+    n_threads = std::max(1, std::min(n_threads, thread_pool.size() + 1));
+    std::vector<Perft_task> tasks = {Perft_task{board, depth, false}};
+    uint64_t res = 0;
+    const size_t n_tasks = (size_t)n_threads * PERFT_N_TASKS_PER_THREAD;
+    while (!tasks.empty() && tasks.size() < n_tasks) {
+        res += perft_expand_tasks(tasks, pass_counted);
+    }
+    std::atomic<uint64_t> total(res);
+    std::atomic<size_t> next_idx(0);
+    auto worker = [&]() {
+        size_t i;
+        while ((i = next_idx.fetch_add(1)) < tasks.size()) {
+            Board b = tasks[i].board;
+            uint64_t n;
+            if (hash != nullptr) {
+                n = perft_hash(&b, tasks[i].depth, tasks[i].passed, pass_counted, hash);
+            } else if (pass_counted) {
+                n = perft(&b, tasks[i].depth, tasks[i].passed);
+            } else {
+                n = perft_no_pass_count(&b, tasks[i].depth, tasks[i].passed);
+            }
+            total.fetch_add(n, std::memory_order_relaxed);
+        }
+    };
+    std::vector<std::future<void>> futures;
+    for (int i = 0; i < n_threads - 1; ++i) {
+        bool pushed;
+        futures.emplace_back(thread_pool.push(&pushed, worker));
+        if (!pushed) {
+            futures.pop_back();
+            break;
+        }
+    }
+    worker();
+    for (std::future<void> &f: futures) {
+        f.get();
+    }
+    return total;
 }
\ No newline at end of file
@@ -13,6 +13,7 @@
 #include <iostream>
 #include <fstream>
 #include <algorithm>
+#include <new>
 #include "setting.hpp"
 #include "common.hpp"
 #include "board.hpp"
@@ -20,6 +21,7 @@
 #include "evaluate_common.hpp"
 #include "evaluate.hpp"
 #include "flip.hpp"
+#include "search_statistics.hpp"
 
 /*
     @brief Search switch parameters
@@ -214,9 +216,6 @@ class Search {
         uint64_t n_nodes;
         Eval_search eval;
         bool use_multi_thread;
-#if USE_SEARCH_STATISTICS
-        uint64_t n_nodes_discs[HW2];
-#endif
         bool is_presearch;
 
     public:
@@ -439,4 +438,58 @@ struct Flip_value {
     bool operator>(const Flip_value &another) const{
         return value > another.value;
     }
+};
+
+/*
+    @brief Maximum number of legal moves
+
+    legal moves are on empty squares, so 60 covers any board given by setboard
+*/
+constexpr int MAX_N_LEGAL_MOVES = HW2 - 4;
+
+/*
+    @brief Fixed-capacity list of moves on the stack
+
+    used instead of std::vector<Flip_value> so that a node needs no heap allocation.
+    only the first n_moves elements are constructed.
+*/
+class Move_list {
+    private:
+        union {
+            Flip_value moves[MAX_N_LEGAL_MOVES];
+        };
+        int n_moves;
+
+    public:
+        Move_list(int n_moves_)
+            : n_moves(n_moves_) {
+            for (int i = 0; i < n_moves; ++i) {
+                new (&moves[i]) Flip_value();
+            }
+        }
+
+        Move_list(const Move_list&) = delete;
+        Move_list& operator=(const Move_list&) = delete;
+
+        ~Move_list() {}
+
+        inline int size() const {
+            return n_moves;
+        }
+
+        inline Flip_value& operator[](int idx) {
+            return moves[idx];
+        }
+
+        inline const Flip_value& operator[](int idx) const {
+            return moves[idx];
+        }
+
+        inline Flip_value* begin() {
+            return moves;
+        }
+
+        inline Flip_value* end() {
+            return moves + n_moves;
+        }
 };
\ No newline at end of file
@@ -0,0 +1,273 @@
+/*
+    Egaroucid Project
+
+    @file search_statistics.hpp
+        Search statistics (TT, cutoffs, YBWC splits) for tuning
+    @date 2021-2025
+    @author Takuto Yamana
+    @license GPL-3.0 license
+*/
+
+#pragma once
+#include <iostream>
+#include <iomanip>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+#include "setting.hpp"
+#include "common.hpp"
+
+#if USE_SEARCH_STATISTICS
+/*
+    @brief counters
+
+    each counter is counted per remaining depth
+*/
+#define SEARCH_STATISTICS_TT_PROBE 0            // transposition cutoff tried
+#define SEARCH_STATISTICS_TT_HIT 1              // bounds found in transposition table
+#define SEARCH_STATISTICS_TT_CUTOFF 2           // cutoff by transposition table
+#define SEARCH_STATISTICS_ETC_PROBE 3           // enhanced transposition cutoff tried
+#define SEARCH_STATISTICS_ETC_CUTOFF 4          // cutoff by enhanced transposition cutoff
+#define SEARCH_STATISTICS_MPC_PROBE 5           // Multi-ProbCut tried
+#define SEARCH_STATISTICS_MPC_CUTOFF 6          // cutoff by Multi-ProbCut
+#define SEARCH_STATISTICS_STABILITY_PROBE 7     // stable discs calculated for stability cutoff
+#define SEARCH_STATISTICS_STABILITY_CUTOFF 8    // cutoff by stable discs
+#define SEARCH_STATISTICS_YBWC_PROBE 9          // idle thread found for YBWC split
+#define SEARCH_STATISTICS_YBWC_SPLIT 10         // task pushed to another thread
+#define SEARCH_STATISTICS_FAIL_HIGH 11          // fail high in NWS after searching children
+#define SEARCH_STATISTICS_FIRST_MOVE_FAIL_HIGH 12 // fail high by the first searched child
+#define SEARCH_STATISTICS_TT_STORE 13           // transposition table registration tried
+#define SEARCH_STATISTICS_TT_STORE_UPDATE 14    // entry of the same board updated
+#define SEARCH_STATISTICS_TT_STORE_EMPTY 15     // empty or old entry replaced
+#define SEARCH_STATISTICS_TT_STORE_EVICT 16     // current entry of another board replaced
+#define N_SEARCH_STATISTICS 17
+
+constexpr int SEARCH_STATISTICS_N_DEPTH = HW2 + 1;
+
+/*
+    @brief merged statistics
+*/
+struct Search_statistics {
+    uint64_t counts[N_SEARCH_STATISTICS][SEARCH_STATISTICS_N_DEPTH];
+    uint64_t n_nodes_discs[HW2 + 1];
+
+    Search_statistics() {
+        clear();
+    }
+
+    void clear() {
+        for (int i = 0; i < N_SEARCH_STATISTICS; ++i) {
+            for (int j = 0; j < SEARCH_STATISTICS_N_DEPTH; ++j) {
+                counts[i][j] = 0;
+            }
+        }
+        for (int i = 0; i <= HW2; ++i) {
+            n_nodes_discs[i] = 0;
+        }
+    }
+
+    void add(const Search_statistics &another, int sign) {
+        for (int i = 0; i < N_SEARCH_STATISTICS; ++i) {
+            for (int j = 0; j < SEARCH_STATISTICS_N_DEPTH; ++j) {
+                counts[i][j] += sign * another.counts[i][j];
+            }
+        }
+        for (int i = 0; i <= HW2; ++i) {
+            n_nodes_discs[i] += sign * another.n_nodes_discs[i];
+        }
+    }
+
+    uint64_t total(int counter) const {
+        uint64_t res = 0;
+        for (int j = 0; j < SEARCH_STATISTICS_N_DEPTH; ++j) {
+            res += counts[counter][j];
+        }
+        return res;
+    }
+};
+
+/*
+    @brief counters of a thread
+
+    Only the owner thread writes, so relaxed load + store is enough (no locked instruction).
+    Other threads read them while collecting.
+*/
+struct Search_statistics_thread;
+std::mutex search_statistics_mtx;
+std::vector<Search_statistics_thread*> search_statistics_threads;
+Search_statistics search_statistics_retired; // counts of finished threads
+Search_statistics search_statistics_last; // statistics of the last search
+
+struct Search_statistics_thread {
+    std::atomic<uint64_t> counts[N_SEARCH_STATISTICS][SEARCH_STATISTICS_N_DEPTH];
+    std::atomic<uint64_t> n_nodes_discs[HW2 + 1];
+
+    Search_statistics_thread() {
+        for (int i = 0; i < N_SEARCH_STATISTICS; ++i) {
+            for (int j = 0; j < SEARCH_STATISTICS_N_DEPTH; ++j) {
+                counts[i][j].store(0, std::memory_order_relaxed);
+            }
+        }
+        for (int i = 0; i <= HW2; ++i) {
+            n_nodes_discs[i].store(0, std::memory_order_relaxed);
+        }
+        std::lock_guard<std::mutex> lock(search_statistics_mtx);
+        search_statistics_threads.emplace_back(this);
+    }
+
+    ~Search_statistics_thread() {
+        std::lock_guard<std::mutex> lock(search_statistics_mtx);
+        load(&search_statistics_retired);
+        search_statistics_threads.erase(std::find(search_statistics_threads.begin(), search_statistics_threads.end(), this));
+    }
+
+    void load(Search_statistics *res) const {
+        for (int i = 0; i < N_SEARCH_STATISTICS; ++i) {
+            for (int j = 0; j < SEARCH_STATISTICS_N_DEPTH; ++j) {
+                res->counts[i][j] += counts[i][j].load(std::memory_order_relaxed);
+            }
+        }
+        for (int i = 0; i <= HW2; ++i) {
+            res->n_nodes_discs[i] += n_nodes_discs[i].load(std::memory_order_relaxed);
+        }
+    }
+};
+
+thread_local Search_statistics_thread search_statistics_thread;
+
+inline void search_statistics_increment(std::atomic<uint64_t> &counter) {
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+/*
+    @brief count an event
+
+    @param counter              SEARCH_STATISTICS_*
+    @param depth                remaining depth
+*/
+inline void search_statistics_count(int counter, int depth) {
+    search_statistics_increment(search_statistics_thread.counts[counter][std::clamp(depth, 0, HW2)]);
+}
+
+/*
+    @brief count a node
+
+    @param n_discs              number of discs of the node
+*/
+inline void search_statistics_count_node(int n_discs) {
+    search_statistics_increment(search_statistics_thread.n_nodes_discs[n_discs]);
+}
+
+/*
+    @brief sum of counters of all threads (including finished threads)
+*/
+Search_statistics search_statistics_collect() {
+    Search_statistics res;
+    std::lock_guard<std::mutex> lock(search_statistics_mtx);
+    res.add(search_statistics_retired, 1);
+    for (const Search_statistics_thread *thread_statistics: search_statistics_threads) {
+        thread_statistics->load(&res);
+    }
+    return res;
+}
+
+inline double search_statistics_ratio(uint64_t a, uint64_t b) {
+    return b ? 100.0 * a / b : 0.0;
+}
+
+/*
+    @brief print statistics
+
+    rates are in %
+*/
+void search_statistics_print(const Search_statistics &statistics, std::ostream &out) {
+    out << "depth   TT probe    hit  cut  ETC probe    cut  MPC probe    cut  stab probe    cut  YBWC probe  split  fail high  first" << std::endl;
+    auto print_row = [&](std::string label, const uint64_t c[N_SEARCH_STATISTICS]) {
+        out << std::setw(5) << label << std::fixed << std::setprecision(1);
+        out << std::setw(11) << c[SEARCH_STATISTICS_TT_PROBE] << std::setw(7) << search_statistics_ratio(c[SEARCH_STATISTICS_TT_HIT], c[SEARCH_STATISTICS_TT_PROBE]) << std::setw(5) << search_statistics_ratio(c[SEARCH_STATISTICS_TT_CUTOFF], c[SEARCH_STATISTICS_TT_PROBE]);
+        out << std::setw(11) << c[SEARCH_STATISTICS_ETC_PROBE] << std::setw(7) << search_statistics_ratio(c[SEARCH_STATISTICS_ETC_CUTOFF], c[SEARCH_STATISTICS_ETC_PROBE]);
+        out << std::setw(11) << c[SEARCH_STATISTICS_MPC_PROBE] << std::setw(7) << search_statistics_ratio(c[SEARCH_STATISTICS_MPC_CUTOFF], c[SEARCH_STATISTICS_MPC_PROBE]);
+        out << std::setw(12) << c[SEARCH_STATISTICS_STABILITY_PROBE] << std::setw(7) << search_statistics_ratio(c[SEARCH_STATISTICS_STABILITY_CUTOFF], c[SEARCH_STATISTICS_STABILITY_PROBE]);
+        out << std::setw(12) << c[SEARCH_STATISTICS_YBWC_PROBE] << std::setw(7) << search_statistics_ratio(c[SEARCH_STATISTICS_YBWC_SPLIT], c[SEARCH_STATISTICS_YBWC_PROBE]);
+        out << std::setw(11) << c[SEARCH_STATISTICS_FAIL_HIGH] << std::setw(7) << search_statistics_ratio(c[SEARCH_STATISTICS_FIRST_MOVE_FAIL_HIGH], c[SEARCH_STATISTICS_FAIL_HIGH]);
+        out << std::defaultfloat << std::endl;
+    };
+    uint64_t row[N_SEARCH_STATISTICS];
+    for (int depth = 0; depth < SEARCH_STATISTICS_N_DEPTH; ++depth) {
+        bool used = false;
+        for (int i = 0; i < N_SEARCH_STATISTICS; ++i) {
+            row[i] = statistics.counts[i][depth];
+            used |= row[i] != 0;
+        }
+        if (used) {
+            print_row(std::to_string(depth), row);
+        }
+    }
+    for (int i = 0; i < N_SEARCH_STATISTICS; ++i) {
+        row[i] = statistics.total(i);
+    }
+    print_row("total", row);
+    out << "depth   TT store  update  empty  evict   drop" << std::endl;
+    auto print_store_row = [&](std::string label, const uint64_t c[N_SEARCH_STATISTICS]) {
+        out << std::setw(5) << label << std::fixed << std::setprecision(1);
+        out << std::setw(11) << c[SEARCH_STATISTICS_TT_STORE];
+        uint64_t n_stored = 0;
+        for (int counter: {SEARCH_STATISTICS_TT_STORE_UPDATE, SEARCH_STATISTICS_TT_STORE_EMPTY, SEARCH_STATISTICS_TT_STORE_EVICT}) {
+            out << std::setw(8) << search_statistics_ratio(c[counter], c[SEARCH_STATISTICS_TT_STORE]);
+            n_stored += c[counter];
+        }
+        out << std::setw(7) << search_statistics_ratio(c[SEARCH_STATISTICS_TT_STORE] - std::min(n_stored, c[SEARCH_STATISTICS_TT_STORE]), c[SEARCH_STATISTICS_TT_STORE]);
+        out << std::defaultfloat << std::endl;
+    };
+    for (int depth = 0; depth < SEARCH_STATISTICS_N_DEPTH; ++depth) {
+        if (statistics.counts[SEARCH_STATISTICS_TT_STORE][depth]) {
+            for (int i = 0; i < N_SEARCH_STATISTICS; ++i) {
+                row[i] = statistics.counts[i][depth];
+            }
+            print_store_row(std::to_string(depth), row);
+        }
+    }
+    for (int i = 0; i < N_SEARCH_STATISTICS; ++i) {
+        row[i] = statistics.total(i);
+    }
+    print_store_row("total", row);
+    uint64_t n_nodes = 0;
+    for (int i = 0; i <= HW2; ++i) {
+        n_nodes += statistics.n_nodes_discs[i];
+    }
+    out << "nodes by discs";
+    for (int i = 0; i <= HW2; ++i) {
+        if (statistics.n_nodes_discs[i]) {
+            out << " " << i << ":" << std::fixed << std::setprecision(1) << search_statistics_ratio(statistics.n_nodes_discs[i], n_nodes) << "%" << std::defaultfloat;
+        }
+    }
+    out << std::endl;
+}
+
+/*
+    @brief store statistics of a search
+
+    @param strt                 statistics collected before the search
+    @param show_log             print them?
+*/
+void search_statistics_finish(const Search_statistics &strt, bool show_log) {
+    Search_statistics statistics = search_statistics_collect();
+    statistics.add(strt, -1);
+    {
+        std::lock_guard<std::mutex> lock(search_statistics_mtx);
+        search_statistics_last = statistics;
+    }
+    if (show_log) {
+        search_statistics_print(statistics, std::cerr);
+    }
+}
+
+/*
+    @brief statistics of the last search
+*/
+Search_statistics search_statistics_get_last() {
+    std::lock_guard<std::mutex> lock(search_statistics_mtx);
+    return search_statistics_last;
+}
+#endif
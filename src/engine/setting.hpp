@@ -14,6 +14,8 @@
     -DHAS_ARM_PROCESSOR : ARM Processor
     -DHAS_AMD_PROCESSOR : Optimization for AMD CPU
     -DHAS_32_BIT_OS     : 32bit environment
+    -DHAS_TT_BUCKET     : Use bucketed lockless transposition table
+    -DHAS_NUMA          : Use libnuma for NUMA placement of transposition table (Linux, link with -lnuma)
 */
 
 #pragma once
@@ -107,6 +109,14 @@
             #define USE_AVX512_STABILITY true
         #endif
 
+        // use AVX-512 for pattern evaluation and feature update
+        #if USE_AVX512
+            #define USE_AVX512_EVAL true
+        #endif
+
+        // use AVX-512 gathers in calc_pattern and calc_pattern_move_ordering_end (no faster than AVX2 in -evalkernelbench)
+        #define USE_AVX512_CALC_PATTERN false
+
         // CRC32C Hash
         #define USE_CRC32C_HASH false
         #define USE_CRC32C_HASH_LTT false
@@ -164,9 +174,30 @@
 // if false, USE_CHANGEABLE_HASH_LEVEL must be true
 #define TT_USE_STACK true
 
+// transposition table on huge pages (falls back to normal pages)
+#define TT_USE_LARGE_PAGE true
+
+// transposition table with 64-byte buckets and lockless entries
+// if true, TT_USE_STACK is ignored
+#ifdef HAS_TT_BUCKET
+    #define TT_USE_BUCKET true
+#else
+    #define TT_USE_BUCKET false
+#endif
+
+// NUMA placement of transposition table with libnuma
+#if defined(HAS_NUMA) && defined(__linux__)
+    #define USE_NUMA true
+#else
+    #define USE_NUMA false
+#endif
+
 // flip SIMD / AVX512 optimization for each compiler
 #define AUTO_FLIP_OPT_BY_COMPILER true
 
+// persistent store of exactly solved positions (used if opened)
+#define USE_SOLVED_STORE true
+
 // Lazy-SMP-like search
 #define USE_LAZY_SMP true
 
@@ -180,8 +211,15 @@
     @brief debug settings
 */
 
-// search statistics
-#define USE_SEARCH_STATISTICS false
+// search statistics (TT hit rate, cutoff rates and YBWC splits per depth)
+#ifdef HAS_SEARCH_STATISTICS
+    #define USE_SEARCH_STATISTICS true
+#else
+    #define USE_SEARCH_STATISTICS false
+#endif
+
+// YBWC split statistics (splits per second, heap allocations per split)
+#define USE_YBWC_SPLIT_STATISTICS false
 
 // thread monitor
 #define USE_THREAD_MONITOR false
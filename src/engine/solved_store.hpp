@@ -0,0 +1,437 @@
+/*
+    Egaroucid Project
+
+    @file solved_store.hpp
+        Persistent store of exactly solved endgame positions
+    @date 2021-2025
+    @author Takuto Yamana
+    @license GPL-3.0 license
+*/
+
+#pragma once
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <shared_mutex>
+#include <mutex>
+#include <atomic>
+#include <cstdio>
+#include "common.hpp"
+#include "board.hpp"
+#include "util.hpp"
+#if _WIN64 || _WIN32
+    #define SOLVED_STORE_USE_MMAP false
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+    #define SOLVED_STORE_USE_MMAP true
+#endif
+
+constexpr char SOLVED_STORE_VERSION = 1;
+constexpr int SOLVED_STORE_MIN_DEPTH = 18; // positions with less empties are solved faster than stored
+constexpr int SOLVED_STORE_MIN_LOOKUP_DEPTH = 22; // lookups in search below this mostly miss and only cost the lock
+
+/*
+    @brief header of solved position store
+
+    @param egaroucid_str        "DICUORAGE"
+    @param store_version        SOLVED_STORE_VERSION
+    @param n_sorted             number of sorted records (written by compaction)
+    @param record_size          sizeof(Solved_store_record)
+
+    sorted records follow the header, then records appended after the last compaction
+*/
+struct Solved_store_header {
+    char egaroucid_str[9];
+    char store_version;
+    char reserved[6];
+    uint64_t n_sorted;
+    uint64_t record_size;
+};
+
+/*
+    @brief a record of solved position store
+
+    board is the representative board, value is the exact score for the player to move
+*/
+struct Solved_store_record {
+    uint64_t player;
+    uint64_t opponent;
+    int8_t value;
+    int8_t move;
+    int8_t reserved[6];
+};
+
+static_assert(sizeof(Solved_store_header) == 32, "Solved_store_header must be 32 bytes");
+static_assert(sizeof(Solved_store_record) == 24, "Solved_store_record must be 24 bytes");
+
+inline bool solved_store_record_less(const Solved_store_record &a, const Solved_store_record &b) {
+    return a.player < b.player || (a.player == b.player && a.opponent < b.opponent);
+}
+
+struct Solved_store_hash {
+    size_t operator()(const std::pair<uint64_t, uint64_t> &key) const {
+        return (key.first * 0x9E3779B97F4A7C15ULL) ^ (key.second + 0x632BE59BD9B4E019ULL + (key.first >> 29));
+    }
+};
+
+/*
+    @brief append-only store of exact results (MPC 100%)
+
+    Sorted records written by compaction are mapped and looked up by binary search.
+    Records appended after that are kept in a hash map, so a store can be used
+    for a long time without compaction.
+    add() only queues a record; flush() makes queued records visible and writes
+    them to the file, and is called outside the search.
+*/
+class Solved_store {
+    private:
+        std::string file;
+        FILE *append_fp;
+        const Solved_store_record *sorted;
+        uint64_t n_sorted;
+#if SOLVED_STORE_USE_MMAP
+        void *mapped;
+        size_t mapped_size;
+#else
+        std::vector<Solved_store_record> buffer;
+#endif
+        std::unordered_map<std::pair<uint64_t, uint64_t>, Solved_store_record, Solved_store_hash> appended;
+        std::atomic<uint64_t> n_records;
+        mutable std::shared_mutex mtx;
+        std::vector<Solved_store_record> pending;
+        std::mutex pending_mtx;
+
+    public:
+        Solved_store()
+            : append_fp(nullptr), sorted(nullptr), n_sorted(0)
+#if SOLVED_STORE_USE_MMAP
+            , mapped(nullptr), mapped_size(0)
+#endif
+            , n_records(0)
+        {}
+
+        ~Solved_store() {
+            close();
+        }
+
+        Solved_store(const Solved_store&) = delete;
+        Solved_store& operator=(const Solved_store&) = delete;
+
+        /*
+            @brief open store (created if not exist)
+
+            @param new_file             store file
+            @param show_log             show log?
+            @return opened?
+        */
+        bool open(std::string new_file, bool show_log) {
+            close();
+            std::unique_lock<std::shared_mutex> lock(mtx);
+            FILE *fp;
+            if (!file_open(&fp, new_file.c_str(), "rb")) {
+                if (!write_file(new_file, std::vector<Solved_store_record>())) {
+                    std::cerr << "[ERROR] can't create solved position store " << new_file << std::endl;
+                    return false;
+                }
+                if (!file_open(&fp, new_file.c_str(), "rb")) {
+                    return false;
+                }
+            }
+            Solved_store_header header;
+            if (fread(&header, sizeof(Solved_store_header), 1, fp) < 1 || !check_header(header)) {
+                std::cerr << "[ERROR] solved position store broken " << new_file << std::endl;
+                fclose(fp);
+                return false;
+            }
+            size_t sorted_size = sizeof(Solved_store_header) + header.n_sorted * sizeof(Solved_store_record);
+#if SOLVED_STORE_USE_MMAP
+            if (header.n_sorted) {
+                int fd = ::open(new_file.c_str(), O_RDONLY);
+                if (fd == -1) {
+                    fclose(fp);
+                    return false;
+                }
+                void *p = mmap(nullptr, sorted_size, PROT_READ, MAP_SHARED, fd, 0);
+                ::close(fd);
+                if (p == MAP_FAILED) {
+                    std::cerr << "[ERROR] mmap failed " << new_file << std::endl;
+                    fclose(fp);
+                    return false;
+                }
+                madvise(p, sorted_size, MADV_RANDOM);
+                mapped = p;
+                mapped_size = sorted_size;
+                sorted = (const Solved_store_record*)((const char*)p + sizeof(Solved_store_header));
+            }
+            fseek(fp, sorted_size, SEEK_SET);
+#else
+            buffer.resize(header.n_sorted);
+            if (fread(buffer.data(), sizeof(Solved_store_record), header.n_sorted, fp) < header.n_sorted) {
+                std::cerr << "[ERROR] solved position store broken " << new_file << std::endl;
+                buffer.clear();
+                fclose(fp);
+                return false;
+            }
+            sorted = buffer.data();
+#endif
+            n_sorted = header.n_sorted;
+            Solved_store_record record;
+            while (fread(&record, sizeof(Solved_store_record), 1, fp) == 1) { // a torn record at the end is ignored
+                appended[std::make_pair(record.player, record.opponent)] = record;
+            }
+            fclose(fp);
+            n_records.store(n_sorted + appended.size(), std::memory_order_release);
+            if (!file_open(&append_fp, new_file.c_str(), "ab")) {
+                std::cerr << "[ERROR] can't open solved position store for writing " << new_file << std::endl;
+                append_fp = nullptr;
+            }
+            file = new_file;
+            if (show_log) {
+                std::cerr << "solved position store " << file << " sorted " << n_sorted << " appended " << appended.size() << std::endl;
+            }
+            return true;
+        }
+
+        /*
+            @brief close store
+        */
+        void close() {
+            flush();
+            std::unique_lock<std::shared_mutex> lock(mtx);
+            if (append_fp != nullptr) {
+                fclose(append_fp);
+                append_fp = nullptr;
+            }
+#if SOLVED_STORE_USE_MMAP
+            if (mapped != nullptr) {
+                munmap(mapped, mapped_size);
+                mapped = nullptr;
+                mapped_size = 0;
+            }
+#else
+            buffer.clear();
+            buffer.shrink_to_fit();
+#endif
+            sorted = nullptr;
+            n_sorted = 0;
+            appended.clear();
+            n_records.store(0, std::memory_order_release);
+            file.clear();
+        }
+
+        inline bool is_open() const {
+            return !file.empty();
+        }
+
+        inline uint64_t size() const {
+            std::shared_lock<std::shared_mutex> lock(mtx);
+            return n_sorted + appended.size();
+        }
+
+        inline bool has_records() const {
+            return n_records.load(std::memory_order_acquire) != 0;
+        }
+
+        /*
+            @brief get exact score
+
+            @param board                board
+            @param value                exact score for the player to move
+            @return found?
+        */
+        inline bool get_value(const Board *board, int *value) const {
+            Solved_store_record record;
+            if (find(representative_board(board->copy()), &record)) {
+                *value = record.value;
+                return true;
+            }
+            return false;
+        }
+
+        /*
+            @brief get exact score and best move
+
+            @param board                board
+            @param value                exact score for the player to move
+            @param move                 best move on board
+            @return found?
+        */
+        inline bool get(const Board *board, int *value, int *move) const {
+            int idx;
+            Board rboard = representative_board(board->copy(), &idx);
+            Solved_store_record record;
+            if (find(rboard, &record)) {
+                *value = record.value;
+                *move = convert_coord_from_representative_board(record.move, idx);
+                return true;
+            }
+            return false;
+        }
+
+        /*
+            @brief queue an exact result (visible after flush)
+
+            @param board                board
+            @param value                exact score for the player to move
+            @param move                 best move on board (MOVE_UNDEFINED if unknown)
+        */
+        inline void add(const Board *board, int value, int move) {
+            int idx;
+            Board rboard = representative_board(board->copy(), &idx);
+            Solved_store_record record = {};
+            record.player = rboard.player;
+            record.opponent = rboard.opponent;
+            record.value = value;
+            record.move = is_valid_policy(move) ? convert_coord_to_representative_board(move, idx) : MOVE_UNDEFINED;
+            std::lock_guard<std::mutex> lock(pending_mtx);
+            pending.emplace_back(record);
+        }
+
+        /*
+            @brief merge queued results and append them to the file
+        */
+        void flush() {
+            std::vector<Solved_store_record> records;
+            {
+                std::lock_guard<std::mutex> lock(pending_mtx);
+                records.swap(pending);
+            }
+            if (records.empty()) {
+                return;
+            }
+            std::unique_lock<std::shared_mutex> lock(mtx);
+            if (!is_open()) {
+                return;
+            }
+            size_t n_written = 0;
+            for (const Solved_store_record &record: records) {
+                Board rboard(record.player, record.opponent);
+                if (find_sorted(rboard) != nullptr) {
+                    continue;
+                }
+                auto itr = appended.find(std::make_pair(record.player, record.opponent));
+                if (itr != appended.end() && (is_valid_policy(itr->second.move) || !is_valid_policy(record.move))) {
+                    continue;
+                }
+                appended[std::make_pair(record.player, record.opponent)] = record;
+                if (append_fp != nullptr) {
+                    fwrite(&record, sizeof(Solved_store_record), 1, append_fp);
+                    ++n_written;
+                }
+            }
+            if (n_written) {
+                fflush(append_fp);
+            }
+            n_records.store(n_sorted + appended.size(), std::memory_order_release);
+        }
+
+        /*
+            @brief merge appended records into the sorted part
+
+            @return compacted?
+        */
+        bool compact() {
+            std::string compact_file = file;
+            if (compact_file.empty()) {
+                return false;
+            }
+            flush();
+            std::vector<Solved_store_record> records;
+            {
+                std::shared_lock<std::shared_mutex> lock(mtx);
+                records.assign(sorted, sorted + n_sorted);
+                for (const auto &elem: appended) {
+                    records.emplace_back(elem.second);
+                }
+            }
+            close();
+            std::string tmp_file = compact_file + ".tmp";
+            if (!write_file(tmp_file, records)) {
+                return false;
+            }
+            if (std::rename(tmp_file.c_str(), compact_file.c_str()) != 0) {
+                std::remove(compact_file.c_str());
+                if (std::rename(tmp_file.c_str(), compact_file.c_str()) != 0) {
+                    std::cerr << "[ERROR] can't replace solved position store " << compact_file << std::endl;
+                    return false;
+                }
+            }
+            return open(compact_file, false);
+        }
+
+    private:
+        inline const Solved_store_record* find_sorted(Board b) const {
+            Solved_store_record key;
+            key.player = b.player;
+            key.opponent = b.opponent;
+            const Solved_store_record *itr = std::lower_bound(sorted, sorted + n_sorted, key, solved_store_record_less);
+            if (itr != sorted + n_sorted && itr->player == b.player && itr->opponent == b.opponent) {
+                return itr;
+            }
+            return nullptr;
+        }
+
+        inline bool find(Board b, Solved_store_record *record) const {
+            std::shared_lock<std::shared_mutex> lock(mtx);
+            const Solved_store_record *sorted_record = find_sorted(b);
+            if (sorted_record != nullptr) {
+                *record = *sorted_record;
+                return true;
+            }
+            auto itr = appended.find(std::make_pair(b.player, b.opponent));
+            if (itr != appended.end()) {
+                *record = itr->second;
+                return true;
+            }
+            return false;
+        }
+
+        static bool check_header(const Solved_store_header &header) {
+            char egaroucid_str_ans[] = "DICUORAGE";
+            for (int i = 0; i < 9; ++i) {
+                if (header.egaroucid_str[i] != egaroucid_str_ans[i]) {
+                    return false;
+                }
+            }
+            return header.store_version == SOLVED_STORE_VERSION && header.record_size == sizeof(Solved_store_record);
+        }
+
+        /*
+            @brief write sorted store
+
+            @param out_file             file name
+            @param records              records (sorted and deduplicated in this function)
+            @return written?
+        */
+        static bool write_file(std::string out_file, std::vector<Solved_store_record> records) {
+            std::stable_sort(records.begin(), records.end(), solved_store_record_less);
+            records.erase(std::unique(records.begin(), records.end(), [](const Solved_store_record &a, const Solved_store_record &b) {
+                return a.player == b.player && a.opponent == b.opponent;
+            }), records.end());
+            std::ofstream fout;
+            fout.open(out_file.c_str(), std::ios::out|std::ios::binary|std::ios::trunc);
+            if (!fout) {
+                return false;
+            }
+            Solved_store_header header = {};
+            char egaroucid_str[] = "DICUORAGE";
+            for (int i = 0; i < 9; ++i) {
+                header.egaroucid_str[i] = egaroucid_str[i];
+            }
+            header.store_version = SOLVED_STORE_VERSION;
+            header.n_sorted = records.size();
+            header.record_size = sizeof(Solved_store_record);
+            fout.write((char*)&header, sizeof(Solved_store_header));
+            fout.write((char*)records.data(), sizeof(Solved_store_record) * records.size());
+            fout.close();
+            return !fout.fail();
+        }
+};
+
+Solved_store solved_store;
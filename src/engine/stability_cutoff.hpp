@@ -26,7 +26,13 @@
 inline int stability_cut(Search *search, int *alpha, int *beta) {
     if (*beta >= stability_threshold[search->n_discs]) {
         int n_beta = HW2 - 2 * pop_count_ull(calc_stability(search->board.opponent, search->board.player));
+#if USE_SEARCH_STATISTICS
+        search_statistics_count(SEARCH_STATISTICS_STABILITY_PROBE, HW2 - search->n_discs);
+#endif
         if (n_beta <= *alpha) {
+#if USE_SEARCH_STATISTICS
+            search_statistics_count(SEARCH_STATISTICS_STABILITY_CUTOFF, HW2 - search->n_discs);
+#endif
             return n_beta;
         } else if (n_beta < *beta) {
             *beta = n_beta;
@@ -39,7 +45,13 @@ inline int stability_cut(Search *search, int *alpha, int *beta) {
 inline int stability_cut_last4(Search *search, int *alpha, int beta) {
     if (*alpha <= -stability_threshold[60]) {
         int n_alpha = 2 * pop_count_ull(calc_stability(search->board.opponent, search->board.player)) - HW2;
+#if USE_SEARCH_STATISTICS
+        search_statistics_count(SEARCH_STATISTICS_STABILITY_PROBE, 4); // always 4 empties
+#endif
         if (n_alpha >= beta) {
+#if USE_SEARCH_STATISTICS
+            search_statistics_count(SEARCH_STATISTICS_STABILITY_CUTOFF, 4); // always 4 empties
+#endif
             return n_alpha;
         } else if (n_alpha > *alpha) {
             *alpha = n_alpha;
@@ -62,7 +74,13 @@ inline int stability_cut_last4(Search *search, int *alpha, int beta) {
 inline int stability_cut_nws(Search *search, int alpha) {
     if (alpha >= stability_threshold_nws[search->n_discs]) {
         int n_beta = HW2 - 2 * pop_count_ull(calc_stability(search->board.opponent, search->board.player));
+#if USE_SEARCH_STATISTICS
+        search_statistics_count(SEARCH_STATISTICS_STABILITY_PROBE, HW2 - search->n_discs);
+#endif
         if (n_beta <= alpha) {
+#if USE_SEARCH_STATISTICS
+            search_statistics_count(SEARCH_STATISTICS_STABILITY_CUTOFF, HW2 - search->n_discs);
+#endif
             return n_beta;
         }
     }
@@ -73,7 +91,13 @@ inline int stability_cut_nws(Search *search, int alpha) {
 inline int stability_cut_last4_nws(Search *search, int alpha) {
     if (alpha < -stability_threshold_nws[60]) {
         int n_alpha = 2 * pop_count_ull(calc_stability(search->board.opponent, search->board.player)) - HW2;
+#if USE_SEARCH_STATISTICS
+        search_statistics_count(SEARCH_STATISTICS_STABILITY_PROBE, 4); // always 4 empties
+#endif
         if (n_alpha > alpha) {
+#if USE_SEARCH_STATISTICS
+            search_statistics_count(SEARCH_STATISTICS_STABILITY_CUTOFF, 4); // always 4 empties
+#endif
             return n_alpha;
         }
     }
@@ -2,7 +2,7 @@
     Egaroucid Project
 
     @file thread_pool.hpp
-        Thread pool for Egaroucid
+        Work-stealing thread pool for Egaroucid
     @date 2021-2025
     @author Takuto Yamana
     @license GPL-3.0 license
@@ -12,10 +12,14 @@
 #pragma once
 #include <iostream>
 #include <future>
-#include <queue>
+#include <memory>
 #include <thread>
 #include <atomic>
+#include <mutex>
+#include <condition_variable>
 #include <functional>
+#include "spinlock.hpp"
+#include "affinity.hpp"
 
 // Original code based on
 //  * <https://github.com/bshoshany/thread-pool>
@@ -27,33 +31,129 @@ void reset_unavailable_task(bool *start_flag) {
     while (!*start_flag);
 }
 
+/*
+    @brief constants for work stealing
+*/
+constexpr int THREAD_POOL_N_SPIN = 256;
+constexpr int THREAD_POOL_EXTERNAL_QUEUE = -1;
+
+/*
+    @brief index of the worker running on this thread
+
+    THREAD_POOL_EXTERNAL_QUEUE if this thread is not a worker
+*/
+thread_local int thread_pool_worker_idx = THREAD_POOL_EXTERNAL_QUEUE;
+
+/*
+    @brief Task deque for work stealing
+
+    owner pushes / pops at the back, thieves steal from the front
+    fixed-size ring buffer: each queued task reserves an idle worker,
+    so the number of queued tasks never exceeds the number of workers
+*/
+class Thread_pool_deque {
+    private:
+        Spinlock lock;
+        std::unique_ptr<std::function<void()>[]> tasks;
+        size_t capacity;
+        size_t head;
+        size_t n_tasks;
+
+    public:
+        void init(size_t new_capacity) {
+            capacity = new_capacity;
+            tasks.reset(new std::function<void()>[capacity]);
+            head = 0;
+            n_tasks = 0;
+        }
+
+        bool push(std::function<void()> &&task) {
+            std::lock_guard<Spinlock> guard(lock);
+            if (n_tasks == capacity) {
+                return false;
+            }
+            tasks[(head + n_tasks) % capacity] = std::move(task);
+            ++n_tasks;
+            return true;
+        }
+
+        bool pop(std::function<void()> &task) {
+            std::lock_guard<Spinlock> guard(lock);
+            if (n_tasks == 0) {
+                return false;
+            }
+            --n_tasks;
+            task = std::move(tasks[(head + n_tasks) % capacity]);
+            return true;
+        }
+
+        bool steal(std::function<void()> &task) {
+            if (!lock.try_lock()) {
+                return false;
+            }
+            bool res = false;
+            if (n_tasks) {
+                task = std::move(tasks[head]);
+                head = (head + 1) % capacity;
+                --n_tasks;
+                res = true;
+            }
+            lock.unlock();
+            return res;
+        }
+};
+
+/*
+    @brief Work-stealing thread pool
+
+    push() succeeds only if an idle worker can be reserved for the task,
+    so callers can fall back to searching by themselves.
+    A worker pushes into its own deque and idle workers steal from others.
+    Tasks from non-worker threads go to the external deque.
+
+    @param n_idle               idle workers that are not reserved by queued tasks
+    @param n_queued             tasks in all deques
+    @param n_sleeping           workers waiting on the condition variable
+    @param n_waiting            threads blocked in help_until()
+    @param pin_threads          pin workers to CPUs (applied when workers are created)
+*/
 class Thread_pool {
     private:
         mutable std::mutex mtx;
-        bool running;
+        std::atomic<bool> running;
         int n_thread;
-        //std::atomic<int> n_idle;
-        int n_idle;
-        std::queue<std::function<void()>> tasks{};
+        std::atomic<int> n_idle;
+        std::atomic<int> n_queued;
+        std::atomic<int> n_sleeping;
+        std::atomic<int> n_waiting;
+        bool pin_threads;
+        std::unique_ptr<Thread_pool_deque[]> deques; // n_thread worker deques + external deque
         std::unique_ptr<std::thread[]> threads;
         std::condition_variable condition;
-        //std::atomic<int> n_using_tasks;
+        std::mutex done_mtx;
+        std::condition_variable done_condition;
 
     public:
         void set_thread(int new_n_thread) {
             {
                 std::lock_guard<std::mutex> lock(mtx);
-                //n_using_tasks.store(0);
                 if (new_n_thread < 0) {
                     new_n_thread = 0;
                 }
                 n_thread = new_n_thread;
+                n_idle = 0;
+                n_queued = 0;
+                n_sleeping = 0;
+                n_waiting = 0;
+                running = true;
+                deques.reset(new Thread_pool_deque[n_thread + 1]);
+                for (int i = 0; i < n_thread + 1; ++i) {
+                    deques[i].init(n_thread + 1);
+                }
                 threads.reset(new std::thread[n_thread]);
                 for (int i = 0; i < n_thread; ++i) {
-                    threads[i] = std::thread(&Thread_pool::worker, this);
+                    threads[i] = std::thread(&Thread_pool::worker, this, i);
                 }
-                running = true;
-                n_idle = 0;
             }
         }
 
@@ -68,13 +168,14 @@ class Thread_pool {
             }
             n_thread = 0;
             n_idle = 0;
+            n_queued = 0;
         }
 
-        Thread_pool() {
+        Thread_pool() : pin_threads(false) {
             set_thread(0);
         }
 
-        Thread_pool(int new_n_thread) {
+        Thread_pool(int new_n_thread) : pin_threads(false) {
             set_thread(new_n_thread);
         }
 
@@ -91,35 +192,22 @@ class Thread_pool {
             return n_thread;
         }
 
-        int get_n_idle() const {
-            return n_idle;
+        /*
+            @brief pin workers to CPUs from the next resize
+
+            worker i uses slot i + 1 of affinity_get_cpu_order(), slot 0 is left for the main thread
+        */
+        void set_pin_threads(bool new_pin_threads) {
+            pin_threads = new_pin_threads;
         }
 
-        /*
-        void reset_unavailable() {
-            if (n_idle == n_thread && n_using_tasks.load() == 0) {
-                bool start_flag = false;
-                std::vector<std::future<void>> futures;
-                bool need_to_reset = false;
-                for (int i = 0; i < n_thread; ++i) {
-                    bool pushed;
-                    futures.emplace_back(push(&pushed, std::bind(reset_unavailable_task, &start_flag)));
-                    if (!pushed) {
-                        futures.pop_back();
-                        need_to_reset = true;
-                    }
-                }
-                start_flag = true;
-                for (std::future<void> &f: futures) {
-                    f.get();
-                }
-                if (need_to_reset) {
-                    std::cerr << "reset unavailable threads" << std::endl;
-                    resize(n_thread);
-                }
-            }
+        bool get_pin_threads() const {
+            return pin_threads;
+        }
+
+        int get_n_idle() const {
+            return n_idle.load(std::memory_order_relaxed);
         }
-        */
 
 #if ((defined(_MSVC_LANG) && _MSVC_LANG >= 201703L) || __cplusplus >= 201703L)
             template<typename F, typename... Args, typename R = std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>>
@@ -136,51 +224,134 @@ class Thread_pool {
         }
 
         /*
-        void tell_start_using() {
-            n_using_tasks.fetch_add(1);
-        }
+            @brief reserve an idle worker and push the task without future
 
-        void tell_finish_using() {
-            n_using_tasks.fetch_sub(1);
-        }
-        */
-
-    private:
+            no heap allocation if the task fits in std::function's small buffer
 
+            @return pushed?
+        */
         template<typename F>
         inline bool push_task(const F &task) {
             if (!running) {
                 throw std::runtime_error("Cannot schedule new task after shutdown.");
             }
-            bool pushed = false;
-            if (n_idle > 0) {
-                {
-                    std::unique_lock<std::mutex> lock(mtx);
-                    if (n_idle > 0) {
-                        pushed = true;
-                        tasks.push(std::function<void()>(task));
-                        --n_idle;
+            int idle = n_idle.load(std::memory_order_relaxed);
+            while (idle > 0) {
+                if (n_idle.compare_exchange_weak(idle, idle - 1)) {
+                    if (!get_deque(thread_pool_worker_idx).push(std::function<void()>(task))) {
+                        n_idle.fetch_add(1);
+                        return false;
+                    }
+                    n_queued.fetch_add(1);
+                    if (n_sleeping.load() > 0) {
+                        std::lock_guard<std::mutex> lock(mtx);
                         condition.notify_one();
                     }
+                    return true;
                 }
             }
-            return pushed;
+            return false;
         }
 
-        void worker() {
+        /*
+            @brief wait until done becomes true
+
+            a worker does tasks left in its own deque meanwhile (they were pushed by itself),
+            then blocks until the task calls set_done().
+            Non-worker threads never pop the shared external deque, it may hold tasks of other callers.
+
+            @param done                 flag set by the task to wait
+        */
+        inline void help_until(const std::atomic<bool> *done) {
+            std::function<void()> task;
+            while (!done->load(std::memory_order_acquire)) {
+                if (n_thread && thread_pool_worker_idx != THREAD_POOL_EXTERNAL_QUEUE && get_deque(thread_pool_worker_idx).pop(task)) {
+                    n_queued.fetch_sub(1);
+                    n_idle.fetch_add(1); // reserved worker released
+                    task();
+                    task = nullptr;
+                } else {
+                    std::unique_lock<std::mutex> lock(done_mtx);
+                    n_waiting.fetch_add(1);
+                    done_condition.wait(lock, [&] {return done->load();});
+                    n_waiting.fetch_sub(1);
+                }
+            }
+        }
+
+        /*
+            @brief set done flag of a task and wake threads in help_until()
+
+            @param done                 flag to set
+        */
+        inline void set_done(std::atomic<bool> *done) {
+            done->store(true);
+            if (n_waiting.load() > 0) {
+                std::lock_guard<std::mutex> lock(done_mtx);
+                done_condition.notify_all();
+            }
+        }
+
+    private:
+
+        inline Thread_pool_deque& get_deque(int worker_idx) {
+            if (worker_idx == THREAD_POOL_EXTERNAL_QUEUE) {
+                return deques[n_thread];
+            }
+            return deques[worker_idx];
+        }
+
+        /*
+            @brief get a task from own deque, then steal from others
+        */
+        inline bool get_task(int worker_idx, std::function<void()> &task) {
+            if (n_queued.load(std::memory_order_relaxed) == 0) {
+                return false;
+            }
+            if (deques[worker_idx].pop(task)) {
+                n_queued.fetch_sub(1);
+                return true;
+            }
+            for (int i = 1; i <= n_thread; ++i) {
+                if (deques[(worker_idx + i) % (n_thread + 1)].steal(task)) {
+                    n_queued.fetch_sub(1);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void worker(int worker_idx) {
+            thread_pool_worker_idx = worker_idx;
+            if (pin_threads) {
+                affinity_pin_current_thread(worker_idx + 1);
+            }
             std::function<void()> task;
             for (;;) {
-                {
-                    std::unique_lock<std::mutex> lock(mtx);
-                    ++n_idle;
-                    condition.wait(lock, [&] {return !tasks.empty() || !running;});
-                    if (!running) {
-                        return;
+                n_idle.fetch_add(1);
+                bool got_task = false;
+                while (!got_task) {
+                    for (int i = 0; i < THREAD_POOL_N_SPIN && !got_task; ++i) {
+                        if (!running) {
+                            return;
+                        }
+                        got_task = get_task(worker_idx, task);
+                        if (!got_task) {
+                            std::this_thread::yield();
+                        }
+                    }
+                    if (!got_task) {
+                        std::unique_lock<std::mutex> lock(mtx);
+                        n_sleeping.fetch_add(1);
+                        condition.wait(lock, [&] {return n_queued.load() > 0 || !running;});
+                        n_sleeping.fetch_sub(1);
+                        if (!running) {
+                            return;
+                        }
                     }
-                    task = std::move(tasks.front());
-                    tasks.pop();
                 }
                 task();
+                task = nullptr;
             }
         }
 };
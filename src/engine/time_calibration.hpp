@@ -0,0 +1,360 @@
+/*
+    Egaroucid Project
+
+    @file time_calibration.hpp
+        NPS and node growth calibration for time management
+    @date 2021-2025
+    @author Takuto Yamana
+    @license GPL-3.0 license
+*/
+
+#pragma once
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <mutex>
+#include <cmath>
+#include "common.hpp"
+#include "search.hpp"
+
+/*
+    @brief search types calibrated
+
+    TIME_CALIBRATION_COMPLETE   endgame search with 100% (complete search)
+    TIME_CALIBRATION_ENDGAME    endgame search with the lowest MPC level
+*/
+#define TIME_CALIBRATION_COMPLETE 0
+#define TIME_CALIBRATION_ENDGAME 1
+#define N_TIME_CALIBRATION_TYPES 2
+
+#define TIME_CALIBRATION_PROFILE_FILE "resources/time_profile.txt"
+#define TIME_CALIBRATION_MIN_TIME 100 // ms, shorter searches are too noisy
+#define TIME_CALIBRATION_NPS_RATE 0.3 // weight of a new NPS sample
+#define TIME_CALIBRATION_MIN_CONST_B 0.3 // node growth per depth must be at least exp(0.3)
+#define TIME_CALIBRATION_SAVE_INTERVAL 16 // in-play updates between saves
+
+const std::string time_calibration_type_names[N_TIME_CALIBRATION_TYPES] = {"complete", "endgame"};
+
+/*
+    @brief node growth curve of a search type
+
+    Nodes(depth) = a * exp(b * depth), fitted by least squares on mean log(nodes) per empty count
+
+    @param nps                  nodes per second
+    @param n_nps_samples        number of NPS samples (default NPS is used if 0)
+    @param const_a              a
+    @param const_b              b
+    @param n_samples            number of samples for each number of empties
+    @param sum_log_nodes        sum of log(nodes) for each number of empties
+*/
+struct Time_calibration_curve {
+    double nps;
+    int n_nps_samples;
+    double const_a;
+    double const_b;
+    int n_samples[HW2 + 1];
+    double sum_log_nodes[HW2 + 1];
+
+    void init(double default_nps, double default_const_a, double default_const_b) {
+        nps = default_nps;
+        n_nps_samples = 0;
+        const_a = default_const_a;
+        const_b = default_const_b;
+        for (int i = 0; i <= HW2; ++i) {
+            n_samples[i] = 0;
+            sum_log_nodes[i] = 0.0;
+        }
+    }
+
+    /*
+        @brief fit a and b to the samples
+
+        keeps b if samples exist only for one number of empties
+    */
+    void fit() {
+        double sw = 0.0, sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0;
+        int n_points = 0;
+        for (int i = 0; i <= HW2; ++i) {
+            if (n_samples[i]) {
+                double w = n_samples[i];
+                double y = sum_log_nodes[i] / n_samples[i];
+                sw += w;
+                sx += w * i;
+                sy += w * y;
+                sxx += w * i * i;
+                sxy += w * i * y;
+                ++n_points;
+            }
+        }
+        if (n_points == 0) {
+            return;
+        }
+        if (n_points >= 2) {
+            double b = (sw * sxy - sx * sy) / (sw * sxx - sx * sx);
+            if (b >= TIME_CALIBRATION_MIN_CONST_B) {
+                const_b = b;
+            }
+        }
+        const_a = exp((sy - const_b * sx) / sw);
+    }
+
+    void add(int n_empties, uint64_t n_nodes, uint64_t elapsed) {
+        if (n_nodes == 0) {
+            return;
+        }
+        ++n_samples[n_empties];
+        sum_log_nodes[n_empties] += log((double)n_nodes);
+        if (elapsed >= TIME_CALIBRATION_MIN_TIME) {
+            add_nps(n_nodes, elapsed);
+        }
+        fit();
+    }
+
+    void add_nps(uint64_t n_nodes, uint64_t elapsed) {
+        double sample_nps = (double)n_nodes * 1000.0 / elapsed;
+        if (n_nps_samples == 0) {
+            nps = sample_nps;
+        } else {
+            nps = (1.0 - TIME_CALIBRATION_NPS_RATE) * nps + TIME_CALIBRATION_NPS_RATE * sample_nps;
+        }
+        ++n_nps_samples;
+    }
+
+    /*
+        @brief deepest search finished in given time
+
+        @param msec                 time in ms
+        @return depth
+    */
+    double depth_for_time(double msec) const {
+        return log(msec / 1000.0 * nps / const_a) / const_b;
+    }
+
+    /*
+        @brief expected time of a search
+
+        @param depth                depth
+        @return time in ms
+    */
+    double time_for_depth(int depth) const {
+        return const_a * exp(const_b * depth) / nps * 1000.0;
+    }
+};
+
+/*
+    @brief calibration profile used by time management
+
+    Initialized with constants tuned on the developer's machine,
+    then updated by calibration runs (-timecalibration) and by searches during play.
+    Searches during play have a warm transposition table, so they update only NPS, not the node growth curve.
+*/
+class Time_calibration {
+    private:
+        std::mutex mtx;
+        Time_calibration_curve curves[N_TIME_CALIBRATION_TYPES];
+        std::string profile_file;
+        int n_unsaved_updates;
+
+    public:
+        Time_calibration() {
+            init();
+        }
+
+        void init() {
+            std::lock_guard<std::mutex> lock(mtx);
+            curves[TIME_CALIBRATION_COMPLETE].init(6.0e8, 0.70, 0.76);
+            curves[TIME_CALIBRATION_ENDGAME].init(3.5e8, 0.05, 0.62);
+            n_unsaved_updates = 0;
+        }
+
+        Time_calibration_curve get(int type) {
+            std::lock_guard<std::mutex> lock(mtx);
+            return curves[type];
+        }
+
+        bool has_samples() {
+            std::lock_guard<std::mutex> lock(mtx);
+            for (int type = 0; type < N_TIME_CALIBRATION_TYPES; ++type) {
+                for (int i = 0; i <= HW2; ++i) {
+                    if (curves[type].n_samples[i]) {
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+        /*
+            @brief add a finished endgame search
+
+            @param type                 TIME_CALIBRATION_*
+            @param n_empties            number of empties (= depth)
+            @param n_nodes              nodes searched
+            @param elapsed              time in ms
+        */
+        void add_sample(int type, int n_empties, uint64_t n_nodes, uint64_t elapsed) {
+            std::lock_guard<std::mutex> lock(mtx);
+            curves[type].add(n_empties, n_nodes, elapsed);
+            ++n_unsaved_updates;
+        }
+
+        /*
+            @brief update NPS with a search result during play
+
+            node counts are not added to the growth curve (transposition table is warm during play)
+
+            @param n_empties            number of empties of the root
+            @param result               result of time-limited search
+            @return profile changed?
+        */
+        bool update(int n_empties, const Search_result &result) {
+            if (result.depth == SEARCH_BOOK || !result.is_end_search || result.time < TIME_CALIBRATION_MIN_TIME) {
+                return false;
+            }
+            std::lock_guard<std::mutex> lock(mtx);
+            if (result.probability == 100 && result.depth == n_empties) {
+                curves[TIME_CALIBRATION_COMPLETE].add_nps(result.nodes, result.time);
+            } else {
+                curves[TIME_CALIBRATION_ENDGAME].add_nps(result.nodes, result.time);
+            }
+            ++n_unsaved_updates;
+            return true;
+        }
+
+        /*
+            @brief save profile if enough updates are not saved
+
+            @param min_n_updates        save if at least this number of updates are not saved
+            @return saved?
+        */
+        bool save_if_updated(int min_n_updates) {
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                if (n_unsaved_updates == 0 || n_unsaved_updates < min_n_updates) {
+                    return false;
+                }
+            }
+            return save();
+        }
+
+        void set_profile_file(std::string file) {
+            std::lock_guard<std::mutex> lock(mtx);
+            profile_file = file;
+        }
+
+        /*
+            @brief load profile
+
+            @return loaded?
+        */
+        bool load() {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (profile_file.empty()) {
+                return false;
+            }
+            std::ifstream ifs(profile_file);
+            if (ifs.fail()) {
+                return false;
+            }
+            Time_calibration_curve loaded[N_TIME_CALIBRATION_TYPES];
+            for (int type = 0; type < N_TIME_CALIBRATION_TYPES; ++type) {
+                loaded[type] = curves[type];
+            }
+            std::string line;
+            while (std::getline(ifs, line)) {
+                if (line.empty() || line[0] == '#') {
+                    continue;
+                }
+                std::istringstream iss(line);
+                std::string type_str, key;
+                iss >> type_str >> key;
+                int type = -1;
+                for (int i = 0; i < N_TIME_CALIBRATION_TYPES; ++i) {
+                    if (type_str == time_calibration_type_names[i]) {
+                        type = i;
+                    }
+                }
+                if (type == -1) {
+                    std::cerr << "[ERROR] time calibration profile broken " << line << std::endl;
+                    return false;
+                }
+                if (key == "nps") {
+                    iss >> loaded[type].nps >> loaded[type].n_nps_samples;
+                } else if (key == "a") {
+                    iss >> loaded[type].const_a;
+                } else if (key == "b") {
+                    iss >> loaded[type].const_b;
+                } else if (key == "empties") {
+                    int n_empties;
+                    iss >> n_empties;
+                    if (0 <= n_empties && n_empties <= HW2) {
+                        iss >> loaded[type].n_samples[n_empties] >> loaded[type].sum_log_nodes[n_empties];
+                    }
+                }
+                if (iss.fail()) {
+                    std::cerr << "[ERROR] time calibration profile broken " << line << std::endl;
+                    return false;
+                }
+            }
+            for (int type = 0; type < N_TIME_CALIBRATION_TYPES; ++type) {
+                if (loaded[type].nps <= 0.0 || loaded[type].const_a <= 0.0 || loaded[type].const_b <= 0.0) {
+                    std::cerr << "[ERROR] time calibration profile broken " << profile_file << std::endl;
+                    return false;
+                }
+                curves[type] = loaded[type];
+            }
+            return true;
+        }
+
+        /*
+            @brief save profile
+
+            @return saved?
+        */
+        bool save() {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (profile_file.empty()) {
+                return false;
+            }
+            std::ofstream ofs(profile_file);
+            if (ofs.fail()) {
+                return false;
+            }
+            ofs << "# Egaroucid time calibration profile" << std::endl;
+            ofs << "# <type> nps <nps> <n_samples> / a <a> / b <b> / empties <n_empties> <n_samples> <sum of log(nodes)>" << std::endl;
+            ofs.precision(10);
+            for (int type = 0; type < N_TIME_CALIBRATION_TYPES; ++type) {
+                const Time_calibration_curve &curve = curves[type];
+                ofs << time_calibration_type_names[type] << " nps " << curve.nps << " " << curve.n_nps_samples << std::endl;
+                ofs << time_calibration_type_names[type] << " a " << curve.const_a << std::endl;
+                ofs << time_calibration_type_names[type] << " b " << curve.const_b << std::endl;
+                for (int i = 0; i <= HW2; ++i) {
+                    if (curve.n_samples[i]) {
+                        ofs << time_calibration_type_names[type] << " empties " << i << " " << curve.n_samples[i] << " " << curve.sum_log_nodes[i] << std::endl;
+                    }
+                }
+            }
+            if (ofs.fail()) {
+                return false;
+            }
+            n_unsaved_updates = 0;
+            return true;
+        }
+
+        void print(std::ostream &os) {
+            std::lock_guard<std::mutex> lock(mtx);
+            for (int type = 0; type < N_TIME_CALIBRATION_TYPES; ++type) {
+                const Time_calibration_curve &curve = curves[type];
+                os << time_calibration_type_names[type] << " search: NPS " << (uint64_t)curve.nps << " (" << curve.n_nps_samples << " samples) nodes(depth) = " << curve.const_a << " * exp(" << curve.const_b << " * depth)" << std::endl;
+                for (int i = 0; i <= HW2; ++i) {
+                    if (curve.n_samples[i]) {
+                        os << "    " << i << " empties: " << curve.n_samples[i] << " samples, mean nodes " << (uint64_t)exp(curve.sum_log_nodes[i] / curve.n_samples[i]) << ", expected time " << (uint64_t)curve.time_for_depth(i) << " ms" << std::endl;
+                    }
+                }
+                os << "    depth in 1s " << curve.depth_for_time(1000.0) << " in 10s " << curve.depth_for_time(10000.0) << " in 60s " << curve.depth_for_time(60000.0) << std::endl;
+            }
+        }
+};
+
+Time_calibration time_calibration;
@@ -9,7 +9,11 @@
 */
 
 #pragma once
+#include <random>
+#include <future>
+#include <chrono>
 #include "ai.hpp"
+#include "time_calibration.hpp"
 
 
 constexpr int TIME_MANAGEMENT_INITIAL_N_EMPTIES = 46;
@@ -19,7 +23,12 @@ constexpr int TIME_MANAGEMENT_INITIAL_N_EMPTIES = 46;
 #define TIME_MANAGEMENT_REMAINING_MOVES_OFFSET 13 // 13 * 2 = 26 moves
 #define TIME_MANAGEMENT_N_MOVES_COE 0.9 // 10% early break
 
+#define TIME_CALIBRATION_MIN_N_EMPTIES 10
+#define TIME_CALIBRATION_MAX_N_EMPTIES 36
+#define TIME_CALIBRATION_SEED 1
+
 Search_result ai(Board board, int level, bool use_book, int book_acc_level, bool use_multi_thread, bool show_log);
+inline Search_result tree_search_legal(Board board, int alpha, int beta, int depth, uint_fast8_t mpc_level, bool show_log, uint64_t use_legal, bool use_multi_thread, uint64_t time_limit, bool *searching);
 
 uint64_t calc_time_limit_ply(const Board board, uint64_t remaining_time_msec, bool show_log) {
     int n_empties = HW2 - board.n_discs();
@@ -42,20 +51,14 @@ uint64_t calc_time_limit_ply(const Board board, uint64_t remaining_time_msec, bo
 #endif
 
     // try complete search
-    // Nodes(depth) = a * exp(b * depth)
-    constexpr double complete_const_a = 0.70; //2.1747;
-    constexpr double complete_const_b = 0.76;
-    constexpr double complete_nps = 6.0e8;
+    // Nodes(depth) = a * exp(b * depth), calibrated
     double complete_use_time = (double)remaining_time_msec_margin * 0.9;
-    double complete_search_depth = log(complete_use_time / 1000.0 * complete_nps / complete_const_a) / complete_const_b;
+    double complete_search_depth = time_calibration.get(TIME_CALIBRATION_COMPLETE).depth_for_time(complete_use_time);
 
     // try endgame search
-    // Nodes(depth) = a * exp(b * depth)
-    constexpr double endgame_const_a = 0.05; //1.8654;
-    constexpr double endgame_const_b = 0.62;
-    constexpr double endgame_nps = 3.5e8;
+    // Nodes(depth) = a * exp(b * depth), calibrated
     double endgame_use_time = (double)remaining_time_msec_margin * 0.15;
-    double endgame_search_depth = log(endgame_use_time / 1000.0 * endgame_nps / endgame_const_a) / endgame_const_b;
+    double endgame_search_depth = time_calibration.get(TIME_CALIBRATION_ENDGAME).depth_for_time(endgame_use_time);
 
     if (show_log) {
         std::cerr << "complete search depth " << complete_search_depth << " endgame search depth " << endgame_search_depth << " n_empties " << n_empties << std::endl;
@@ -88,6 +91,15 @@ uint64_t request_more_time(Board board, uint64_t remaining_time_msec, uint64_t t
         remaining_time_msec_margin = 1;
     }
     std::cerr << "requesting more time remaining " << remaining_time_msec << " remaining_margin " << remaining_time_msec_margin << " now tl " << time_limit << std::endl;
+    // complete search can be finished with a bit more time
+    double complete_time = time_calibration.get(TIME_CALIBRATION_COMPLETE).time_for_depth(n_empties);
+    if (time_limit < complete_time && complete_time < remaining_time_msec_margin * 0.9) {
+        uint64_t complete_time_limit = std::min<uint64_t>(complete_time * 1.2, remaining_time_msec_margin * 0.9);
+        if (show_log) {
+            std::cerr << "additional time for complete search " << complete_time_limit - time_limit << std::endl;
+        }
+        return complete_time_limit;
+    }
     if (remaining_time_msec_margin > time_limit) {
         int remaining_moves_proc = std::max(2, (int)round((remaining_moves - TIME_MANAGEMENT_REMAINING_MOVES_OFFSET) * TIME_MANAGEMENT_N_MOVES_COE)); // at least 2 moves
         uint64_t additional_time = (remaining_time_msec_margin - time_limit) / remaining_moves_proc * 0.4;
@@ -135,4 +147,77 @@ void time_management_selfplay(Board board, bool show_log, uint64_t use_legal, ui
     if (show_log) {
         std::cerr << "self play count " << count << std::endl;
     }
-}
\ No newline at end of file
+}
+
+/*
+    @brief measure NPS and node growth of endgame searches
+
+    Positions are made by random play with a fixed seed.
+    Each number of empties is searched completely and with the lowest MPC level,
+    going deeper while the expected time fits in the time budget.
+
+    @param time_budget          time budget in ms
+    @param use_multi_thread     search in multi thread?
+    @param show_log             show log?
+*/
+void time_calibration_run(uint64_t time_budget, bool use_multi_thread, bool show_log) {
+    uint64_t strt = tim();
+    std::mt19937 engine(TIME_CALIBRATION_SEED);
+    Flip flip;
+    for (int n_empties = TIME_CALIBRATION_MIN_N_EMPTIES; n_empties <= TIME_CALIBRATION_MAX_N_EMPTIES; n_empties += 2) {
+        for (int type = 0; type < N_TIME_CALIBRATION_TYPES; ++type) {
+            uint64_t elapsed = tim() - strt;
+            double expected_time = time_calibration.get(type).time_for_depth(n_empties);
+            if (elapsed >= time_budget || (time_calibration.has_samples() && elapsed + expected_time > time_budget)) {
+                if (show_log) {
+                    std::cerr << "time calibration finished at " << n_empties << " empties in " << elapsed << " ms" << std::endl;
+                }
+                return;
+            }
+            Board board;
+            do {
+                board.reset();
+                while (HW2 - board.n_discs() > n_empties) {
+                    uint64_t legal = board.get_legal();
+                    if (legal == 0) {
+                        board.pass();
+                        legal = board.get_legal();
+                        if (legal == 0) {
+                            break;
+                        }
+                    }
+                    int n_legal = pop_count_ull(legal);
+                    int idx = std::uniform_int_distribution<int>(0, n_legal - 1)(engine);
+                    for (int i = 0; i < idx; ++i) {
+                        legal &= legal - 1;
+                    }
+                    calc_flip(&flip, &board, ctz(legal));
+                    board.move_board(&flip);
+                }
+                if (board.get_legal() == 0) {
+                    board.pass();
+                }
+            } while (HW2 - board.n_discs() != n_empties || board.get_legal() == 0);
+            uint_fast8_t mpc_level = (type == TIME_CALIBRATION_COMPLETE) ? MPC_100_LEVEL : MPC_74_LEVEL;
+            bool searching = true;
+            transposition_table.init();
+            uint64_t search_strt = tim();
+            std::future<Search_result> search_future = std::async(std::launch::async, tree_search_legal, board, -SCORE_MAX, SCORE_MAX, n_empties, mpc_level, false, board.get_legal(), use_multi_thread, TIME_LIMIT_INF, &searching);
+            if (search_future.wait_for(std::chrono::milliseconds(time_budget - elapsed)) != std::future_status::ready) {
+                searching = false;
+                search_future.get();
+                if (show_log) {
+                    std::cerr << "time calibration terminated at " << n_empties << " empties by time budget" << std::endl;
+                }
+                return;
+            }
+            Search_result result = search_future.get();
+            uint64_t search_time = tim() - search_strt;
+            uint64_t n_nodes = result.nodes + result.clog_nodes;
+            time_calibration.add_sample(type, n_empties, n_nodes, search_time);
+            if (show_log) {
+                std::cerr << "time calibration " << time_calibration_type_names[type] << " " << n_empties << " empties nodes " << n_nodes << " time " << search_time << " ms (expected " << (uint64_t)expected_time << " ms)" << std::endl;
+            }
+        }
+    }
+}
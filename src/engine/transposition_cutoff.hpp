@@ -19,12 +19,24 @@ constexpr int MID_ETC_DEPTH_NWS = 16;
 inline bool transposition_cutoff(Search *search, const uint32_t hash_code, int depth, int *alpha, int *beta, int *v, uint_fast8_t moves[]) {
     int lower = -SCORE_MAX, upper = SCORE_MAX;
     transposition_table.get(search, hash_code, depth, &lower, &upper, moves);
+#if USE_SEARCH_STATISTICS
+    search_statistics_count(SEARCH_STATISTICS_TT_PROBE, depth);
+    if (lower != -SCORE_MAX || upper != SCORE_MAX) {
+        search_statistics_count(SEARCH_STATISTICS_TT_HIT, depth);
+    }
+#endif
     if (upper == lower || upper <= *alpha) {
         *v = upper;
+#if USE_SEARCH_STATISTICS
+        search_statistics_count(SEARCH_STATISTICS_TT_CUTOFF, depth);
+#endif
         return true;
     }
     if (*beta <= lower) {
         *v = lower;
+#if USE_SEARCH_STATISTICS
+        search_statistics_count(SEARCH_STATISTICS_TT_CUTOFF, depth);
+#endif
         return true;
     }
     if (*alpha < lower) {
@@ -40,14 +52,26 @@ inline bool transposition_cutoff_bestmove(Search *search, const uint32_t hash_co
     int lower = -SCORE_MAX, upper = SCORE_MAX;
     uint_fast8_t moves[N_TRANSPOSITION_MOVES];
     transposition_table.get(search, hash_code, depth, &lower, &upper, moves);
+#if USE_SEARCH_STATISTICS
+    search_statistics_count(SEARCH_STATISTICS_TT_PROBE, depth);
+    if (lower != -SCORE_MAX || upper != SCORE_MAX) {
+        search_statistics_count(SEARCH_STATISTICS_TT_HIT, depth);
+    }
+#endif
     if (upper == lower || upper <= *alpha) {
         *v = upper;
         *best_move = moves[0];
+#if USE_SEARCH_STATISTICS
+        search_statistics_count(SEARCH_STATISTICS_TT_CUTOFF, depth);
+#endif
         return true;
     }
     if (*beta <= lower) {
         *v = lower;
         *best_move = moves[0];
+#if USE_SEARCH_STATISTICS
+        search_statistics_count(SEARCH_STATISTICS_TT_CUTOFF, depth);
+#endif
         return true;
     }
     if (*alpha < lower) {
@@ -62,12 +86,24 @@ inline bool transposition_cutoff_bestmove(Search *search, const uint32_t hash_co
 inline bool transposition_cutoff_nws(Search *search, const uint32_t hash_code, int depth, int alpha, int *v, uint_fast8_t moves[]) {
     int lower = -SCORE_MAX, upper = SCORE_MAX;
     transposition_table.get(search, hash_code, depth, &lower, &upper, moves);
+#if USE_SEARCH_STATISTICS
+    search_statistics_count(SEARCH_STATISTICS_TT_PROBE, depth);
+    if (lower != -SCORE_MAX || upper != SCORE_MAX) {
+        search_statistics_count(SEARCH_STATISTICS_TT_HIT, depth);
+    }
+#endif
     if (upper == lower || upper <= alpha) {
         *v = upper;
+#if USE_SEARCH_STATISTICS
+        search_statistics_count(SEARCH_STATISTICS_TT_CUTOFF, depth);
+#endif
         return true;
     }
     if (alpha < lower) {
         *v = lower;
+#if USE_SEARCH_STATISTICS
+        search_statistics_count(SEARCH_STATISTICS_TT_CUTOFF, depth);
+#endif
         return true;
     }
     return false;
@@ -76,12 +112,24 @@ inline bool transposition_cutoff_nws(Search *search, const uint32_t hash_code, i
 inline bool transposition_cutoff_nws(Search *search, const uint32_t hash_code, int depth, int alpha, int *v) {
     int lower = -SCORE_MAX, upper = SCORE_MAX;
     transposition_table.get_bounds(search, hash_code, depth, &lower, &upper);
+#if USE_SEARCH_STATISTICS
+    search_statistics_count(SEARCH_STATISTICS_TT_PROBE, depth);
+    if (lower != -SCORE_MAX || upper != SCORE_MAX) {
+        search_statistics_count(SEARCH_STATISTICS_TT_HIT, depth);
+    }
+#endif
     if (upper == lower || upper <= alpha) {
         *v = upper;
+#if USE_SEARCH_STATISTICS
+        search_statistics_count(SEARCH_STATISTICS_TT_CUTOFF, depth);
+#endif
         return true;
     }
     if (alpha < lower) {
         *v = lower;
+#if USE_SEARCH_STATISTICS
+        search_statistics_count(SEARCH_STATISTICS_TT_CUTOFF, depth);
+#endif
         return true;
     }
     return false;
@@ -91,14 +139,26 @@ inline bool transposition_cutoff_nws_bestmove(Search *search, const uint32_t has
     int lower = -SCORE_MAX, upper = SCORE_MAX;
     uint_fast8_t moves[N_TRANSPOSITION_MOVES];
     transposition_table.get(search, hash_code, depth, &lower, &upper, moves);
+#if USE_SEARCH_STATISTICS
+    search_statistics_count(SEARCH_STATISTICS_TT_PROBE, depth);
+    if (lower != -SCORE_MAX || upper != SCORE_MAX) {
+        search_statistics_count(SEARCH_STATISTICS_TT_HIT, depth);
+    }
+#endif
     if (upper == lower || upper <= alpha) {
         *v = upper;
         *best_move = moves[0];
+#if USE_SEARCH_STATISTICS
+        search_statistics_count(SEARCH_STATISTICS_TT_CUTOFF, depth);
+#endif
         return true;
     }
     if (alpha < lower) {
         *v = lower;
         *best_move = moves[0];
+#if USE_SEARCH_STATISTICS
+        search_statistics_count(SEARCH_STATISTICS_TT_CUTOFF, depth);
+#endif
         return true;
     }
     return false;
@@ -113,8 +173,11 @@ inline bool transposition_cutoff_nws_bestmove(Search *search, const uint32_t has
     @param hash_level           new hash level
     @return hash resized?
 */
-inline bool etc(Search *search, std::vector<Flip_value> &move_list, int depth, int *alpha, int *beta, int *v, int *n_etc_done) {
+inline bool etc(Search *search, Move_list &move_list, int depth, int *alpha, int *beta, int *v, int *n_etc_done) {
     *n_etc_done = 0;
+#if USE_SEARCH_STATISTICS
+    search_statistics_count(SEARCH_STATISTICS_ETC_PROBE, depth);
+#endif
     int l, u, n_beta = *alpha;
     for (Flip_value &flip_value: move_list) {
         l = -SCORE_MAX;
@@ -126,6 +189,9 @@ inline bool etc(Search *search, std::vector<Flip_value> &move_list, int depth, i
         search->undo(&flip_value.flip);
         if (*beta <= -u) { // alpha < beta <= -u <= -l
             *v = -u;
+#if USE_SEARCH_STATISTICS
+            search_statistics_count(SEARCH_STATISTICS_ETC_CUTOFF, depth);
+#endif
             return true; // fail high
         } else if (*alpha <= -u && -u < *beta) { // alpha <= -u <= beta <= -l or alpha <= -u <= -l <= beta
             *alpha = -u; // update alpha (alpha <= -u)
@@ -152,8 +218,11 @@ inline bool etc(Search *search, std::vector<Flip_value> &move_list, int depth, i
     @param hash_level           new hash level
     @return hash resized?
 */
-inline bool etc_nws(Search *search, std::vector<Flip_value> &move_list, int depth, int alpha, int *v, int *n_etc_done) {
+inline bool etc_nws(Search *search, Move_list &move_list, int depth, int alpha, int *v, int *n_etc_done) {
     *n_etc_done = 0;
+#if USE_SEARCH_STATISTICS
+    search_statistics_count(SEARCH_STATISTICS_ETC_PROBE, depth);
+#endif
     int l, u;
     for (Flip_value &flip_value: move_list) {
         l = -SCORE_MAX;
@@ -165,6 +234,9 @@ inline bool etc_nws(Search *search, std::vector<Flip_value> &move_list, int dept
         search->undo(&flip_value.flip);
         if (alpha < -u) { // fail high at parent node
             *v = -u;
+#if USE_SEARCH_STATISTICS
+            search_statistics_count(SEARCH_STATISTICS_ETC_CUTOFF, depth);
+#endif
             return true;
         }
         if (-alpha <= l) { // fail high at child node
@@ -15,11 +15,17 @@
 #include "thread_pool.hpp"
 #include "spinlock.hpp"
 #include "search.hpp"
+#include "transposition_table_common.hpp"
+#include "search_statistics.hpp"
+#include "large_page.hpp"
 #include <future>
 #include <functional>
 
 //#define USE_TT_DEPTH_THRESHOLD 0
 
+#if TT_USE_BUCKET
+#include "transposition_table_bucket.hpp"
+#else
 /*
     @brief constants
 */
@@ -27,224 +33,6 @@ constexpr int TRANSPOSITION_TABLE_N_LOOP = 3;
 #if TT_USE_STACK
 constexpr size_t TRANSPOSITION_TABLE_STACK_SIZE = hash_sizes[DEFAULT_HASH_LEVEL] + TRANSPOSITION_TABLE_N_LOOP - 1;
 #endif
-constexpr int N_TRANSPOSITION_MOVES = 2;
-constexpr double TT_REGISTER_THRESHOLD_RATE = 0.3;
-
-constexpr int TRANSPOSITION_TABLE_HAS_NODE = 100;
-constexpr int TRANSPOSITION_TABLE_NOT_HAS_NODE = -100;
-
-bool transposition_table_auto_reset_importance = true;
-
-inline uint32_t get_level_common(uint8_t depth, uint8_t mpc_level) {
-    return ((uint32_t)depth << 8) | mpc_level;
-}
-
-inline uint32_t get_level_common(int depth, uint_fast8_t mpc_level) {
-    return ((uint32_t)depth << 8) | mpc_level;
-}
-
-/*
-    @brief Hash data
-
-    @param date                 search date (to rewrite old entry)  more important
-    @param depth                depth                                      |
-    @param mpc_level            MPC level                           less important
-    @param lower                lower bound
-    @param upper                upper bound
-    @param moves                best moves
-*/
-class Hash_data {
-    private:
-        union {
-            // little endian
-            struct {
-                uint8_t mpc_level;
-                uint8_t depth;
-            } c;
-            uint16_t level;
-        } level;
-        uint8_t importance;
-        int8_t lower;
-        int8_t upper;
-        uint8_t moves[N_TRANSPOSITION_MOVES];
-
-    public:
-
-        //Hash_data()
-        //    : lower(-SCORE_MAX), upper(SCORE_MAX), moves({MOVE_UNDEFINED, MOVE_UNDEFINED}), level({0, 0}), importance(0) {}
-        
-        /*
-            @brief Initialize a node
-        */
-        inline void init() {
-            lower = -SCORE_MAX;
-            upper = SCORE_MAX;
-            moves[0] = MOVE_UNDEFINED;
-            moves[1] = MOVE_UNDEFINED;
-            level.c.mpc_level = 0;
-            level.c.depth = 0;
-            importance = 0;
-        }
-
-        /*
-            @brief Register value (same level)
-
-            @param alpha                alpha bound
-            @param beta                 beta bound
-            @param value                best value
-            @param policy               best move
-        */
-        inline void reg_same_level(const int alpha, const int beta, const int value, const int policy) {
-            if (value < beta && value < upper) {
-                upper = (int8_t)value;
-                if (alpha < value && value < lower) {
-                    lower = value;
-                }
-            }
-            if (alpha < value && lower < value) {
-                lower = (int8_t)value;
-                if (value < beta && upper < value) {
-                    upper = value;
-                }
-            }
-            if ((alpha < value || value == -SCORE_MAX) && moves[0] != policy && is_valid_policy(policy)) {
-                moves[1] = moves[0];
-                moves[0] = (uint8_t)policy;
-            }
-            importance = 1;
-        }
-
-        /*
-            @brief Register value (level increase)
-
-            update best moves, reset other data
-
-            @param d                    depth
-            @param ml                   MPC level
-            @param dt                   date
-            @param alpha                alpha bound
-            @param beta                 beta bound
-            @param value                best value
-            @param policy               best move
-        */
-        inline void reg_new_level(const int d, const uint_fast8_t ml, const int alpha, const int beta, const int value, const int policy) {
-            if (value < beta) {
-                upper = (int8_t)value;
-            } else {
-                upper = SCORE_MAX;
-            }
-            if (alpha < value) {
-                lower = (int8_t)value;
-            } else {
-                lower = -SCORE_MAX;
-            }
-            if ((alpha < value || value == -SCORE_MAX) && moves[0] != policy && is_valid_policy(policy)) {
-                moves[1] = moves[0];
-                moves[0] = policy;
-            }
-            level.c.depth = d;
-            level.c.mpc_level = ml;
-            importance = 1;
-        }
-
-        /*
-            @brief Register value (new board)
-
-            update best moves, reset other data
-
-            @param d                    depth
-            @param ml                   MPC level
-            @param dt                   date
-            @param alpha                alpha bound
-            @param beta                 beta bound
-            @param value                best value
-            @param policy               best move
-        */
-        inline void reg_new_data(const int d, const uint_fast8_t ml, const int alpha, const int beta, const int value, const int policy) {
-            if (value < beta) {
-                upper = (int8_t)value;
-            } else {
-                upper = SCORE_MAX;
-            }
-            if (alpha < value) {
-                lower = (int8_t)value;
-            } else {
-                lower = -SCORE_MAX;
-            }
-            if ((alpha < value || value == -SCORE_MAX) && moves[0] != policy) {
-                moves[0] = policy;
-            } else {
-                moves[0] = MOVE_UNDEFINED;
-            }
-            moves[1] = MOVE_UNDEFINED;
-            level.c.depth = d;
-            level.c.mpc_level = ml;
-            importance = 1;
-        }
-
-        /*
-            @brief Get level of the element
-
-            @return level
-        */
-        inline uint32_t get_level() {
-            if (importance) {
-                //return get_level_common(depth, mpc_level);
-                return level.level;
-            }
-            return 0;
-        }
-
-        /*
-            @brief Get level of the element
-
-            @return level
-        */
-        inline uint32_t get_level_no_importance() {
-            //return get_level_common(depth, mpc_level);
-            return level.level;
-        }
-
-        inline int get_window_width() {
-            return upper - lower;
-        }
-
-        /*
-            @brief Get moves
-
-            @param res_moves            array to store result
-        */
-        inline void get_moves(uint_fast8_t res_moves[]) {
-            res_moves[0] = moves[0];
-            res_moves[1] = moves[1];
-        }
-
-        /*
-            @brief Get bounds
-
-            @param l                    lower bound
-            @param u                    upper bound
-        */
-        inline void get_bounds(int *l, int *u) {
-            *l = lower;
-            *u = upper;
-        }
-
-        /*
-            @brief Reset date
-        */
-        inline void set_importance_zero() {
-            importance = 0;
-        }
-
-        inline uint8_t get_mpc_level() {
-            return level.c.mpc_level;
-        }
-
-        inline uint8_t get_importance() const {
-            return importance;
-        }
-};
 
 struct Hash_node {
     Board board;
@@ -261,6 +49,8 @@ struct Hash_node {
     }
 };
 
+constexpr size_t TRANSPOSITION_TABLE_NODE_SIZE = sizeof(Hash_node);
+
 /*
     @brief Initialize transposition table in parallel
 
@@ -293,18 +83,6 @@ void init_transposition_table(Hash_node table[], size_t s, size_t e) {
 #endif
 }
 
-/*
-    @brief Resetting date in parallel
-
-    @param table                transposition table
-    @param s                    start index
-    @param e                    end index
-*/
-void set_importance_zero_transposition_table(Hash_node table[], size_t s, size_t e) {
-    for(size_t i = s; i < e; ++i) {
-        table[i].data.set_importance_zero();
-    }
-}
 /*
 #if TUNE_MOVE_ORDERING_MID || TUNE_MOVE_ORDERING_END
 class Transposition_table{
@@ -353,10 +131,13 @@ class Transposition_table {
 #endif
 #if USE_CHANGEABLE_HASH_LEVEL || !TT_USE_STACK
         Hash_node *table_heap;
+        Large_page_memory table_heap_memory;
 #endif
         size_t table_size;
+        int page_type;
         std::atomic<uint64_t> n_registered;
         uint64_t n_registered_threshold;
+        std::atomic<uint8_t> date;
 
     public:
         /*
@@ -364,9 +145,9 @@ class Transposition_table {
         */
         Transposition_table() 
 #if USE_CHANGEABLE_HASH_LEVEL || !TT_USE_STACK
-            : table_heap(nullptr), table_size(0), n_registered(0), n_registered_threshold(0) {}
+            : table_heap(nullptr), table_size(0), page_type(LARGE_PAGE_NONE), n_registered(0), n_registered_threshold(0), date(tt_next_date(TT_DATE_EMPTY)) {}
 #else
-            : table_size(0), n_registered(0), n_registered_threshold(0) {}
+            : table_size(0), page_type(LARGE_PAGE_NONE), n_registered(0), n_registered_threshold(0), date(tt_next_date(TT_DATE_EMPTY)) {}
 #endif
 
 #if USE_CHANGEABLE_HASH_LEVEL
@@ -379,35 +160,69 @@ class Transposition_table {
         inline bool resize(int hash_level) {
             size_t n_table_size = hash_sizes[hash_level] + TRANSPOSITION_TABLE_N_LOOP - 1;
             table_size = 0;
-            if (table_heap != nullptr) {
-                free(table_heap);
-                table_heap = nullptr;
-            }
+            table_heap_memory.release();
+            table_heap = nullptr;
             #if TT_USE_STACK
+                page_type = LARGE_PAGE_NONE;
+                if (TT_USE_LARGE_PAGE) {
+                    large_page_advise(table_stack, sizeof(table_stack)); // already touched by the constructor, collapsed later by khugepaged
+                }
                 if (n_table_size > TRANSPOSITION_TABLE_STACK_SIZE) {
-                    table_heap = (Hash_node*)malloc(sizeof(Hash_node) * (n_table_size - TRANSPOSITION_TABLE_STACK_SIZE));
+                    table_heap = (Hash_node*)table_heap_memory.allocate(sizeof(Hash_node) * (n_table_size - TRANSPOSITION_TABLE_STACK_SIZE), TT_USE_LARGE_PAGE);
                     if (table_heap == nullptr)
                         return false;
+                    page_type = table_heap_memory.get_page_type();
                 }
             #else
-                table_heap = (Hash_node*)malloc(sizeof(Hash_node) * n_table_size);
+                table_heap = (Hash_node*)table_heap_memory.allocate(sizeof(Hash_node) * n_table_size, TT_USE_LARGE_PAGE);
                 if (table_heap == nullptr)
                     return false;
+                page_type = table_heap_memory.get_page_type();
             #endif
             table_size = n_table_size;
             n_registered_threshold = table_size * TT_REGISTER_THRESHOLD_RATE;
+            place_memory();
             init();
             return true;
         }
 #else // USE_CHANGEABLE_HASH_LEVEL
         inline bool set_size() {
             table_size = TRANSPOSITION_TABLE_STACK_SIZE;
+            if (TT_USE_LARGE_PAGE) {
+                large_page_advise(table_stack, sizeof(table_stack)); // already touched by the constructor, collapsed later by khugepaged
+            }
             n_registered_threshold = table_size * TT_REGISTER_THRESHOLD_RATE;
+            place_memory();
             init();
             return true;
         }
 #endif // USE_CHANGEABLE_HASH_LEVEL
 
+        /*
+            @brief page type of the (largest part of) table
+
+            @return LARGE_PAGE_*
+        */
+        inline int get_page_type() const {
+            return page_type;
+        }
+
+        /*
+            @brief Place table on NUMA nodes following numa_memory_policy
+        */
+        inline void place_memory() {
+#if TT_USE_STACK
+            numa_place_memory(table_stack, sizeof(Hash_node) * std::min(table_size, (size_t)TRANSPOSITION_TABLE_STACK_SIZE), numa_memory_policy);
+#if USE_CHANGEABLE_HASH_LEVEL
+            if (table_size > TRANSPOSITION_TABLE_STACK_SIZE) {
+                numa_place_memory(table_heap, sizeof(Hash_node) * (table_size - TRANSPOSITION_TABLE_STACK_SIZE), numa_memory_policy);
+            }
+#endif // USE_CHANGEABLE_HASH_LEVEL
+#else // TT_USE_STACK
+            numa_place_memory(table_heap, sizeof(Hash_node) * table_size, numa_memory_policy);
+#endif // TT_USE_STACK
+        }
+
         /*
             @brief Initialize transposition table
         */
@@ -482,7 +297,9 @@ class Transposition_table {
         }
 
         /*
-            @brief set all date to 0
+            @brief make all entries old
+
+            the date is increased, entries are overwritten by later registrations
         */
         inline void reset_importance() {
             std::lock_guard lock(mtx);
@@ -490,49 +307,31 @@ class Transposition_table {
         }
 
         /*
-            @brief set all date to 0
+            @brief current date
+        */
+        inline uint8_t get_date() const {
+            return date.load(std::memory_order_relaxed);
+        }
+
+        /*
+            @brief occupancy by age and depth
 
-            create new thread
+            scans the whole table, use it while not searching
         */
-        inline void reset_importance_new_thread(int thread_size) {
-            size_t s, e;
-            std::vector<std::future<void>> tasks;
-#if TT_USE_STACK
-            size_t delta = (std::min(table_size, (size_t)TRANSPOSITION_TABLE_STACK_SIZE) + thread_size - 1) / thread_size;
-            s = 0;
-            for (int i = 0; i < thread_size; ++i) {
-                e = std::min(std::min(table_size, (size_t)TRANSPOSITION_TABLE_STACK_SIZE), s + delta);
-                tasks.emplace_back(std::async(std::launch::async, std::bind(&set_importance_zero_transposition_table, table_stack, s, e)));
-                s = e;
-            }
-#if USE_CHANGEABLE_HASH_LEVEL
-            if (table_size > TRANSPOSITION_TABLE_STACK_SIZE) {
-                delta = (table_size - (size_t)TRANSPOSITION_TABLE_STACK_SIZE + thread_size - 1) / thread_size;
-                s = 0;
-                for (int i = 0; i < thread_size; ++i) {
-                    e = std::min(table_size - (size_t)TRANSPOSITION_TABLE_STACK_SIZE, s + delta);
-                    tasks.emplace_back(std::async(std::launch::async, std::bind(&set_importance_zero_transposition_table, table_heap, s, e)));
-                    s = e;
-                }
-            }
-#endif // USE_CHANGEABLE_HASH_LEVEL
-#else // TT_USE_STACK
-            size_t delta = (table_size + thread_size - 1) / thread_size;
-            s = 0;
-            for (int i = 0; i < thread_size; ++i) {
-                e = std::min(table_size, s + delta);
-                tasks.emplace_back(std::async(std::launch::async, std::bind(&set_importance_zero_transposition_table, table_heap, s, e)));
-                s = e;
+        inline Transposition_table_occupancy get_occupancy() {
+            Transposition_table_occupancy res;
+            const uint8_t dt = get_date();
+            for (size_t i = 0; i < table_size; ++i) {
+                res.add(&get_node(i)->data, dt);
             }
-#endif // TT_USE_STACK
-            for (std::future<void> &task: tasks)
-                task.get();
-            n_registered = 0;
+            return res;
         }
 
         /*
             @brief Register items
 
+            slots are chosen by transposition_table_replacement_policy
+
             @param search               Search information
             @param hash                 hash code
             @param depth                depth
@@ -540,97 +339,72 @@ class Transposition_table {
             @param beta                 beta bound
             @param value                best score
             @param policy               best move
-            @param cost                 search cost (log2(nodes))
         */
         inline void reg(const Search *search, uint32_t hash, const int depth, int alpha, int beta, int value, int policy) {
             Hash_node *node = get_node(hash);
             const uint32_t level = get_level_common(depth, search->mpc_level);
+            const uint8_t dt = get_date();
+            const int replacement_policy = transposition_table_replacement_policy;
             uint32_t node_level;
-#if TT_REGISTER_MIN_LEVEL
-            Hash_node *min_level_node = nullptr;
-            uint32_t min_level = 0x4fffffff;
-            bool registered = false;
+            Hash_node *replace_node = nullptr;
+            uint32_t replace_level = 0xffffffff;
+#if USE_SEARCH_STATISTICS
+            search_statistics_count(SEARCH_STATISTICS_TT_STORE, depth);
 #endif
             for (uint_fast8_t i = 0; i < TRANSPOSITION_TABLE_N_LOOP; ++i) {
-                if (node->data.get_level() <= level) {
+                const bool always_replace = replacement_policy == TT_REPLACEMENT_ALWAYS || (replacement_policy == TT_REPLACEMENT_TWO_TIER && i == TRANSPOSITION_TABLE_N_LOOP - 1);
+                if (always_replace || node->data.get_level(dt) <= level) {
                     node->lock.lock();
-                        node_level = node->data.get_level();
-                        if (node_level <= level) {
-                            if (node->board.player == search->board.player && node->board.opponent == search->board.opponent) {
+                        node_level = node->data.get_level(dt);
+                        if (node->board.player == search->board.player && node->board.opponent == search->board.opponent) {
+                            if (node_level <= level || replacement_policy == TT_REPLACEMENT_ALWAYS) {
                                 if (node_level == level)
-                                    node->data.reg_same_level(alpha, beta, value, policy);
+                                    node->data.reg_same_level(dt, alpha, beta, value, policy);
                                 else
-                                    node->data.reg_new_level(depth, search->mpc_level, alpha, beta, value, policy);
+                                    node->data.reg_new_level(depth, search->mpc_level, dt, alpha, beta, value, policy);
                                 node->lock.unlock();
-#if TT_REGISTER_MIN_LEVEL
-                                registered = true;
+#if USE_SEARCH_STATISTICS
+                                search_statistics_count(SEARCH_STATISTICS_TT_STORE_UPDATE, depth);
 #endif
+                                replace_node = nullptr;
                                 break;
-                            } else{
-#if TT_REGISTER_MIN_LEVEL
-                                if (node_level < min_level) {
-                                    min_level = node_level;
-                                    min_level_node = node;
-                                }
-#else
-                                if (node->data.get_importance() == 0) {
-                                    n_registered.fetch_add(1);
-                                }
-                                node->board.player = search->board.player;
-                                node->board.opponent = search->board.opponent;
-                                node->data.reg_new_data(depth, search->mpc_level, alpha, beta, value, policy);
-                                node->lock.unlock();
-                                //if (node_level > 0) {
-                                //    n_registered.fetch_add(1);
-                                //}
-                                break;
-#endif
                             }
+                        } else if (replacement_policy == TT_REPLACEMENT_ALWAYS) {
+                            if (node_level < replace_level) {
+                                replace_level = node_level;
+                                replace_node = node;
+                            }
+                        } else if (always_replace || node_level <= level) {
+                            reg_new_board(node, search, depth, dt, alpha, beta, value, policy);
+                            node->lock.unlock();
+                            break;
                         }
                     node->lock.unlock();
                 }
                 ++hash;
                 node = get_node(hash);
             }
-#if TT_REGISTER_MIN_LEVEL
-            if (!registered && min_level_node != nullptr) {
-                min_level_node->lock.lock();
-                    min_level_node->board.player = search->board.player;
-                    min_level_node->board.opponent = search->board.opponent;
-                    min_level_node->data.reg_new_data(depth, search->mpc_level, alpha, beta, value, policy);
-                    if (min_level_node->data.get_level() > 0) {
-                        n_registered.fetch_add(1);
-                    }
-                min_level_node->lock.unlock();
+            if (replace_node != nullptr) {
+                replace_node->lock.lock();
+                    reg_new_board(replace_node, search, depth, dt, alpha, beta, value, policy);
+                replace_node->lock.unlock();
             }
-#endif
             if (n_registered >= n_registered_threshold && transposition_table_auto_reset_importance) {
                 std::lock_guard lock(mtx);
                 if (n_registered >= n_registered_threshold) {
-                    //std::cerr << "resetting transposition importance" << std::endl;
                     reset_importance_proc();
                 }
             }
         }
 
-
         inline void reg_overwrite(const Search *search, uint32_t hash, const int depth, int alpha, int beta, int value, int policy) {
             Hash_node *node = get_node(hash);
-            //const uint32_t level = get_level_common(depth, search->mpc_level);
-            uint32_t node_level;
-#if TT_REGISTER_MIN_LEVEL
-            Hash_node *min_level_node = nullptr;
-            uint32_t min_level = 0x4fffffff;
-            bool registered = false;
-#endif
+            const uint8_t dt = get_date();
             for (uint_fast8_t i = 0; i < TRANSPOSITION_TABLE_N_LOOP; ++i) {
                 node->lock.lock();
                     if (node->board.player == search->board.player && node->board.opponent == search->board.opponent) {
-                        node->data.reg_new_level(depth, search->mpc_level, alpha, beta, value, policy);
+                        node->data.reg_new_level(depth, search->mpc_level, dt, alpha, beta, value, policy);
                         node->lock.unlock();
-#if TT_REGISTER_MIN_LEVEL
-                        registered = true;
-#endif
                         break;
                     }
                 node->lock.unlock();
@@ -640,7 +414,6 @@ class Transposition_table {
             if (n_registered >= n_registered_threshold && transposition_table_auto_reset_importance) {
                 std::lock_guard lock(mtx);
                 if (n_registered >= n_registered_threshold) {
-                    //std::cerr << "resetting transposition importance" << std::endl;
                     reset_importance_proc();
                 }
             }
@@ -907,27 +680,39 @@ class Transposition_table {
 #endif // TT_USE_STACK
         }
 
-        inline void reset_importance_proc() {
-            //std::cerr << "importance reset n_registered " << n_registered << " threshold " << n_registered_threshold << " table_size " << table_size << std::endl;
-#if TT_USE_STACK
-            for (size_t i = 0; i < std::min(table_size, (size_t)TRANSPOSITION_TABLE_STACK_SIZE); ++i) {
-                table_stack[i].data.set_importance_zero();
-            }
-#if USE_CHANGEABLE_HASH_LEVEL
-            if (table_size > TRANSPOSITION_TABLE_STACK_SIZE) {
-                for (size_t i = 0; i < table_size - (size_t)TRANSPOSITION_TABLE_STACK_SIZE; ++i)
-                    table_heap[i].data.set_importance_zero();
+        /*
+            @brief register a new board to a locked node
+
+            @param node                 node to overwrite
+        */
+        inline void reg_new_board(Hash_node *node, const Search *search, const int depth, const uint8_t dt, int alpha, int beta, int value, int policy) {
+#if USE_SEARCH_STATISTICS
+            if (node->data.get_level(dt) == 0) {
+                search_statistics_count(SEARCH_STATISTICS_TT_STORE_EMPTY, depth);
+            } else {
+                search_statistics_count(SEARCH_STATISTICS_TT_STORE_EVICT, depth);
             }
-#endif // USE_CHANGEABLE_HASH_LEVEL
-#else // TT_USE_STACK
-            for (size_t i = 0; i < table_size; ++i) {
-                table_heap[i].data.set_importance_zero();
+#endif
+            if (node->data.get_date() != dt) {
+                n_registered.fetch_add(1);
             }
-#endif // TT_USE_STACK
+            node->board.player = search->board.player;
+            node->board.opponent = search->board.opponent;
+            node->data.reg_new_data(depth, search->mpc_level, dt, alpha, beta, value, policy);
+        }
+
+        /*
+            @brief make all entries old
+
+            only the date is increased, the table is not touched
+        */
+        inline void reset_importance_proc() {
+            date.store(tt_next_date(get_date()), std::memory_order_relaxed);
             n_registered.store(0);
         }
 };
 //#endif
+#endif // TT_USE_BUCKET
 
 Transposition_table transposition_table;
 
@@ -962,8 +747,8 @@ bool hash_resize(int hash_level_failed, int hash_level, bool show_log) {
     global_hash_level = hash_level;
     global_hash_bit_mask = (1U << global_hash_level) - 1;
     if (show_log) {
-        double size_mb = (double)sizeof(Hash_node) / 1024 / 1024 * hash_sizes[hash_level];
-        std::cerr << "hash resized to level " << hash_level << " elements " << hash_sizes[hash_level] << " size " << size_mb << " MB" << std::endl;
+        double size_mb = (double)TRANSPOSITION_TABLE_NODE_SIZE / 1024 / 1024 * hash_sizes[hash_level];
+        std::cerr << "hash resized to level " << hash_level << " elements " << hash_sizes[hash_level] << " size " << size_mb << " MB page " << large_page_names[transposition_table.get_page_type()] << std::endl;
     }
     return true;
 }
@@ -995,8 +780,8 @@ bool hash_resize(int hash_level_failed, int hash_level, std::string binary_path,
     global_hash_level = hash_level;
     global_hash_bit_mask = (1U << global_hash_level) - 1;
     if (show_log) {
-        double size_mb = (double)sizeof(Hash_node) / 1024 / 1024 * hash_sizes[hash_level];
-        std::cerr << "hash resized to level " << hash_level << " elements " << hash_sizes[hash_level] << " size " << size_mb << " MB" << std::endl;
+        double size_mb = (double)TRANSPOSITION_TABLE_NODE_SIZE / 1024 / 1024 * hash_sizes[hash_level];
+        std::cerr << "hash resized to level " << hash_level << " elements " << hash_sizes[hash_level] << " size " << size_mb << " MB page " << large_page_names[transposition_table.get_page_type()] << std::endl;
     }
     return true;
 }
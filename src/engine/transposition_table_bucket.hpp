@@ -0,0 +1,536 @@
+/*
+    Egaroucid Project
+
+    @file transposition_table_bucket.hpp
+        Transposition table with 64-byte buckets and lockless entries
+    @date 2021-2025
+    @author Takuto Yamana
+    @license GPL-3.0 license
+    @notice lockless hashing idea from https://craftychess.com/hyatt/hashing.html
+*/
+
+#pragma once
+#include <atomic>
+#include <cstring>
+#include <new>
+#include <future>
+#include <functional>
+#include "setting.hpp"
+#include "common.hpp"
+#include "board.hpp"
+#include "thread_pool.hpp"
+#include "search.hpp"
+#include "large_page.hpp"
+#include "transposition_table_common.hpp"
+#include "search_statistics.hpp"
+
+/*
+    @brief constants
+
+    one bucket is one cache line, one probe is one cache miss
+*/
+constexpr int TRANSPOSITION_TABLE_CACHE_LINE_SIZE = 64;
+constexpr int TRANSPOSITION_TABLE_BUCKET_N_ENTRIES = 4;
+
+static_assert(sizeof(Hash_data) <= sizeof(uint64_t), "Hash_data must fit in 64 bits");
+
+/*
+    @brief convert Hash_data to / from 64 bit word
+*/
+inline uint64_t hash_data_to_word(const Hash_data *data) {
+    uint64_t res = 0;
+    memcpy(&res, data, sizeof(Hash_data));
+    return res;
+}
+
+inline void hash_data_from_word(uint64_t word, Hash_data *data) {
+    memcpy(data, &word, sizeof(Hash_data));
+}
+
+/*
+    @brief 64 bit check key of a board
+
+    full boards (128 bits) don't fit 4 entries in a cache line, so a 64 bit mix of the board is stored.
+    The mix is independent of Board::hash() (bucket index),
+    a false match needs a 64 bit collision in the same bucket.
+
+    @param board                board
+    @return check key
+*/
+inline uint64_t hash_entry_key(const Board *board) {
+    uint64_t h = board->player * 0x9E3779B97F4A7C15ULL;
+    h ^= h >> 32;
+    h += board->opponent;
+    h *= 0xC2B2AE3D27D4EB4FULL;
+    h ^= h >> 29;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 32;
+    return h;
+}
+
+/*
+    @brief Lockless hash entry
+
+    the key word is XORed with the data word,
+    so an entry torn by concurrent writes doesn't match any board
+
+    @param key                  check key ^ data
+    @param data                 Hash_data as a word
+*/
+struct Hash_entry {
+    std::atomic<uint64_t> key;
+    std::atomic<uint64_t> data;
+
+    inline void store(const uint64_t k, const Hash_data *d) {
+        const uint64_t w = hash_data_to_word(d);
+        data.store(w, std::memory_order_relaxed);
+        key.store(k ^ w, std::memory_order_relaxed);
+    }
+
+    inline void load(uint64_t *k, Hash_data *d) const {
+        const uint64_t w = data.load(std::memory_order_relaxed);
+        *k = key.load(std::memory_order_relaxed) ^ w;
+        hash_data_from_word(w, d);
+    }
+
+    inline bool load_if_match(const uint64_t k, Hash_data *d) const {
+        const uint64_t w = data.load(std::memory_order_relaxed);
+        if ((key.load(std::memory_order_relaxed) ^ w) == k) {
+            hash_data_from_word(w, d);
+            return true;
+        }
+        return false;
+    }
+
+    inline bool match(const uint64_t k) const {
+        return (key.load(std::memory_order_relaxed) ^ data.load(std::memory_order_relaxed)) == k;
+    }
+
+    void init() {
+        Hash_data d;
+        d.init();
+        store(0ULL, &d); // key of no board
+    }
+};
+
+struct alignas(TRANSPOSITION_TABLE_CACHE_LINE_SIZE) Hash_bucket {
+    Hash_entry entries[TRANSPOSITION_TABLE_BUCKET_N_ENTRIES];
+};
+
+static_assert(sizeof(Hash_bucket) == TRANSPOSITION_TABLE_CACHE_LINE_SIZE, "Hash_bucket must be one cache line");
+
+/*
+    @brief memory used per hash element
+
+    one bucket holds TRANSPOSITION_TABLE_BUCKET_N_ENTRIES elements
+*/
+constexpr size_t TRANSPOSITION_TABLE_NODE_SIZE = sizeof(Hash_bucket) / TRANSPOSITION_TABLE_BUCKET_N_ENTRIES;
+
+/*
+    @brief Initialize transposition table in parallel
+
+    @param table                transposition table
+    @param s                    start index
+    @param e                    end index
+*/
+void init_transposition_table(Hash_bucket table[], size_t s, size_t e) {
+    for (size_t i = s; i < e; ++i) {
+        for (int j = 0; j < TRANSPOSITION_TABLE_BUCKET_N_ENTRIES; ++j) {
+            table[i].entries[j].init();
+        }
+    }
+}
+
+/*
+    @brief Bucketed transposition table
+
+    @param table                buckets (aligned to cache line)
+    @param n_buckets            number of buckets
+    @param table_size           total table size (number of entries)
+*/
+class Transposition_table {
+    private:
+        std::mutex mtx;
+        Hash_bucket *table;
+        Large_page_memory table_memory;
+        size_t n_buckets;
+        size_t table_size;
+        std::atomic<uint64_t> n_registered;
+        uint64_t n_registered_threshold;
+        std::atomic<uint8_t> date;
+
+    public:
+        /*
+            @brief Constructor of transposition table
+        */
+        Transposition_table()
+            : table(nullptr), n_buckets(0), table_size(0), n_registered(0), n_registered_threshold(0), date(tt_next_date(TT_DATE_EMPTY)) {}
+
+#if USE_CHANGEABLE_HASH_LEVEL
+        /*
+            @brief Resize transposition table
+
+            @param hash_level           hash level representing the size
+            @return table initialized?
+        */
+        inline bool resize(int hash_level) {
+            return allocate(hash_level);
+        }
+#else // USE_CHANGEABLE_HASH_LEVEL
+        inline bool set_size() {
+            return allocate(DEFAULT_HASH_LEVEL);
+        }
+#endif // USE_CHANGEABLE_HASH_LEVEL
+
+        /*
+            @brief page type of the table
+
+            @return LARGE_PAGE_*
+        */
+        inline int get_page_type() const {
+            return table_memory.get_page_type();
+        }
+
+        /*
+            @brief Initialize transposition table
+        */
+        inline void init() {
+            int thread_size = thread_pool.size();
+            if (thread_size == 0) {
+                init_transposition_table(table, 0, n_buckets);
+            } else {
+                size_t s = 0, e;
+                size_t delta = (n_buckets + thread_size - 1) / thread_size;
+                std::vector<std::future<void>> tasks;
+                for (int i = 0; i < thread_size; ++i) {
+                    e = std::min(n_buckets, s + delta);
+                    bool pushed = false;
+                    while (!pushed) {
+                        tasks.emplace_back(thread_pool.push(&pushed, std::bind(&init_transposition_table, table, s, e)));
+                        if (!pushed)
+                            tasks.pop_back();
+                    }
+                    s = e;
+                }
+                for (std::future<void> &task: tasks) {
+                    task.get();
+                }
+            }
+            n_registered.store(0);
+        }
+
+        /*
+            @brief make all entries old
+
+            the date is increased, entries are overwritten by later registrations
+        */
+        inline void reset_importance() {
+            std::lock_guard lock(mtx);
+            reset_importance_proc();
+        }
+
+        /*
+            @brief current date
+        */
+        inline uint8_t get_date() const {
+            return date.load(std::memory_order_relaxed);
+        }
+
+        /*
+            @brief occupancy by age and depth
+
+            scans the whole table, use it while not searching
+        */
+        inline Transposition_table_occupancy get_occupancy() {
+            Transposition_table_occupancy res;
+            const uint8_t dt = get_date();
+            uint64_t key;
+            Hash_data data;
+            for (size_t i = 0; i < n_buckets; ++i) {
+                for (int j = 0; j < TRANSPOSITION_TABLE_BUCKET_N_ENTRIES; ++j) {
+                    table[i].entries[j].load(&key, &data);
+                    res.add(&data, dt);
+                }
+            }
+            return res;
+        }
+
+        /*
+            @brief Register items
+
+            if the board is in the bucket, update it,
+            else replace an entry chosen by transposition_table_replacement_policy
+
+            @param search               Search information
+            @param hash                 hash code
+            @param depth                depth
+            @param alpha                alpha bound
+            @param beta                 beta bound
+            @param value                best score
+            @param policy               best move
+        */
+        inline void reg(const Search *search, uint32_t hash, const int depth, int alpha, int beta, int value, int policy) {
+            Hash_bucket *bucket = get_bucket(hash);
+            const uint32_t level = get_level_common(depth, search->mpc_level);
+            const uint8_t dt = get_date();
+            const int replacement_policy = transposition_table_replacement_policy;
+            Hash_entry *replace_entry = nullptr;
+            uint32_t replace_level = replacement_policy == TT_REPLACEMENT_DEPTH_PREFERRED ? level + 1 : 0xffffffff;
+            uint8_t replace_date = TT_DATE_EMPTY;
+            const uint64_t board_key = hash_entry_key(&search->board);
+            uint64_t key;
+            Hash_data data;
+#if USE_SEARCH_STATISTICS
+            search_statistics_count(SEARCH_STATISTICS_TT_STORE, depth);
+#endif
+            for (int i = 0; i < TRANSPOSITION_TABLE_BUCKET_N_ENTRIES; ++i) {
+                Hash_entry *entry = &bucket->entries[i];
+                entry->load(&key, &data);
+                const uint32_t entry_level = data.get_level(dt);
+                if (key == board_key) {
+                    if (entry_level <= level || replacement_policy == TT_REPLACEMENT_ALWAYS) {
+                        if (entry_level == level) {
+                            data.reg_same_level(dt, alpha, beta, value, policy);
+                        } else {
+                            if (data.get_date() != dt) {
+                                n_registered.fetch_add(1, std::memory_order_relaxed);
+                            }
+                            data.reg_new_level(depth, search->mpc_level, dt, alpha, beta, value, policy);
+                        }
+                        entry->store(board_key, &data);
+#if USE_SEARCH_STATISTICS
+                        search_statistics_count(SEARCH_STATISTICS_TT_STORE_UPDATE, depth);
+#endif
+                    }
+                    replace_entry = nullptr;
+                    break;
+                }
+                if (replacement_policy == TT_REPLACEMENT_TWO_TIER) {
+                    if (i < TRANSPOSITION_TABLE_BUCKET_N_ENTRIES - 1) { // depth-preferred entries
+                        if (entry_level <= level && replace_level > level) {
+                            replace_level = entry_level;
+                            replace_entry = entry;
+                            replace_date = data.get_date();
+                        }
+                    } else if (replace_level > level) { // always-replace entry
+                        replace_level = entry_level;
+                        replace_entry = entry;
+                        replace_date = data.get_date();
+                    }
+                } else if (entry_level < replace_level) {
+                    replace_level = entry_level;
+                    replace_entry = entry;
+                    replace_date = data.get_date();
+                }
+            }
+            if (replace_entry != nullptr) {
+                if (replace_date != dt) {
+                    n_registered.fetch_add(1, std::memory_order_relaxed);
+                }
+#if USE_SEARCH_STATISTICS
+                if (replace_level == 0) {
+                    search_statistics_count(SEARCH_STATISTICS_TT_STORE_EMPTY, depth);
+                } else {
+                    search_statistics_count(SEARCH_STATISTICS_TT_STORE_EVICT, depth);
+                }
+#endif
+                data.init();
+                data.reg_new_data(depth, search->mpc_level, dt, alpha, beta, value, policy);
+                replace_entry->store(board_key, &data);
+            }
+            check_reset_importance();
+        }
+
+        inline void reg_overwrite(const Search *search, uint32_t hash, const int depth, int alpha, int beta, int value, int policy) {
+            Hash_bucket *bucket = get_bucket(hash);
+            const uint64_t board_key = hash_entry_key(&search->board);
+            Hash_data data;
+            for (int i = 0; i < TRANSPOSITION_TABLE_BUCKET_N_ENTRIES; ++i) {
+                Hash_entry *entry = &bucket->entries[i];
+                if (entry->load_if_match(board_key, &data)) {
+                    data.reg_new_level(depth, search->mpc_level, get_date(), alpha, beta, value, policy);
+                    entry->store(board_key, &data);
+                    break;
+                }
+            }
+            check_reset_importance();
+        }
+
+        /*
+            @brief get best move from transposition table
+
+            @param search               Search information
+            @param hash                 hash code
+            @param depth                depth
+            @param lower                lower bound to store
+            @param upper                upper bound to store
+            @param moves                best moves to store
+        */
+        inline void get(const Search *search, const uint32_t hash, const int depth, int *lower, int *upper, uint_fast8_t moves[]) {
+            Hash_data data;
+            if (find(&search->board, hash, &data)) {
+                data.get_moves(moves);
+                if (data.get_level_no_importance() >= get_level_common(depth, search->mpc_level)) {
+                    data.get_bounds(lower, upper);
+                }
+            }
+        }
+
+        /*
+            @brief get bounds from transposition table
+
+            @param search               Search information
+            @param hash                 hash code
+            @param depth                depth
+            @param lower                lower bound to store
+            @param upper                upper bound to store
+        */
+        inline bool get_bounds(const Search *search, uint32_t hash, int depth, int *lower, int *upper) {
+            Hash_data data;
+            if (find(&search->board, hash, &data)) {
+                if (data.get_level_no_importance() >= get_level_common(depth, search->mpc_level)) {
+                    data.get_bounds(lower, upper);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        inline bool get_bounds_any_level(const Search *search, uint32_t hash, int *lower, int *upper) {
+            return get_bounds_any_level(&search->board, hash, lower, upper);
+        }
+
+        inline bool get_bounds_any_level(const Board *board, uint32_t hash, int *lower, int *upper) {
+            Hash_data data;
+            if (find(board, hash, &data)) {
+                data.get_bounds(lower, upper);
+                return true;
+            }
+            return false;
+        }
+
+        inline bool get_moves_any_level(const Board *board, uint32_t hash, uint_fast8_t moves[]) {
+            Hash_data data;
+            if (find(board, hash, &data)) {
+                data.get_moves(moves);
+                return true;
+            }
+            return false;
+        }
+
+        inline void del(const Board *board, uint32_t hash) {
+            Hash_bucket *bucket = get_bucket(hash);
+            const uint64_t board_key = hash_entry_key(board);
+            for (int i = 0; i < TRANSPOSITION_TABLE_BUCKET_N_ENTRIES; ++i) {
+                if (bucket->entries[i].match(board_key)) {
+                    bucket->entries[i].init();
+                }
+            }
+        }
+
+        inline bool has_node(const Search *search, uint32_t hash, int depth) {
+            Hash_data data;
+            if (find(&search->board, hash, &data)) {
+                return data.get_level_no_importance() >= get_level_common(depth, search->mpc_level);
+            }
+            return false;
+        }
+
+        inline bool has_node_any_level(const Search *search, uint32_t hash) {
+            Hash_bucket *bucket = get_bucket(hash);
+            const uint64_t board_key = hash_entry_key(&search->board);
+            for (int i = 0; i < TRANSPOSITION_TABLE_BUCKET_N_ENTRIES; ++i) {
+                if (bucket->entries[i].match(board_key)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        inline int has_node_any_level_cutoff(const Search *search, uint32_t hash, int depth, int alpha, int beta) {
+            Hash_data data;
+            int res = TRANSPOSITION_TABLE_NOT_HAS_NODE;
+            if (find(&search->board, hash, &data)) {
+                res = TRANSPOSITION_TABLE_HAS_NODE;
+                if (data.get_level_no_importance() >= get_level_common(depth, search->mpc_level)) {
+                    int l, u;
+                    data.get_bounds(&l, &u);
+                    if (u <= alpha) {
+                        res = u;
+                    } else if (beta <= l) {
+                        res = l;
+                    }
+                }
+            }
+            return res;
+        }
+
+        inline bool has_node_any_level_get_bounds(const Search *search, uint32_t hash, int depth, int* l, int* u) {
+            Hash_data data;
+            if (find(&search->board, hash, &data)) {
+                if (data.get_level_no_importance() >= get_level_common(depth, search->mpc_level)) {
+                    data.get_bounds(l, u);
+                }
+                return true;
+            }
+            return false;
+        }
+
+        inline void prefetch(uint32_t hash) {
+#if USE_SIMD
+            _mm_prefetch((char const *)get_bucket(hash), _MM_HINT_T0);
+#endif
+        }
+
+    private:
+        inline bool allocate(int hash_level) {
+            size_t n_n_buckets = std::max<size_t>(1, hash_sizes[hash_level] / TRANSPOSITION_TABLE_BUCKET_N_ENTRIES);
+            n_buckets = 0;
+            table_size = 0;
+            table_memory.release();
+            table = (Hash_bucket*)table_memory.allocate(sizeof(Hash_bucket) * n_n_buckets, TT_USE_LARGE_PAGE); // page aligned
+            if (table == nullptr) {
+                return false;
+            }
+            n_buckets = n_n_buckets;
+            table_size = n_buckets * TRANSPOSITION_TABLE_BUCKET_N_ENTRIES;
+            n_registered_threshold = table_size * TT_REGISTER_THRESHOLD_RATE;
+            numa_place_memory(table, sizeof(Hash_bucket) * n_buckets, numa_memory_policy);
+            init();
+            return true;
+        }
+
+        inline Hash_bucket* get_bucket(const uint32_t hash) {
+            return &table[(hash / TRANSPOSITION_TABLE_BUCKET_N_ENTRIES) & (n_buckets - 1)];
+        }
+
+        inline bool find(const Board *board, const uint32_t hash, Hash_data *data) {
+            Hash_bucket *bucket = get_bucket(hash);
+            const uint64_t board_key = hash_entry_key(board);
+            for (int i = 0; i < TRANSPOSITION_TABLE_BUCKET_N_ENTRIES; ++i) {
+                if (bucket->entries[i].load_if_match(board_key, data)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        inline void check_reset_importance() {
+            if (n_registered >= n_registered_threshold && transposition_table_auto_reset_importance) {
+                std::lock_guard lock(mtx);
+                if (n_registered >= n_registered_threshold) {
+                    reset_importance_proc();
+                }
+            }
+        }
+
+        /*
+            @brief make all entries old
+
+            only the date is increased, the table is not touched
+        */
+        inline void reset_importance_proc() {
+            date.store(tt_next_date(get_date()), std::memory_order_relaxed);
+            n_registered.store(0);
+        }
+};
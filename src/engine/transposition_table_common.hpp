@@ -0,0 +1,339 @@
+/*
+    Egaroucid Project
+
+    @file transposition_table_common.hpp
+        Transposition table common data
+    @date 2021-2025
+    @author Takuto Yamana
+    @license GPL-3.0 license
+*/
+
+#pragma once
+#include <string>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include "setting.hpp"
+#include "common.hpp"
+#include "board.hpp"
+#include "search.hpp"
+
+/*
+    @brief constants
+*/
+constexpr int N_TRANSPOSITION_MOVES = 2;
+constexpr double TT_REGISTER_THRESHOLD_RATE = 0.3;
+
+constexpr int TRANSPOSITION_TABLE_HAS_NODE = 100;
+constexpr int TRANSPOSITION_TABLE_NOT_HAS_NODE = -100;
+
+bool transposition_table_auto_reset_importance = true;
+
+/*
+    @brief date (generation) of transposition table
+
+    date 0 is used only for entries without date, so dates cycle in 1 to TT_N_DATE - 1.
+    An entry is important only if its date is the current date.
+    Increasing the date makes all entries unimportant at once, the table is never swept.
+    Ages are taken modulo the cycle, so an entry last written TT_N_DATE - 1 resets ago looks current again.
+    This is harmless: its data is still valid for its board, it is only kept a little longer.
+*/
+constexpr int TT_N_DATE = 256;
+constexpr uint8_t TT_DATE_EMPTY = 0;
+
+inline uint8_t tt_next_date(uint8_t date) {
+    return date == TT_N_DATE - 1 ? 1 : date + 1;
+}
+
+/*
+    @brief age of an entry (0: current date)
+*/
+inline int tt_get_age(uint8_t date, uint8_t entry_date) {
+    return ((int)date - (int)entry_date + TT_N_DATE - 1) % (TT_N_DATE - 1);
+}
+
+/*
+    @brief replacement policy
+
+    TT_REPLACEMENT_DEPTH_PREFERRED  store in the first slot with level lower than or equal to the new one, drop the new data if none
+    TT_REPLACEMENT_ALWAYS           always store, replace the slot with the lowest level
+    TT_REPLACEMENT_TWO_TIER         depth-preferred slots and the last slot is always replaced
+    (old entries have level 0 in all policies)
+*/
+#define TT_REPLACEMENT_DEPTH_PREFERRED 0
+#define TT_REPLACEMENT_ALWAYS 1
+#define TT_REPLACEMENT_TWO_TIER 2
+#define N_TT_REPLACEMENT_POLICY 3
+
+const std::string tt_replacement_policy_names[N_TT_REPLACEMENT_POLICY] = {"depth", "always", "twotier"};
+
+int transposition_table_replacement_policy = TT_REPLACEMENT_DEPTH_PREFERRED;
+
+inline uint32_t get_level_common(uint8_t depth, uint8_t mpc_level) {
+    return ((uint32_t)depth << 8) | mpc_level;
+}
+
+inline uint32_t get_level_common(int depth, uint_fast8_t mpc_level) {
+    return ((uint32_t)depth << 8) | mpc_level;
+}
+
+/*
+    @brief Hash data
+
+    @param date                 search date (to rewrite old entry)  more important
+    @param depth                depth                                      |
+    @param mpc_level            MPC level                           less important
+    @param lower                lower bound
+    @param upper                upper bound
+    @param moves                best moves
+*/
+class Hash_data {
+    private:
+        union {
+            // little endian
+            struct {
+                uint8_t mpc_level;
+                uint8_t depth;
+            } c;
+            uint16_t level;
+        } level;
+        uint8_t date;
+        int8_t lower;
+        int8_t upper;
+        uint8_t moves[N_TRANSPOSITION_MOVES];
+
+    public:
+
+        //Hash_data()
+        //    : lower(-SCORE_MAX), upper(SCORE_MAX), moves({MOVE_UNDEFINED, MOVE_UNDEFINED}), level({0, 0}), importance(0) {}
+        
+        /*
+            @brief Initialize a node
+        */
+        inline void init() {
+            lower = -SCORE_MAX;
+            upper = SCORE_MAX;
+            moves[0] = MOVE_UNDEFINED;
+            moves[1] = MOVE_UNDEFINED;
+            level.c.mpc_level = 0;
+            level.c.depth = 0;
+            date = TT_DATE_EMPTY;
+        }
+
+        /*
+            @brief Register value (same level)
+
+            @param dt                   date
+            @param alpha                alpha bound
+            @param beta                 beta bound
+            @param value                best value
+            @param policy               best move
+        */
+        inline void reg_same_level(const uint8_t dt, const int alpha, const int beta, const int value, const int policy) {
+            if (value < beta && value < upper) {
+                upper = (int8_t)value;
+                if (alpha < value && value < lower) {
+                    lower = value;
+                }
+            }
+            if (alpha < value && lower < value) {
+                lower = (int8_t)value;
+                if (value < beta && upper < value) {
+                    upper = value;
+                }
+            }
+            if ((alpha < value || value == -SCORE_MAX) && moves[0] != policy && is_valid_policy(policy)) {
+                moves[1] = moves[0];
+                moves[0] = (uint8_t)policy;
+            }
+            date = dt;
+        }
+
+        /*
+            @brief Register value (level increase)
+
+            update best moves, reset other data
+
+            @param d                    depth
+            @param ml                   MPC level
+            @param dt                   date
+            @param alpha                alpha bound
+            @param beta                 beta bound
+            @param value                best value
+            @param policy               best move
+        */
+        inline void reg_new_level(const int d, const uint_fast8_t ml, const uint8_t dt, const int alpha, const int beta, const int value, const int policy) {
+            if (value < beta) {
+                upper = (int8_t)value;
+            } else {
+                upper = SCORE_MAX;
+            }
+            if (alpha < value) {
+                lower = (int8_t)value;
+            } else {
+                lower = -SCORE_MAX;
+            }
+            if ((alpha < value || value == -SCORE_MAX) && moves[0] != policy && is_valid_policy(policy)) {
+                moves[1] = moves[0];
+                moves[0] = policy;
+            }
+            level.c.depth = d;
+            level.c.mpc_level = ml;
+            date = dt;
+        }
+
+        /*
+            @brief Register value (new board)
+
+            update best moves, reset other data
+
+            @param d                    depth
+            @param ml                   MPC level
+            @param dt                   date
+            @param alpha                alpha bound
+            @param beta                 beta bound
+            @param value                best value
+            @param policy               best move
+        */
+        inline void reg_new_data(const int d, const uint_fast8_t ml, const uint8_t dt, const int alpha, const int beta, const int value, const int policy) {
+            if (value < beta) {
+                upper = (int8_t)value;
+            } else {
+                upper = SCORE_MAX;
+            }
+            if (alpha < value) {
+                lower = (int8_t)value;
+            } else {
+                lower = -SCORE_MAX;
+            }
+            if ((alpha < value || value == -SCORE_MAX) && moves[0] != policy) {
+                moves[0] = policy;
+            } else {
+                moves[0] = MOVE_UNDEFINED;
+            }
+            moves[1] = MOVE_UNDEFINED;
+            level.c.depth = d;
+            level.c.mpc_level = ml;
+            date = dt;
+        }
+
+        /*
+            @brief Get level of the element
+
+            @param dt                   current date
+            @return level (0 if the element is old)
+        */
+        inline uint32_t get_level(const uint8_t dt) {
+            if (date == dt) {
+                //return get_level_common(depth, mpc_level);
+                return level.level;
+            }
+            return 0;
+        }
+
+        /*
+            @brief Get level of the element
+
+            @return level
+        */
+        inline uint32_t get_level_no_importance() {
+            //return get_level_common(depth, mpc_level);
+            return level.level;
+        }
+
+        inline int get_window_width() {
+            return upper - lower;
+        }
+
+        /*
+            @brief Get moves
+
+            @param res_moves            array to store result
+        */
+        inline void get_moves(uint_fast8_t res_moves[]) {
+            res_moves[0] = moves[0];
+            res_moves[1] = moves[1];
+        }
+
+        /*
+            @brief Get bounds
+
+            @param l                    lower bound
+            @param u                    upper bound
+        */
+        inline void get_bounds(int *l, int *u) {
+            *l = lower;
+            *u = upper;
+        }
+
+        inline uint8_t get_mpc_level() {
+            return level.c.mpc_level;
+        }
+
+        inline uint8_t get_date() const {
+            return date;
+        }
+
+        inline uint8_t get_depth() const {
+            return level.c.depth;
+        }
+};
+
+/*
+    @brief occupancy of transposition table
+
+    @param n_entries            number of entries
+    @param n_empty              entries without date (never used)
+    @param n_age                used entries by age (the last one includes older entries)
+    @param n_depth              entries of the current date by depth
+*/
+constexpr int TT_OCCUPANCY_N_AGE = 4;
+
+struct Transposition_table_occupancy {
+    uint64_t n_entries;
+    uint64_t n_empty;
+    uint64_t n_age[TT_OCCUPANCY_N_AGE];
+    uint64_t n_depth[HW2 + 1];
+
+    Transposition_table_occupancy()
+        : n_entries(0), n_empty(0) {
+        for (int i = 0; i < TT_OCCUPANCY_N_AGE; ++i) {
+            n_age[i] = 0;
+        }
+        for (int i = 0; i <= HW2; ++i) {
+            n_depth[i] = 0;
+        }
+    }
+
+    void add(const Hash_data *data, uint8_t date) {
+        ++n_entries;
+        if (data->get_date() == TT_DATE_EMPTY) {
+            ++n_empty;
+            return;
+        }
+        int age = tt_get_age(date, data->get_date());
+        ++n_age[std::min(age, TT_OCCUPANCY_N_AGE - 1)];
+        if (age == 0) {
+            ++n_depth[std::min<int>(data->get_depth(), HW2)];
+        }
+    }
+
+    void print(std::ostream &out) const {
+        auto ratio = [&](uint64_t n) {
+            return n_entries ? 100.0 * n / n_entries : 0.0;
+        };
+        out << std::fixed << std::setprecision(1);
+        out << "entries " << n_entries << " empty " << ratio(n_empty) << "%";
+        for (int i = 0; i < TT_OCCUPANCY_N_AGE; ++i) {
+            out << " age " << i << (i == TT_OCCUPANCY_N_AGE - 1 ? "+ " : " ") << ratio(n_age[i]) << "%";
+        }
+        out << std::endl;
+        out << "current entries by depth";
+        for (int i = 0; i <= HW2; ++i) {
+            if (n_depth[i]) {
+                out << " " << i << ":" << ratio(n_depth[i]) << "%";
+            }
+        }
+        out << std::defaultfloat << std::endl;
+    }
+};
@@ -10,6 +10,8 @@
 
 #pragma once
 #include <iostream>
+#include <atomic>
+#include <functional>
 #include "setting.hpp"
 #include "common.hpp"
 #include "search.hpp"
@@ -31,42 +33,117 @@ constexpr int YBWC_N_YOUNGER_CHILD = 1;
 // constexpr int YBWC_MAX_RUNNING_COUNT = 5;
 constexpr int YBWC_NOT_PUSHED = -124;
 constexpr int YBWC_PUSHED = 124;
+constexpr int YBWC_SPLIT_POOL_SIZE = 256;
 
-int nega_alpha_ordering_nws(Search *search, int alpha, const int depth, const bool skipped, uint64_t legal, const bool is_end_search, std::vector<bool*> &searchings);
-inline bool is_searching(std::vector<bool*> &searchings);
+int nega_alpha_ordering_nws(Search *search, int alpha, const int depth, const bool skipped, uint64_t legal, const bool is_end_search, const Search_flag_chain *searchings);
 
 /*
-    @brief Wrapper for parallel NWS (Null Window Search)
+    @brief YBWC split record
+
+    fixed-size record drawn from a per-thread pool, so a split needs no heap allocation
 
     @param player               a bitboard representing player
     @param opponent             a bitboard representing opponent
     @param n_discs              number of discs on the board
     @param parity               parity of the board
     @param mpc_level            MPC (Multi-ProbCut) probability level
-    @param alpha                alpha value
+    @param is_presearch         is presearch?
+    @param parent_alpha         alpha value of the parent node
     @param depth                remaining depth
     @param legal                for use of previously calculated legal bitboard
     @param is_end_search        search till the end?
     @param policy               the last move
-    @param searching            flag for terminating this search
-    @return the result in Parallel_task structure
+    @param move_idx             index of the move in the parent's move list
+    @param searchings           flags for terminating this search
+    @param n_searching          flag of the parent node
+    @param result               the result in Parallel_task structure
+    @param done                 result available?
+*/
+struct Ybwc_split_task {
+    uint64_t player;
+    uint64_t opponent;
+    int_fast8_t n_discs;
+    uint_fast8_t parity;
+    uint_fast8_t mpc_level;
+    bool is_presearch;
+    int parent_alpha;
+    int depth;
+    uint64_t legal;
+    bool is_end_search;
+    uint_fast8_t policy;
+    int move_idx;
+    const Search_flag_chain *searchings;
+    bool *n_searching;
+    Parallel_task result;
+    std::atomic<bool> done;
+};
+
+/*
+    @brief Per-thread pool of YBWC split records
+
+    a node uses records [first, n_used) and releases them before returning,
+    so records are used in LIFO order
 */
-Parallel_task ybwc_do_task_nws(uint64_t player, uint64_t opponent, int_fast8_t n_discs, uint_fast8_t parity, uint_fast8_t mpc_level, bool is_presearch, int parent_alpha, const int depth, uint64_t legal, const bool is_end_search, uint_fast8_t policy, int move_idx, std::vector<bool*> searchings, bool *n_searching) {
-    Search search(player, opponent, n_discs, parity, mpc_level, (!is_end_search && depth > YBWC_MID_SPLIT_MIN_DEPTH) || (is_end_search && depth > YBWC_END_SPLIT_MIN_DEPTH), is_presearch);
-    Parallel_task task;
-    task.value = -nega_alpha_ordering_nws(&search, -parent_alpha - 1, depth, false, legal, is_end_search, searchings);
-    if (!is_searching(searchings)) {
-        task.value = SCORE_UNDEFINED;
-    } else if (parent_alpha < task.value) {
-        *n_searching = false; // means: *searchings.back() = false;
+struct Ybwc_split_pool {
+    Ybwc_split_task tasks[YBWC_SPLIT_POOL_SIZE];
+    int n_used;
+
+    inline Ybwc_split_task* get() {
+        if (n_used == YBWC_SPLIT_POOL_SIZE) {
+            return nullptr;
+        }
+        return &tasks[n_used++];
     }
-    task.n_nodes = search.n_nodes;
-    task.cell = policy;
-    task.move_idx = move_idx;
-    return task;
+};
+
+thread_local Ybwc_split_pool ybwc_split_pool;
+
+#if USE_YBWC_SPLIT_STATISTICS
+/*
+    @brief Split statistics
+
+    a split allocates only if std::function can't hold the task in its small buffer,
+    so the split path checks where the stored task is (global operator new is not replaced)
+*/
+std::atomic<uint64_t> ybwc_n_splits(0);
+std::atomic<uint64_t> ybwc_n_split_allocations(0);
+
+template<typename F>
+inline bool ybwc_split_task_allocates(const F &split_task) {
+    std::function<void()> f(split_task);
+    const char *stored = (const char*)f.template target<F>();
+    return stored < (const char*)&f || (const char*)&f + sizeof(f) <= stored;
+}
+
+void ybwc_split_statistics_init() {
+    ybwc_n_splits = 0;
+    ybwc_n_split_allocations = 0;
+}
+
+void ybwc_split_statistics_print(uint64_t elapsed) {
+    uint64_t n_splits = ybwc_n_splits;
+    std::cerr << "ybwc splits " << n_splits << " splits/s " << calc_nps(n_splits, elapsed) << " allocations/split " << (n_splits ? (double)ybwc_n_split_allocations / n_splits : 0.0) << std::endl;
 }
+#endif
 
+/*
+    @brief Wrapper for parallel NWS (Null Window Search)
 
+    @param task                 split record
+*/
+void ybwc_do_task_nws(Ybwc_split_task *task) {
+    Search search(task->player, task->opponent, task->n_discs, task->parity, task->mpc_level, (!task->is_end_search && task->depth > YBWC_MID_SPLIT_MIN_DEPTH) || (task->is_end_search && task->depth > YBWC_END_SPLIT_MIN_DEPTH), task->is_presearch);
+    task->result.value = -nega_alpha_ordering_nws(&search, -task->parent_alpha - 1, task->depth, false, task->legal, task->is_end_search, task->searchings);
+    if (!is_searching(task->searchings)) {
+        task->result.value = SCORE_UNDEFINED;
+    } else if (task->parent_alpha < task->result.value) {
+        *task->n_searching = false; // means: *searchings->searching = false;
+    }
+    task->result.n_nodes = search.n_nodes;
+    task->result.cell = task->policy;
+    task->result.move_idx = task->move_idx;
+    thread_pool.set_done(&task->done);
+}
 
 /*
     @brief Try to do parallel NWS (Null Window Search)
@@ -76,19 +153,23 @@ Parallel_task ybwc_do_task_nws(uint64_t player, uint64_t opponent, int_fast8_t n
     @param depth                remaining depth
     @param legal                for use of previously calculated legal bitboard
     @param is_end_search        search till the end?
-    @param searching          flag for terminating this search
+    @param searchings           flags for terminating this search
+    @param n_searching          flag of this node
     @param policy               the last move
-    @param pv_idx               the priority of this move
-    @param seems_to_be_all_node     this node seems to be ALL node?
-    @param parallel_tasks       vector of splitted tasks
-    @return task splitted?
+    @param n_remaining_moves    number of moves not searched yet
+    @param move_idx             the priority of this move
+    @param running_count        number of splitted tasks of this node
+    @return YBWC_PUSHED, YBWC_NOT_PUSHED or the cutoff value
 */
-inline int ybwc_split_nws(Search *search, int parent_alpha, const int depth, uint64_t legal, const bool is_end_search, std::vector<bool*> &searchings, bool *n_searching, uint_fast8_t policy, const int n_remaining_moves, const int move_idx, const int running_count, std::vector<std::future<Parallel_task>> &parallel_tasks) {
+inline int ybwc_split_nws(Search *search, int parent_alpha, const int depth, uint64_t legal, const bool is_end_search, const Search_flag_chain *searchings, bool *n_searching, uint_fast8_t policy, const int n_remaining_moves, const int move_idx, const int running_count) {
     if (
             thread_pool.get_n_idle() &&                 // There is an idle thread
             n_remaining_moves >= YBWC_N_YOUNGER_CHILD    // This node is not the (some) youngest brother
             //running_count < YBWC_MAX_RUNNING_COUNT     // Do not split too many nodes
     ) {
+#if USE_SEARCH_STATISTICS
+        search_statistics_count(SEARCH_STATISTICS_YBWC_PROBE, depth);
+#endif
         int v;
         if (transposition_cutoff_nws(search, search->board.hash(), depth, -parent_alpha - 1, &v)) {
             return -v;
@@ -99,12 +180,40 @@ inline int ybwc_split_nws(Search *search, int parent_alpha, const int depth, uin
             }
         }
         if (is_searching(searchings)) {
-            bool pushed;
-            parallel_tasks.emplace_back(thread_pool.push(&pushed, std::bind(&ybwc_do_task_nws, search->board.player, search->board.opponent, search->n_discs, search->parity, search->mpc_level, search->is_presearch, parent_alpha, depth, legal, is_end_search, policy, move_idx, searchings, n_searching)));
-            if (pushed) {
-                return YBWC_PUSHED;
-            } else{
-                parallel_tasks.pop_back();
+            Ybwc_split_task *task = ybwc_split_pool.get();
+            if (task != nullptr) {
+                task->player = search->board.player;
+                task->opponent = search->board.opponent;
+                task->n_discs = search->n_discs;
+                task->parity = search->parity;
+                task->mpc_level = search->mpc_level;
+                task->is_presearch = search->is_presearch;
+                task->parent_alpha = parent_alpha;
+                task->depth = depth;
+                task->legal = legal;
+                task->is_end_search = is_end_search;
+                task->policy = policy;
+                task->move_idx = move_idx;
+                task->searchings = searchings;
+                task->n_searching = n_searching;
+                task->done.store(false, std::memory_order_relaxed);
+                auto split_task = [task]() {ybwc_do_task_nws(task);};
+                bool pushed = thread_pool.push_task(split_task);
+#if USE_YBWC_SPLIT_STATISTICS
+                if (pushed) {
+                    ybwc_n_splits.fetch_add(1, std::memory_order_relaxed);
+                    if (ybwc_split_task_allocates(split_task)) {
+                        ybwc_n_split_allocations.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+#endif
+                if (pushed) {
+#if USE_SEARCH_STATISTICS
+                    search_statistics_count(SEARCH_STATISTICS_YBWC_SPLIT, depth);
+#endif
+                    return YBWC_PUSHED;
+                }
+                --ybwc_split_pool.n_used;
             }
         }
     }
@@ -113,33 +222,33 @@ inline int ybwc_split_nws(Search *search, int parent_alpha, const int depth, uin
 
 
 #if USE_YBWC_NWS
-inline void ybwc_search_young_brothers_nws(Search *search, int alpha, int *v, int *best_move, int n_available_moves, uint32_t hash_code, int depth, bool is_end_search, std::vector<Flip_value> &move_list, std::vector<bool*> &searchings) {
-    std::vector<std::future<Parallel_task>> parallel_tasks;
+inline void ybwc_search_young_brothers_nws(Search *search, int alpha, int *v, int *best_move, int n_available_moves, uint32_t hash_code, int depth, bool is_end_search, Move_list &move_list, const Search_flag_chain *searchings) {
+    const int first_task_idx = ybwc_split_pool.n_used;
     bool n_searching = true;
-    searchings.emplace_back(&n_searching);
+    const Search_flag_chain n_searchings = {&n_searching, searchings};
     int canput = (int)move_list.size();
     int running_count = 0;
     int g;
     bool searched;
     int n_searched = 0;
     int n_moves_seen = 0;
-    for (int move_idx = 0; move_idx < canput && is_searching(searchings); ++move_idx) {
+    for (int move_idx = 0; move_idx < canput && is_searching(&n_searchings); ++move_idx) {
         //swap_next_best_move(move_list, move_idx, canput);
         if (move_list[move_idx].flip.flip) {
             ++n_moves_seen;
             searched = false;
             search->move(&move_list[move_idx].flip);
-                int ybwc_split_state = ybwc_split_nws(search, alpha, depth - 1, move_list[move_idx].n_legal, is_end_search, searchings, &n_searching, move_list[move_idx].flip.pos, n_available_moves - n_moves_seen, move_idx, running_count, parallel_tasks);
+                int ybwc_split_state = ybwc_split_nws(search, alpha, depth - 1, move_list[move_idx].n_legal, is_end_search, &n_searchings, &n_searching, move_list[move_idx].flip.pos, n_available_moves - n_moves_seen, move_idx, running_count);
                 if (ybwc_split_state == YBWC_PUSHED) {
                     ++running_count;
                 } else {
                     if (ybwc_split_state == YBWC_NOT_PUSHED) {
-                        g = -nega_alpha_ordering_nws(search, -alpha - 1, depth - 1, false, move_list[move_idx].n_legal, is_end_search, searchings);
+                        g = -nega_alpha_ordering_nws(search, -alpha - 1, depth - 1, false, move_list[move_idx].n_legal, is_end_search, &n_searchings);
                     } else{
                         g = ybwc_split_state;
                         ++search->n_nodes;
                     }
-                    if (is_searching(searchings)) {
+                    if (is_searching(&n_searchings)) {
                         searched = true;
                         if (*v < g) {
                             *v = g;
@@ -157,35 +266,40 @@ inline void ybwc_search_young_brothers_nws(Search *search, int alpha, int *v, in
             }
         }
     }
+    const int last_task_idx = ybwc_split_pool.n_used;
     Parallel_task task_result;
 #if USE_YBWC_SPLITTED_TASK_TERMINATION
-    if (is_searching(searchings) && *v <= alpha && running_count >= 2 && ((is_end_search && depth >= 28) || (!is_end_search && depth >= 24))) {
-        for (std::future<Parallel_task> &task: parallel_tasks) {
-            if (task.valid()) {
-                if (task.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
-                    task_result = task.get();
-                    --running_count;
-                    search->n_nodes += task_result.n_nodes;
-                    if (task_result.value != SCORE_UNDEFINED) {
-                        if (*v < task_result.value) {
-                            *v = task_result.value;
-                            *best_move = move_list[task_result.move_idx].flip.pos;
-                        }
-                        move_list[task_result.move_idx].flip.flip = 0;
-                        ++n_searched;
+    bool task_collected[YBWC_SPLIT_POOL_SIZE];
+    for (int i = first_task_idx; i < last_task_idx; ++i) {
+        task_collected[i] = false;
+    }
+    if (is_searching(&n_searchings) && *v <= alpha && running_count >= 2 && ((is_end_search && depth >= 28) || (!is_end_search && depth >= 24))) {
+        for (int i = first_task_idx; i < last_task_idx; ++i) {
+            Ybwc_split_task *task = &ybwc_split_pool.tasks[i];
+            if (task->done.load(std::memory_order_acquire)) {
+                task_collected[i] = true;
+                task_result = task->result;
+                --running_count;
+                search->n_nodes += task_result.n_nodes;
+                if (task_result.value != SCORE_UNDEFINED) {
+                    if (*v < task_result.value) {
+                        *v = task_result.value;
+                        *best_move = move_list[task_result.move_idx].flip.pos;
                     }
+                    move_list[task_result.move_idx].flip.flip = 0;
+                    ++n_searched;
                 }
             }
         }
-        if (is_searching(searchings) && *v <= alpha && running_count >= 2) {
+        if (is_searching(&n_searchings) && *v <= alpha && running_count >= 2) {
             n_searching = false; // terminate splitted tasks
-            for (std::future<Parallel_task> &task: parallel_tasks) {
-                if (task.valid()) {
-                    task_result = task.get();
-                    search->n_nodes += task_result.n_nodes;
+            for (int i = first_task_idx; i < last_task_idx; ++i) {
+                if (!task_collected[i]) {
+                    thread_pool.help_until(&ybwc_split_pool.tasks[i].done);
+                    search->n_nodes += ybwc_split_pool.tasks[i].result.n_nodes;
                 }
             }
-            searchings.pop_back(); // pop n_searching
+            ybwc_split_pool.n_used = first_task_idx;
             if (is_searching(searchings)) {
                 ybwc_search_young_brothers_nws(search, alpha, v, best_move, n_moves_seen - n_searched, hash_code, depth, is_end_search, move_list, searchings);
             }
@@ -193,27 +307,32 @@ inline void ybwc_search_young_brothers_nws(Search *search, int alpha, int *v, in
         }
     }
 #endif
-    for (std::future<Parallel_task> &task: parallel_tasks) {
-        if (task.valid()) {
-            task_result = task.get();
-            search->n_nodes += task_result.n_nodes;
-            if (task_result.value != SCORE_UNDEFINED) {
-                if (*v < task_result.value) {
-                    *v = task_result.value;
-                    *best_move = move_list[task_result.move_idx].flip.pos;
-                }
+    for (int i = first_task_idx; i < last_task_idx; ++i) {
+#if USE_YBWC_SPLITTED_TASK_TERMINATION
+        if (task_collected[i]) {
+            continue;
+        }
+#endif
+        thread_pool.help_until(&ybwc_split_pool.tasks[i].done);
+        task_result = ybwc_split_pool.tasks[i].result;
+        search->n_nodes += task_result.n_nodes;
+        if (task_result.value != SCORE_UNDEFINED) {
+            if (*v < task_result.value) {
+                *v = task_result.value;
+                *best_move = move_list[task_result.move_idx].flip.pos;
             }
         }
     }
-    searchings.pop_back();
+    ybwc_split_pool.n_used = first_task_idx;
 }
 #endif
 
 #if USE_YBWC_NEGASCOUT
-void ybwc_search_young_brothers(Search *search, int *alpha, int *beta, int *v, int *best_move, int n_available_moves, uint32_t hash_code, int depth, bool is_end_search, std::vector<Flip_value> &move_list, bool need_best_move, bool *searching) {
-    std::vector<std::future<Parallel_task>> parallel_tasks;
+void ybwc_search_young_brothers(Search *search, int *alpha, int *beta, int *v, int *best_move, int n_available_moves, uint32_t hash_code, int depth, bool is_end_search, Move_list &move_list, bool need_best_move, bool *searching) {
+    const int first_task_idx = ybwc_split_pool.n_used;
     bool n_searching = true;
-    std::vector<bool*> searchings = {searching, &n_searching};
+    const Search_flag_chain searching_chain = {searching, nullptr};
+    const Search_flag_chain n_searchings = {&n_searching, &searching_chain};
     int canput = (int)move_list.size();
     int running_count = 0;
     int g;
@@ -226,12 +345,12 @@ void ybwc_search_young_brothers(Search *search, int *alpha, int *beta, int *v, i
             ++n_moves_seen;
             bool move_done = false;
             search->move(&move_list[move_idx].flip);
-                int ybwc_split_state = ybwc_split_nws(search, *alpha, depth - 1, move_list[move_idx].n_legal, is_end_search, searchings, &n_searching, move_list[move_idx].flip.pos, n_available_moves - n_moves_seen, move_idx, running_count, parallel_tasks);
+                int ybwc_split_state = ybwc_split_nws(search, *alpha, depth - 1, move_list[move_idx].n_legal, is_end_search, &n_searchings, &n_searching, move_list[move_idx].flip.pos, n_available_moves - n_moves_seen, move_idx, running_count);
                 if (ybwc_split_state == YBWC_PUSHED) {
                     ++running_count;
                 } else{
                     if (ybwc_split_state == YBWC_NOT_PUSHED) {
-                        g = -nega_alpha_ordering_nws(search, -(*alpha) - 1, depth - 1, false, move_list[move_idx].n_legal, is_end_search, searchings);
+                        g = -nega_alpha_ordering_nws(search, -(*alpha) - 1, depth - 1, false, move_list[move_idx].n_legal, is_end_search, &n_searchings);
                     } else{
                         g = ybwc_split_state;
                         ++search->n_nodes;
@@ -259,26 +378,26 @@ void ybwc_search_young_brothers(Search *search, int *alpha, int *beta, int *v, i
     }
     if (running_count) {
         Parallel_task task_result;
-        for (std::future<Parallel_task> &task: parallel_tasks) {
-            if (task.valid()) {
-                task_result = task.get();
-                --running_count;
-                search->n_nodes += task_result.n_nodes;
-                if (task_result.value != SCORE_UNDEFINED) {
-                    if (*v < task_result.value) {
-                        *v = task_result.value;
-                        *best_move = move_list[task_result.move_idx].flip.pos;
-                    }
-                    if (*alpha < task_result.value) {
-                        next_alpha = std::max(next_alpha, task_result.value);
-                        research_idxes.emplace_back(task_result.move_idx);
-                    } else {
-                        move_list[task_result.move_idx].flip.flip = 0;
-                        ++n_searched;
-                    }
+        for (int i = first_task_idx; i < ybwc_split_pool.n_used; ++i) {
+            thread_pool.help_until(&ybwc_split_pool.tasks[i].done);
+            task_result = ybwc_split_pool.tasks[i].result;
+            --running_count;
+            search->n_nodes += task_result.n_nodes;
+            if (task_result.value != SCORE_UNDEFINED) {
+                if (*v < task_result.value) {
+                    *v = task_result.value;
+                    *best_move = move_list[task_result.move_idx].flip.pos;
+                }
+                if (*alpha < task_result.value) {
+                    next_alpha = std::max(next_alpha, task_result.value);
+                    research_idxes.emplace_back(task_result.move_idx);
+                } else {
+                    move_list[task_result.move_idx].flip.flip = 0;
+                    ++n_searched;
                 }
             }
         }
+        ybwc_split_pool.n_used = first_task_idx;
     }
     if (research_idxes.size() && next_alpha < *beta && *searching) {
         int prev_alpha = *alpha;
@@ -173,11 +173,11 @@ int init_ai(Settings* settings, const Directories* directories, bool *stop_loadi
     msex.updateMemoryStatus();
     double free_mb = static_cast<double>(msex.freeMemory) / 1024 / 1024;
 #endif
-    double size_mb = (double)sizeof(Hash_node) / 1024 / 1024 * hash_sizes[MAX_HASH_LEVEL];
+    double size_mb = (double)TRANSPOSITION_TABLE_NODE_SIZE / 1024 / 1024 * hash_sizes[MAX_HASH_LEVEL];
     std::cerr << "memory " << free_mb << " " << size_mb << std::endl;
     while (free_mb <= size_mb && MAX_HASH_LEVEL > 26) {
         --MAX_HASH_LEVEL;
-        size_mb = (double)sizeof(Hash_node) / 1024 / 1024 * hash_sizes[MAX_HASH_LEVEL];
+        size_mb = (double)TRANSPOSITION_TABLE_NODE_SIZE / 1024 / 1024 * hash_sizes[MAX_HASH_LEVEL];
     }
     settings->hash_level = std::min(settings->hash_level, MAX_HASH_LEVEL);
     std::cerr << "max hash level " << MAX_HASH_LEVEL << std::endl;